@@ -0,0 +1,133 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <task_graph.h>
+
+
+TASK_GRAPH::TASK_ID TASK_GRAPH::AddTask( std::function<void()> aTask )
+{
+    m_nodes.push_back( std::make_unique<NODE>() );
+    m_nodes.back()->m_task = std::move( aTask );
+
+    return m_nodes.size() - 1;
+}
+
+
+void TASK_GRAPH::AddDependency( TASK_ID aTask, TASK_ID aPrerequisite )
+{
+    m_nodes[aPrerequisite]->m_successors.push_back( aTask );
+    m_nodes[aTask]->m_prerequisites++;
+}
+
+
+bool TASK_GRAPH::Run( const std::function<bool()>& aOnWait, std::chrono::milliseconds aInterval )
+{
+    if( m_nodes.empty() )
+        return !m_cancelled;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_remaining = m_nodes.size();
+        m_exception = nullptr;
+    }
+
+    for( std::unique_ptr<NODE>& node : m_nodes )
+        node->m_pending.store( node->m_prerequisites );
+
+    for( TASK_ID ii = 0; ii < m_nodes.size(); ++ii )
+    {
+        if( m_nodes[ii]->m_prerequisites == 0 )
+            submit( ii );
+    }
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    while( m_remaining > 0 )
+    {
+        if( m_done.wait_for( lock, aInterval, [this]() { return m_remaining == 0; } ) )
+            break;
+
+        if( aOnWait )
+        {
+            // Don't hold the lock while calling out; finishing tasks need it.
+            lock.unlock();
+
+            if( !aOnWait() )
+                Cancel();
+
+            lock.lock();
+        }
+    }
+
+    if( m_exception )
+        std::rethrow_exception( m_exception );
+
+    return !m_cancelled;
+}
+
+
+void TASK_GRAPH::submit( TASK_ID aTask )
+{
+    m_pool.push_task(
+            [this, aTask]()
+            {
+                execute( aTask );
+            } );
+}
+
+
+void TASK_GRAPH::execute( TASK_ID aTask )
+{
+    NODE* node = m_nodes[aTask].get();
+
+    // A cancelled task still "completes" so that the graph drains and Run() returns.
+    if( !m_cancelled )
+    {
+        try
+        {
+            node->m_task();
+        }
+        catch( ... )
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+
+            if( !m_exception )
+                m_exception = std::current_exception();
+
+            Cancel();
+        }
+    }
+
+    for( TASK_ID successor : node->m_successors )
+    {
+        if( m_nodes[successor]->m_pending.fetch_sub( 1 ) == 1 )
+            submit( successor );
+    }
+
+    // Notify while holding the lock so that Run() cannot return (and the graph be destroyed)
+    // before we're done with it.
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    if( --m_remaining == 0 )
+        m_done.notify_all();
+}
@@ -0,0 +1,161 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#ifndef INCLUDE_CONCURRENT_CACHE_H_
+#define INCLUDE_CONCURRENT_CACHE_H_
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+/**
+ * A hash map for memoizing results which is safe to use from many threads at once.
+ *
+ * Entries are spread over a number of shards, each with its own reader/writer lock, so
+ * lookups only contend with writers of the same shard.  Values are computed outside of any
+ * lock (see GetOrCompute()); if two threads race to compute the same entry the first one
+ * stored wins.
+ *
+ * Hits and misses are counted so the usefulness of a cache can be measured.
+ */
+template <typename KEY, typename VALUE, typename HASH = std::hash<KEY>, size_t SHARDS = 16>
+class CONCURRENT_CACHE
+{
+public:
+    CONCURRENT_CACHE() :
+            m_hits( 0 ),
+            m_misses( 0 )
+    {}
+
+    /**
+     * Look up \a aKey.
+     *
+     * @return true (and fill in \a aValue) if it is in the cache.
+     */
+    bool Find( const KEY& aKey, VALUE& aValue ) const
+    {
+        const SHARD&                        shard = shardFor( aKey );
+        std::shared_lock<std::shared_mutex> lock( shard.m_mutex );
+        auto                                it = shard.m_map.find( aKey );
+
+        if( it == shard.m_map.end() )
+        {
+            m_misses.fetch_add( 1, std::memory_order_relaxed );
+            return false;
+        }
+
+        m_hits.fetch_add( 1, std::memory_order_relaxed );
+        aValue = it->second;
+        return true;
+    }
+
+    /**
+     * Store \a aValue for \a aKey, replacing any existing value.
+     */
+    void Set( const KEY& aKey, const VALUE& aValue )
+    {
+        SHARD&                              shard = shardFor( aKey );
+        std::unique_lock<std::shared_mutex> lock( shard.m_mutex );
+
+        shard.m_map[ aKey ] = aValue;
+    }
+
+    /**
+     * Return the cached value for \a aKey, calling \a aCompute to make (and store) it if it
+     * isn't cached yet.  \a aCompute is called without holding any lock.
+     */
+    template <typename FUNC>
+    VALUE GetOrCompute( const KEY& aKey, FUNC&& aCompute )
+    {
+        VALUE value;
+
+        if( Find( aKey, value ) )
+            return value;
+
+        value = aCompute();
+
+        SHARD&                              shard = shardFor( aKey );
+        std::unique_lock<std::shared_mutex> lock( shard.m_mutex );
+
+        return shard.m_map.emplace( aKey, value ).first->second;
+    }
+
+    void Clear()
+    {
+        for( SHARD& shard : m_shards )
+        {
+            std::unique_lock<std::shared_mutex> lock( shard.m_mutex );
+            shard.m_map.clear();
+        }
+    }
+
+    size_t Size() const
+    {
+        size_t size = 0;
+
+        for( const SHARD& shard : m_shards )
+        {
+            std::shared_lock<std::shared_mutex> lock( shard.m_mutex );
+            size += shard.m_map.size();
+        }
+
+        return size;
+    }
+
+    size_t GetHits() const { return m_hits.load( std::memory_order_relaxed ); }
+    size_t GetMisses() const { return m_misses.load( std::memory_order_relaxed ); }
+
+    void ResetStats()
+    {
+        m_hits.store( 0 );
+        m_misses.store( 0 );
+    }
+
+private:
+    struct SHARD
+    {
+        mutable std::shared_mutex               m_mutex;
+        std::unordered_map<KEY, VALUE, HASH>    m_map;
+    };
+
+    size_t shardIndex( const KEY& aKey ) const
+    {
+        // The maps use the low bits of the same hash for their buckets, so pick the shard
+        // from some higher ones.
+        size_t hash = HASH()( aKey );
+        return ( hash ^ ( hash >> 17 ) ^ ( hash >> 31 ) ) % SHARDS;
+    }
+
+    SHARD& shardFor( const KEY& aKey ) { return m_shards[ shardIndex( aKey ) ]; }
+    const SHARD& shardFor( const KEY& aKey ) const { return m_shards[ shardIndex( aKey ) ]; }
+
+    std::array<SHARD, SHARDS>   m_shards;
+    mutable std::atomic<size_t> m_hits;
+    mutable std::atomic<size_t> m_misses;
+};
+
+#endif /* INCLUDE_CONCURRENT_CACHE_H_ */
@@ -0,0 +1,118 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#pragma once
+#ifndef INCLUDE_TASK_GRAPH_H_
+#define INCLUDE_TASK_GRAPH_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <thread_pool.h>
+
+/**
+ * A set of tasks with "must run after" dependencies between them, executed on a thread pool.
+ *
+ * A task is handed to the pool as soon as its last prerequisite finishes (from the worker
+ * thread which finished it), so there is no polling and no latency between dependent steps.
+ *
+ * The graph must be acyclic.  Tasks and dependencies may only be added before Run().
+ */
+class TASK_GRAPH
+{
+public:
+    typedef size_t TASK_ID;
+
+    TASK_GRAPH( thread_pool& aPool ) :
+            m_pool( aPool ),
+            m_remaining( 0 ),
+            m_cancelled( false )
+    {}
+
+    /**
+     * Add a task to the graph.
+     *
+     * @return the ID of the task, for use with AddDependency().
+     */
+    TASK_ID AddTask( std::function<void()> aTask );
+
+    /**
+     * Make \a aTask wait until \a aPrerequisite has completed.
+     */
+    void AddDependency( TASK_ID aTask, TASK_ID aPrerequisite );
+
+    /**
+     * Run all tasks and block until they have completed.
+     *
+     * @param aOnWait is called on the calling thread every \a aInterval while waiting (for
+     *                instance to keep a progress reporter refreshed).  Returning false cancels
+     *                any tasks which have not yet started.
+     * @param aInterval is the maximum time between calls to \a aOnWait.  Completion of the
+     *                  graph is signalled immediately regardless of this value.
+     * @return true if all tasks ran, false if the graph was cancelled.
+     *
+     * If a task throws, the remaining tasks are cancelled and the first exception is re-thrown
+     * from here once all running tasks have finished.
+     */
+    bool Run( const std::function<bool()>& aOnWait = nullptr,
+              std::chrono::milliseconds aInterval = std::chrono::milliseconds( 100 ) );
+
+    /**
+     * Prevent tasks which have not yet started from running.  Safe to call from any thread.
+     */
+    void Cancel() { m_cancelled.store( true ); }
+
+    bool IsCancelled() const { return m_cancelled.load(); }
+
+    size_t GetTaskCount() const { return m_nodes.size(); }
+
+private:
+    struct NODE
+    {
+        std::function<void()> m_task;
+        std::vector<TASK_ID>  m_successors;
+        int                   m_prerequisites = 0;
+        std::atomic<int>      m_pending{ 0 };
+    };
+
+    void submit( TASK_ID aTask );
+    void execute( TASK_ID aTask );
+
+    thread_pool&                       m_pool;
+    std::vector<std::unique_ptr<NODE>> m_nodes;
+
+    std::mutex                         m_mutex;
+    std::condition_variable            m_done;
+    size_t                             m_remaining;     // guarded by m_mutex
+    std::exception_ptr                 m_exception;     // guarded by m_mutex
+    std::atomic<bool>                  m_cancelled;
+};
+
+
+#endif /* INCLUDE_TASK_GRAPH_H_ */
@@ -0,0 +1,390 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PACKED_RTREE_H
+#define __PACKED_RTREE_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * A static 2D R-tree, packed bottom-up with Sort-Tile-Recursive ordering.
+ *
+ * All nodes live in one array and hold the bounding boxes of their children as separate
+ * arrays of coordinates (structure-of-arrays), so that testing a query box against all the
+ * children of a node is a handful of straight-line comparisons over FANOUT integers, which
+ * the compiler turns into vector instructions.
+ *
+ * Entries can't be added after Build(), but they can be removed: a removed entry's box is
+ * emptied so that no query will ever hit it again.  Owners are expected to rebuild the tree
+ * once enough of it has gone stale.
+ */
+template <class DATATYPE>
+class PACKED_RTREE
+{
+public:
+    static constexpr int FANOUT = 8;
+
+    struct ENTRY
+    {
+        int      m_min[2];
+        int      m_max[2];
+        DATATYPE m_data;
+    };
+
+    PACKED_RTREE() :
+            m_leafCount( 0 ),
+            m_removed( 0 )
+    {}
+
+    /**
+     * Replace the contents of the tree with \a aEntries (which will be reordered).
+     */
+    void Build( std::vector<ENTRY>& aEntries )
+    {
+        Clear();
+
+        if( aEntries.empty() )
+            return;
+
+        sortTileRecursive( aEntries.data(), aEntries.size(), 0 );
+
+        std::vector<BOX_REF> level;
+
+        m_data.reserve( aEntries.size() );
+        level.reserve( aEntries.size() );
+
+        for( const ENTRY& entry : aEntries )
+        {
+            level.push_back( { { entry.m_min[0], entry.m_min[1] },
+                               { entry.m_max[0], entry.m_max[1] },
+                               (uint32_t) m_data.size() } );
+
+            m_data.push_back( entry.m_data );
+        }
+
+        // The leaves, then each level above them in turn.  The root is the last node.
+        bool leaves = true;
+
+        do
+        {
+            if( !leaves )
+                sortTileRecursive( level.data(), level.size(), 0 );
+
+            std::vector<BOX_REF> parents;
+
+            for( size_t first = 0; first < level.size(); first += FANOUT )
+            {
+                parents.push_back( addNode( level.data() + first,
+                                            std::min<size_t>( FANOUT, level.size() - first ) ) );
+            }
+
+            if( leaves )
+                m_leafCount = m_nodes.size();
+
+            leaves = false;
+            level.swap( parents );
+        } while( level.size() > 1 );
+    }
+
+    void Clear()
+    {
+        m_nodes.clear();
+        m_data.clear();
+        m_leafCount = 0;
+        m_removed = 0;
+    }
+
+    /**
+     * Remove the entry for \a aData, which must have been built with the box given.
+     *
+     * @return true if the entry was found.
+     */
+    bool Remove( const int aMin[2], const int aMax[2], const DATATYPE& aData )
+    {
+        if( m_nodes.empty() )
+            return false;
+
+        uint32_t stack[MAX_STACK];
+        int      top = 0;
+
+        stack[top++] = (uint32_t) m_nodes.size() - 1;
+
+        while( top > 0 )
+        {
+            NODE&    node = m_nodes[ stack[--top] ];
+            unsigned mask = node.Overlaps( aMin, aMax );
+
+            for( int ii = 0; ii < FANOUT; ++ii )
+            {
+                if( !( mask & ( 1u << ii ) ) )
+                    continue;
+
+                if( !isLeaf( node ) )
+                {
+                    stack[top++] = node.m_child[ii];
+                }
+                else if( m_data[ node.m_child[ii] ] == aData
+                            && node.m_minX[ii] == aMin[0] && node.m_minY[ii] == aMin[1]
+                            && node.m_maxX[ii] == aMax[0] && node.m_maxY[ii] == aMax[1] )
+                {
+                    node.Empty( ii );
+                    m_removed++;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Remove the entry for \a aData wherever it is, for when its box isn't known.  This looks
+     * at every leaf.
+     *
+     * @return true if the entry was found.
+     */
+    bool Remove( const DATATYPE& aData )
+    {
+        for( size_t n = 0; n < m_leafCount; ++n )
+        {
+            NODE& node = m_nodes[n];
+
+            for( int ii = 0; ii < FANOUT; ++ii )
+            {
+                if( node.m_minX[ii] <= node.m_maxX[ii] && m_data[ node.m_child[ii] ] == aData )
+                {
+                    node.Empty( ii );
+                    m_removed++;
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Call \a aVisitor for each entry whose box overlaps the query box (boxes are closed).
+     * The visitor returns false to stop the search.
+     *
+     * @return the number of entries visited (and not stopped at).
+     */
+    template <class VISITOR>
+    int Search( const int aMin[2], const int aMax[2], VISITOR& aVisitor ) const
+    {
+        if( m_nodes.empty() )
+            return 0;
+
+        uint32_t stack[MAX_STACK];
+        int      top = 0;
+        int      count = 0;
+
+        stack[top++] = (uint32_t) m_nodes.size() - 1;
+
+        while( top > 0 )
+        {
+            const NODE& node = m_nodes[ stack[--top] ];
+            unsigned    mask = node.Overlaps( aMin, aMax );
+
+            if( !mask )
+                continue;
+
+            if( !isLeaf( node ) )
+            {
+                // Push in reverse so that the children are visited in order
+                for( int ii = FANOUT - 1; ii >= 0; --ii )
+                {
+                    if( mask & ( 1u << ii ) )
+                        stack[top++] = node.m_child[ii];
+                }
+
+                continue;
+            }
+
+            for( int ii = 0; ii < FANOUT; ++ii )
+            {
+                if( !( mask & ( 1u << ii ) ) )
+                    continue;
+
+                if( !aVisitor( m_data[ node.m_child[ii] ] ) )
+                    return count;
+
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    /**
+     * Call \a aFunc with each entry still in the tree.
+     */
+    template <class FUNC>
+    void ForEach( FUNC&& aFunc ) const
+    {
+        for( size_t n = 0; n < m_leafCount; ++n )
+        {
+            const NODE& node = m_nodes[n];
+
+            for( int ii = 0; ii < FANOUT; ++ii )
+            {
+                if( node.m_minX[ii] <= node.m_maxX[ii] )
+                    aFunc( m_data[ node.m_child[ii] ] );
+            }
+        }
+    }
+
+    /// Number of entries still in the tree.
+    size_t Size() const { return m_data.size() - m_removed; }
+
+    /// Number of entries removed since the tree was built.
+    size_t RemovedCount() const { return m_removed; }
+
+private:
+    // A tree of 2^32 entries is 11 levels deep, and each level leaves at most FANOUT - 1
+    // nodes on the stack.
+    static constexpr int MAX_STACK = 12 * FANOUT;
+
+    ///< A box and the index of the node or entry data it bounds
+    struct BOX_REF
+    {
+        int      m_min[2];
+        int      m_max[2];
+        uint32_t m_index;
+    };
+
+    struct NODE
+    {
+        int32_t  m_minX[FANOUT];
+        int32_t  m_minY[FANOUT];
+        int32_t  m_maxX[FANOUT];
+        int32_t  m_maxY[FANOUT];
+        uint32_t m_child[FANOUT];   ///< index of a node, or of an entry's data for leaves
+
+        void Empty( size_t aSlot )
+        {
+            m_minX[aSlot] = m_minY[aSlot] = INT_MAX;
+            m_maxX[aSlot] = m_maxY[aSlot] = INT_MIN;
+        }
+
+        /**
+         * @return a bitmask of the slots whose boxes overlap the given one.  Written without
+         *         branches so that it vectorizes.
+         */
+        unsigned Overlaps( const int aMin[2], const int aMax[2] ) const
+        {
+            const int32_t minX = aMin[0], minY = aMin[1], maxX = aMax[0], maxY = aMax[1];
+            int32_t       hit[FANOUT];
+            unsigned      mask = 0;
+
+            // The last test keeps empty slots out of even an all-encompassing query
+            for( int ii = 0; ii < FANOUT; ++ii )
+            {
+                hit[ii] = ( m_minX[ii] <= maxX ) & ( m_maxX[ii] >= minX )
+                        & ( m_minY[ii] <= maxY ) & ( m_maxY[ii] >= minY )
+                        & ( m_minX[ii] <= m_maxX[ii] );
+            }
+
+            for( int ii = 0; ii < FANOUT; ++ii )
+                mask |= (unsigned) hit[ii] << ii;
+
+            return mask;
+        }
+    };
+
+    bool isLeaf( const NODE& aNode ) const
+    {
+        return (size_t) ( &aNode - m_nodes.data() ) < m_leafCount;
+    }
+
+    /**
+     * Add a node holding \a aCount children.
+     *
+     * @return a reference to the new node, boxing its children.
+     */
+    BOX_REF addNode( const BOX_REF* aChildren, size_t aCount )
+    {
+        NODE    node;
+        BOX_REF parent = { { INT_MAX, INT_MAX }, { INT_MIN, INT_MIN }, (uint32_t) m_nodes.size() };
+
+        for( size_t ii = 0; ii < (size_t) FANOUT; ++ii )
+        {
+            node.m_child[ii] = 0;
+
+            if( ii >= aCount )
+            {
+                node.Empty( ii );
+                continue;
+            }
+
+            const BOX_REF& child = aChildren[ii];
+
+            node.m_minX[ii] = child.m_min[0];
+            node.m_minY[ii] = child.m_min[1];
+            node.m_maxX[ii] = child.m_max[0];
+            node.m_maxY[ii] = child.m_max[1];
+            node.m_child[ii] = child.m_index;
+
+            parent.m_min[0] = std::min( parent.m_min[0], child.m_min[0] );
+            parent.m_min[1] = std::min( parent.m_min[1], child.m_min[1] );
+            parent.m_max[0] = std::max( parent.m_max[0], child.m_max[0] );
+            parent.m_max[1] = std::max( parent.m_max[1], child.m_max[1] );
+        }
+
+        m_nodes.push_back( node );
+        return parent;
+    }
+
+    template <class BOXED>
+    static void sortTileRecursive( BOXED* aEntries, size_t aCount, int aAxis )
+    {
+        if( aCount <= (size_t) FANOUT )
+            return;
+
+        std::sort( aEntries, aEntries + aCount,
+                   [aAxis]( const BOXED& a, const BOXED& b )
+                   {
+                       // Compare doubled centres; the halving doesn't change the order
+                       return (int64_t) a.m_min[aAxis] + a.m_max[aAxis]
+                                < (int64_t) b.m_min[aAxis] + b.m_max[aAxis];
+                   } );
+
+        if( aAxis == 1 )
+            return;
+
+        double nodes = std::ceil( (double) aCount / FANOUT );
+        double slabs = std::ceil( std::sqrt( nodes ) );
+        size_t slabSize = FANOUT * (size_t) std::ceil( nodes / slabs );
+
+        for( size_t first = 0; first < aCount; first += slabSize )
+            sortTileRecursive( aEntries + first, std::min( slabSize, aCount - first ), 1 );
+    }
+
+    std::vector<NODE>     m_nodes;
+    std::vector<DATATYPE> m_data;
+    size_t                m_leafCount;
+    size_t                m_removed;
+};
+
+#endif // __PACKED_RTREE_H
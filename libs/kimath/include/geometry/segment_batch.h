@@ -0,0 +1,115 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SEGMENT_BATCH_H
+#define __SEGMENT_BATCH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <geometry/seg.h>
+#include <geometry/shape_arc.h>
+
+class SHAPE_LINE_CHAIN;
+
+
+/**
+ * A set of segments and arcs, packed so that query segments can be collided with all of them
+ * quickly.
+ *
+ * The bounding boxes of the segments are held as separate arrays of coordinates (as in
+ * #PACKED_RTREE), so that testing LANES of them at a time against a query segment's box, grown
+ * by the distance of interest, is a handful of straight-line comparisons that the compiler turns
+ * into vector instructions.  Two segments can be no closer than their boxes, so only the few
+ * segments whose boxes are in reach go on to the exact tests, and the results are exactly those
+ * of SEG::SquaredDistance() and SHAPE_ARC::Collide().
+ */
+class SEGMENT_BATCH
+{
+public:
+    typedef SEG::ecoord ecoord;
+
+    static constexpr int LANES = 8;
+
+    void Clear();
+
+    void Add( const SEG& aSeg );
+
+    void Add( const SHAPE_ARC& aArc );
+
+    /**
+     * Add the straight segments of \a aChain (in order), and then its arcs.
+     */
+    void Add( const SHAPE_LINE_CHAIN& aChain );
+
+    size_t SegmentCount() const { return m_segs.size(); }
+
+    const SEG& Segment( size_t aIndex ) const { return m_segs[aIndex]; }
+
+    size_t ArcCount() const { return m_arcs.size(); }
+
+    /**
+     * Find the segment nearest to \a aSeg, out of those that touch it or are closer to it than
+     * sqrt( \a aLimitSq ).
+     *
+     * @param aFirst stop at the first such segment rather than looking for the nearest.
+     * @param aDistSq if not null, receives the squared distance to the segment found.
+     * @return the index of the segment (the first of them if several are equally near), or -1
+     *         if there are none.
+     */
+    int NearestSegment( const SEG& aSeg, ecoord aLimitSq, bool aFirst = false,
+                        ecoord* aDistSq = nullptr ) const;
+
+    /**
+     * Collide \a aSeg with each of the arcs in turn.
+     *
+     * @return true and the results of SHAPE_ARC::Collide() for the first arc that collides.
+     */
+    bool CollideArcs( const SEG& aSeg, int aClearance, int* aActual = nullptr,
+                      VECTOR2I* aLocation = nullptr ) const;
+
+private:
+    /**
+     * Bounding boxes, padded out to a multiple of LANES with empty ones.
+     */
+    struct BOXES
+    {
+        std::vector<int32_t> m_minX;
+        std::vector<int32_t> m_minY;
+        std::vector<int32_t> m_maxX;
+        std::vector<int32_t> m_maxY;
+
+        void Clear();
+
+        void Add( size_t aIndex, const VECTOR2I& aMin, const VECTOR2I& aMax );
+
+        /**
+         * @return a bitmask of which of the LANES boxes from \a aFirst on overlap the given one.
+         *         Written without branches so that it vectorizes.
+         */
+        unsigned Overlaps( size_t aFirst, const int32_t aMin[2], const int32_t aMax[2] ) const;
+    };
+
+    std::vector<SEG>       m_segs;
+    std::vector<SHAPE_ARC> m_arcs;
+    BOXES                  m_segBoxes;
+    BOXES                  m_arcBoxes;
+};
+
+#endif // __SEGMENT_BATCH_H
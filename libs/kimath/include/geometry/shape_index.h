@@ -141,9 +141,9 @@ class SHAPE_INDEX
              *
              * @param aTree is a #RTREE object/
              */
-            void Init( RTree<T, int, 2, double>* aTree )
+            void Init( const RTree<T, int, 2, double>* aTree )
             {
-                aTree->GetFirst( iterator );
+                iterator = aTree->begin();
             }
 
         public:
@@ -152,7 +152,7 @@ class SHAPE_INDEX
              *
              * @param aIndex is a #SHAPE_INDEX object to iterate.
              */
-            Iterator( SHAPE_INDEX* aIndex )
+            Iterator( const SHAPE_INDEX* aIndex )
             {
                 Init( aIndex->m_tree );
             }
@@ -170,7 +170,8 @@ class SHAPE_INDEX
              */
             bool operator++()
             {
-                return ++iterator;
+                ++iterator;
+                return iterator.IsNotNull();
             }
 
             /**
@@ -178,7 +179,8 @@ class SHAPE_INDEX
              */
             bool operator++( int )
             {
-                return ++iterator;
+                ++iterator;
+                return iterator.IsNotNull();
             }
 
             /**
@@ -188,7 +190,7 @@ class SHAPE_INDEX
              */
             bool IsNull() const
             {
-                return iterator.IsNull();
+                return !iterator.IsNotNull();
             }
 
             /**
@@ -238,8 +240,9 @@ class SHAPE_INDEX
          * Remove a #SHAPE from the index.
          *
          * @param aShape is the #SHAPE to remove.
+         * @return true if it was found.
          */
-        void Remove( T aShape );
+        bool Remove( T aShape );
 
         /**
          * Remove all the contents of the index.
@@ -252,7 +255,7 @@ class SHAPE_INDEX
          * @param aVisitor is the visitor object to be run.
          */
         template <class V>
-        void Accept( V aVisitor )
+        void Accept( V aVisitor ) const
         {
             Iterator iter = this->Begin();
 
@@ -295,7 +298,7 @@ class SHAPE_INDEX
          *
          * @return iterator to the first object.
          */
-        Iterator Begin();
+        Iterator Begin() const;
 
     private:
         RTree<T, int, 2, double>* m_tree;
@@ -337,13 +340,14 @@ void SHAPE_INDEX<T>::Add( T aShape )
 }
 
 template <class T>
-void SHAPE_INDEX<T>::Remove( T aShape )
+bool SHAPE_INDEX<T>::Remove( T aShape )
 {
     BOX2I box = boundingBox( aShape );
     int min[2] = { box.GetX(), box.GetY() };
     int max[2] = { box.GetRight(), box.GetBottom() };
 
-    this->m_tree->Remove( min, max, aShape );
+    // RTree::Remove() returns true when the shape wasn't found
+    return !this->m_tree->Remove( min, max, aShape );
 }
 
 template <class T>
@@ -375,7 +379,7 @@ void SHAPE_INDEX<T>::Reindex()
 }
 
 template <class T>
-typename SHAPE_INDEX<T>::Iterator SHAPE_INDEX<T>::Begin()
+typename SHAPE_INDEX<T>::Iterator SHAPE_INDEX<T>::Begin() const
 {
     return Iterator( this );
 }
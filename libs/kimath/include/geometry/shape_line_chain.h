@@ -228,6 +228,23 @@ public:
     virtual bool Collide( const SEG& aSeg, int aClearance = 0, int* aActual = nullptr,
                           VECTOR2I* aLocation = nullptr ) const override;
 
+    /**
+     * Check each of \a aSegs in turn with Collide( const SEG& ), keeping the nearest collision.
+     *
+     * The results are the same, but the chain is packed into a #SEGMENT_BATCH once for all of
+     * the segments, which is much faster than colliding them one at a time with a long chain.
+     *
+     * @param aSegs the segments to check for collisions with
+     * @param aClearance minimum distance that does not qualify as a collision.
+     * @param aActual an optional pointer to an int to store the actual distance in the event
+     *                of a collision.  Without it, the first of \a aSegs that collides is taken
+     *                and the rest aren't looked at.
+     * @param aLocation an optional pointer to store the location of the collision.
+     * @return true, when a collision has been found
+     */
+    bool CollideSegments( const std::vector<SEG>& aSegs, int aClearance = 0,
+                          int* aActual = nullptr, VECTOR2I* aLocation = nullptr ) const;
+
     SHAPE_LINE_CHAIN& operator=( const SHAPE_LINE_CHAIN& ) = default;
 
     SHAPE* Clone() const override;
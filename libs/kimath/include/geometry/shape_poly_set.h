@@ -30,6 +30,7 @@
 
 #include <cstdio>
 #include <deque>                        // for deque
+#include <functional>
 #include <vector>                       // for vector
 #include <iosfwd>                       // for string, stringstream
 #include <memory>
@@ -165,14 +166,25 @@ public:
             return m_vertices.size();
         }
 
+        /**
+         * For the triangulation of one cell of a partitioned set, a key for the geometry the
+         * triangles cover.  Invalid if the triangles can't be reused for the same key.
+         */
+        const MD5_HASH& GetSourceCellKey() const { return m_sourceCellKey; }
+        void SetSourceCellKey( const MD5_HASH& aKey ) { m_sourceCellKey = aKey; }
+
         void Move( const VECTOR2I& aVec )
         {
             for( VECTOR2I& vertex : m_vertices )
                 vertex += aVec;
+
+            // The triangles no longer cover the geometry the key was made from
+            m_sourceCellKey.SetValid( false );
         }
 
     private:
         int                  m_sourceOutline;
+        MD5_HASH             m_sourceCellKey;
         std::deque<TRI>      m_triangles;
         std::deque<VECTOR2I> m_vertices;
     };
@@ -498,17 +510,31 @@ public:
 
     SHAPE_POLY_SET& operator=( const SHAPE_POLY_SET& aOther );
 
+    ///< Hands a task to another thread to run (at some point).  See CacheTriangulation().
+    typedef std::function<void( const std::function<void()>& )> TASK_SUBMITTER;
+
     /**
      * Build a polygon triangulation, needed to draw a polygon on OpenGL and in some
      * other calculations
      * @param aPartition = true to created a trinagulation in a partition on a grid
      * false to create a more basic triangulation of the polygons
+     * @param aSubmitter if given, is used to triangulate the pieces of the set (the cells of
+     * the partition, or the outlines) on other threads as well as on the calling one.  The
+     * calling thread never waits for a task which hasn't started, so this can be called from
+     * a task running on the same thread pool.
+     * @param aHint an earlier version of this set.  When partitioning, the triangulations of
+     * any of its cells whose geometry hasn't changed are copied rather than recalculated.
+     * @param aReusedCells if given, receives the number of cells copied from \a aHint.
      * Note
-     * in partition calculations the grid size is hard coded to 1e7.
+     * in partition calculations the grid size is hard coded to 1e7, and the grid is aligned
+     * to the origin (so that it doesn't move when the set changes).
      * This is a good value for Pcbnew: 1cm, in internal units.
      * But not good for Gerbview (1e7 = 10cm), however using a partition is not useful.
      */
-    void CacheTriangulation( bool aPartition = true );
+    void CacheTriangulation( bool aPartition = true,
+                             const TASK_SUBMITTER& aSubmitter = nullptr,
+                             const SHAPE_POLY_SET* aHint = nullptr,
+                             int* aReusedCells = nullptr );
     bool IsTriangulationUpToDate() const;
 
     MD5_HASH GetHash() const;
@@ -1013,6 +1039,57 @@ public:
         Inflate( -aAmount, aCircleSegmentsCount, aCornerStrategy );
     }
 
+    /**
+     * Gather the operands of a boolean operation so that any number of them can be combined in
+     * one pass, rather than building (and converting to and from Clipper) a SHAPE_POLY_SET for
+     * each intermediate result of a chain of BooleanAdd() or BooleanSubtract() calls.
+     *
+     * The subjects are unioned together, as are the clips, and the operation is then carried
+     * out between the two.  Operands can be inflated (or deflated) on their way in.
+     */
+    class BOOLEAN_BUILDER
+    {
+    public:
+        void AddSubject( const SHAPE_POLY_SET& aShape );
+        void AddClip( const SHAPE_POLY_SET& aShape );
+
+        ///< Add \a aShape inflated by \a aAmount; see Inflate() for the other parameters
+        void AddSubject( const SHAPE_POLY_SET& aShape, int aAmount, int aCircleSegCount,
+                         CORNER_STRATEGY aCornerStrategy = ROUND_ALL_CORNERS );
+        void AddClip( const SHAPE_POLY_SET& aShape, int aAmount, int aCircleSegCount,
+                      CORNER_STRATEGY aCornerStrategy = ROUND_ALL_CORNERS );
+
+        bool HasClips() const { return !m_paths[ClipperLib::ptClip].empty(); }
+
+        ///< Replace \a aResult with the union of all the operands
+        ///< For \a aFastMode meaning, see function booleanOp
+        void Union( SHAPE_POLY_SET& aResult, POLYGON_MODE aFastMode );
+
+        ///< Replace \a aResult with the subjects minus the clips
+        ///< For \a aFastMode meaning, see function booleanOp
+        void Subtract( SHAPE_POLY_SET& aResult, POLYGON_MODE aFastMode );
+
+        ///< Replace \a aResult with the intersection of the subjects and the clips
+        ///< For \a aFastMode meaning, see function booleanOp
+        void Intersect( SHAPE_POLY_SET& aResult, POLYGON_MODE aFastMode );
+
+    private:
+        friend class SHAPE_POLY_SET;
+
+        void add( ClipperLib::PolyType aType, const SHAPE_POLY_SET& aShape );
+        void add( ClipperLib::PolyType aType, const SHAPE_POLY_SET& aShape, int aAmount,
+                  int aCircleSegCount, CORNER_STRATEGY aCornerStrategy );
+
+        void execute( ClipperLib::ClipType aType, SHAPE_POLY_SET& aResult,
+                      POLYGON_MODE aFastMode );
+
+        ClipperLib::Paths            m_paths[2];    ///< indexed by ClipperLib::PolyType
+        std::vector<CLIPPER_Z_VALUE> m_zValues;
+        std::vector<SHAPE_ARC>       m_arcBuffer;
+        int                          m_outlineCount = 0;
+        bool                         m_hasArcs = false;     ///< in operands added as they are
+    };
+
     /**
      * Perform outline inflation/deflation, using round corners.
      *
@@ -1151,6 +1228,23 @@ public:
     bool Collide( const SEG& aSeg, int aClearance = 0, int* aActual = nullptr,
                   VECTOR2I* aLocation = nullptr ) const override;
 
+    /**
+     * Check each of \a aSegs in turn with Collide( const SEG& ), keeping the nearest collision.
+     *
+     * The distances are the same, but the edges of each polygon are packed into a
+     * #SEGMENT_BATCH once for all of the segments, which is much faster than colliding them one
+     * at a time with large polygons.
+     *
+     * @param aSegs      are the segments to test.
+     * @param aClearance is the security distance.
+     * @param aActual an optional pointer to an int to store the actual distance in the event
+     *                of a collision.
+     * @param aLocation an optional pointer to store the location of the nearest collision.
+     * @return true if any of the segments collide with the polygon set.
+     */
+    bool CollideSegments( const std::vector<SEG>& aSegs, int aClearance = 0,
+                          int* aActual = nullptr, VECTOR2I* aLocation = nullptr ) const;
+
     /**
      * Check whether \a aPoint collides with any vertex of any of the contours of the polygon.
      *
@@ -1384,6 +1478,8 @@ private:
 
     void fractureSingle( POLYGON& paths );
     void unfractureSingle ( POLYGON& path );
+
+    /// Append the outlines of a Clipper result to the set.
     void importTree( ClipperLib::PolyTree*               tree,
                      const std::vector<CLIPPER_Z_VALUE>& aZValueBuffer,
                      const std::vector<SHAPE_ARC>&       aArcBuffe );
@@ -1406,6 +1502,18 @@ private:
     void booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
                     const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
 
+    /**
+     * Offset \a aPolys as Inflate() does, handing each ClipperOffset to \a aExecute once it has
+     * been set up.  (Polygons which can't reach each other may be offset separately, so this
+     * can happen more than once.)
+     */
+    static void offsetPolygons( const std::vector<POLYGON>& aPolys, int aAmount,
+                                int aCircleSegCount, CORNER_STRATEGY aCornerStrategy,
+                                const std::function<void( ClipperLib::ClipperOffset& aOffset,
+                                                          std::vector<CLIPPER_Z_VALUE>& aZValues,
+                                                          std::vector<SHAPE_ARC>& aArcBuffer )>&
+                                        aExecute );
+
     /**
      * Check whether the point \a aP is inside the \a aSubpolyIndex-th polygon of the polyset. If
      * the points lies on an edge, the polygon is considered to contain it.
@@ -30,6 +30,9 @@ public:
     bool operator==( const MD5_HASH& aOther ) const;
     bool operator!=( const MD5_HASH& aOther ) const;
 
+    ///< An arbitrary (but consistent) order, so that hashes can be used as map keys.
+    bool operator<( const MD5_HASH& aOther ) const;
+
     /** @return Build a hexadecimal string from the 16 bytes of MD5_HASH
      *  Mainly for debug purposes.
      * @param aCompactForm = false to generate a string with spaces between each byte (2 chars)
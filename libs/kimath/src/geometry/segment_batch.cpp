@@ -0,0 +1,230 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include <geometry/segment_batch.h>
+#include <geometry/shape_line_chain.h>
+
+
+/*
+ * SHAPE_ARC::Collide( const SEG& ) tests points that can be rounded to just off the segment, so
+ * the arc prefilter allows for them being a little outside its box.
+ */
+static constexpr int ARC_MARGIN = 2;
+
+
+/**
+ * @return a distance no less than sqrt( \a aDistSq ), allowing for the rounding of the root.
+ */
+static int64_t reach( SEG::ecoord aDistSq )
+{
+    return (int64_t) std::sqrt( (double) aDistSq ) + 1;
+}
+
+
+/**
+ * Compute the box of \a aSeg grown by \a aReach, clamped to the coordinate range.
+ */
+static void queryBox( const SEG& aSeg, int64_t aReach, int32_t aMin[2], int32_t aMax[2] )
+{
+    auto clamp =
+            []( int64_t aValue )
+            {
+                return (int32_t) std::min<int64_t>( std::max<int64_t>( aValue, INT_MIN ), INT_MAX );
+            };
+
+    aMin[0] = clamp( (int64_t) std::min( aSeg.A.x, aSeg.B.x ) - aReach );
+    aMin[1] = clamp( (int64_t) std::min( aSeg.A.y, aSeg.B.y ) - aReach );
+    aMax[0] = clamp( (int64_t) std::max( aSeg.A.x, aSeg.B.x ) + aReach );
+    aMax[1] = clamp( (int64_t) std::max( aSeg.A.y, aSeg.B.y ) + aReach );
+}
+
+
+void SEGMENT_BATCH::BOXES::Clear()
+{
+    m_minX.clear();
+    m_minY.clear();
+    m_maxX.clear();
+    m_maxY.clear();
+}
+
+
+void SEGMENT_BATCH::BOXES::Add( size_t aIndex, const VECTOR2I& aMin, const VECTOR2I& aMax )
+{
+    if( aIndex == m_minX.size() )
+    {
+        m_minX.resize( aIndex + LANES, INT_MAX );
+        m_minY.resize( aIndex + LANES, INT_MAX );
+        m_maxX.resize( aIndex + LANES, INT_MIN );
+        m_maxY.resize( aIndex + LANES, INT_MIN );
+    }
+
+    m_minX[aIndex] = aMin.x;
+    m_minY[aIndex] = aMin.y;
+    m_maxX[aIndex] = aMax.x;
+    m_maxY[aIndex] = aMax.y;
+}
+
+
+unsigned SEGMENT_BATCH::BOXES::Overlaps( size_t aFirst, const int32_t aMin[2],
+                                         const int32_t aMax[2] ) const
+{
+    const int32_t* boxMinX = m_minX.data() + aFirst;
+    const int32_t* boxMinY = m_minY.data() + aFirst;
+    const int32_t* boxMaxX = m_maxX.data() + aFirst;
+    const int32_t* boxMaxY = m_maxY.data() + aFirst;
+    const int32_t  minX = aMin[0], minY = aMin[1], maxX = aMax[0], maxY = aMax[1];
+    int32_t        hit[LANES];
+    unsigned       mask = 0;
+
+    // The last test keeps the padding out of even an all-encompassing query
+    for( int ii = 0; ii < LANES; ++ii )
+    {
+        hit[ii] = ( boxMinX[ii] <= maxX ) & ( boxMaxX[ii] >= minX )
+                & ( boxMinY[ii] <= maxY ) & ( boxMaxY[ii] >= minY )
+                & ( boxMinX[ii] <= boxMaxX[ii] );
+    }
+
+    for( int ii = 0; ii < LANES; ++ii )
+        mask |= (unsigned) hit[ii] << ii;
+
+    return mask;
+}
+
+
+void SEGMENT_BATCH::Clear()
+{
+    m_segs.clear();
+    m_arcs.clear();
+    m_segBoxes.Clear();
+    m_arcBoxes.Clear();
+}
+
+
+void SEGMENT_BATCH::Add( const SEG& aSeg )
+{
+    m_segBoxes.Add( m_segs.size(),
+                    VECTOR2I( std::min( aSeg.A.x, aSeg.B.x ), std::min( aSeg.A.y, aSeg.B.y ) ),
+                    VECTOR2I( std::max( aSeg.A.x, aSeg.B.x ), std::max( aSeg.A.y, aSeg.B.y ) ) );
+
+    m_segs.push_back( aSeg );
+}
+
+
+void SEGMENT_BATCH::Add( const SHAPE_ARC& aArc )
+{
+    // SHAPE_ARC::Collide() only looks at points in this box, grown by the clearance
+    const BOX2I bbox = aArc.BBox( aArc.GetWidth() / 2 );
+
+    m_arcBoxes.Add( m_arcs.size(), VECTOR2I( bbox.GetLeft(), bbox.GetTop() ),
+                    VECTOR2I( bbox.GetRight(), bbox.GetBottom() ) );
+
+    m_arcs.push_back( aArc );
+}
+
+
+void SEGMENT_BATCH::Add( const SHAPE_LINE_CHAIN& aChain )
+{
+    bool hasArcs = aChain.ArcCount() > 0;
+
+    m_segs.reserve( m_segs.size() + aChain.SegmentCount() );
+
+    for( int ii = 0; ii < aChain.SegmentCount(); ++ii )
+    {
+        if( !hasArcs || !aChain.IsArcSegment( ii ) )
+            Add( aChain.CSegment( ii ) );
+    }
+
+    for( size_t ii = 0; ii < aChain.ArcCount(); ++ii )
+        Add( aChain.Arc( ii ) );
+}
+
+
+int SEGMENT_BATCH::NearestSegment( const SEG& aSeg, ecoord aLimitSq, bool aFirst,
+                                   ecoord* aDistSq ) const
+{
+    int32_t min[2], max[2];
+    ecoord  best = VECTOR2I::ECOORD_MAX;
+    int     bestIndex = -1;
+    bool    done = false;
+
+    queryBox( aSeg, reach( aLimitSq ), min, max );
+
+    for( size_t first = 0; !done && first < m_segs.size(); first += LANES )
+    {
+        unsigned mask = m_segBoxes.Overlaps( first, min, max );
+
+        for( int ii = 0; mask && ii < LANES; ++ii )
+        {
+            if( !( mask & ( 1u << ii ) ) )
+                continue;
+
+            ecoord distSq = m_segs[first + ii].SquaredDistance( aSeg );
+
+            if( distSq >= best || ( distSq != 0 && distSq >= aLimitSq ) )
+                continue;
+
+            best = distSq;
+            bestIndex = (int) ( first + ii );
+
+            if( best == 0 || aFirst )
+            {
+                done = true;
+                break;
+            }
+
+            // Nothing further away than this one matters any more
+            queryBox( aSeg, reach( best ), min, max );
+            mask &= m_segBoxes.Overlaps( first, min, max );
+        }
+    }
+
+    if( bestIndex >= 0 && aDistSq )
+        *aDistSq = best;
+
+    return bestIndex;
+}
+
+
+bool SEGMENT_BATCH::CollideArcs( const SEG& aSeg, int aClearance, int* aActual,
+                                 VECTOR2I* aLocation ) const
+{
+    int32_t min[2], max[2];
+
+    queryBox( aSeg, (int64_t) std::max( aClearance, 0 ) + ARC_MARGIN, min, max );
+
+    for( size_t first = 0; first < m_arcs.size(); first += LANES )
+    {
+        unsigned mask = m_arcBoxes.Overlaps( first, min, max );
+
+        for( int ii = 0; mask && ii < LANES; ++ii )
+        {
+            if( ( mask & ( 1u << ii ) )
+                    && m_arcs[first + ii].Collide( aSeg, aClearance, aActual, aLocation ) )
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
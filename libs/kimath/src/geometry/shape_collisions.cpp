@@ -27,6 +27,7 @@
 #include <limits.h>                               // for INT_MAX
 
 #include <geometry/seg.h>                         // for SEG
+#include <geometry/segment_batch.h>
 #include <geometry/shape.h>
 #include <geometry/shape_arc.h>
 #include <geometry/shape_line_chain.h>
@@ -303,36 +304,72 @@ static inline bool Collide( const SHAPE_LINE_CHAIN_BASE& aA, const SHAPE_LINE_CH
     }
     else
     {
-        for( size_t i = 0; i < aB.GetSegmentCount(); i++ )
+        if( aA.Type() == SH_LINE_CHAIN && aA.GetSegmentCount() > SEGMENT_BATCH::LANES )
         {
-            int collision_dist = 0;
-            VECTOR2I pn;
+            // Pack aA once rather than walking all of it again for each segment of aB
+            const SHAPE_LINE_CHAIN* aA_line_chain = static_cast<const SHAPE_LINE_CHAIN*>( &aA );
+            std::vector<SEG>        segs;
 
-            if( aB.Type() == SH_LINE_CHAIN )
-            {
-                const SHAPE_LINE_CHAIN* aB_line_chain = static_cast<const SHAPE_LINE_CHAIN*>( &aB );
+            segs.reserve( aB.GetSegmentCount() );
 
+            for( size_t i = 0; i < aB.GetSegmentCount(); i++ )
+            {
                 // ignore arcs - we will collide these separately
-                if( aB_line_chain->IsArcSegment( i ) )
+                if( aB.Type() == SH_LINE_CHAIN
+                        && static_cast<const SHAPE_LINE_CHAIN*>( &aB )->IsArcSegment( i ) )
+                {
                     continue;
+                }
+
+                segs.push_back( aB.GetSegment( i ) );
             }
 
-            if( aA.Collide( aB.GetSegment( i ), aClearance,
-                            aActual || aLocation ? &collision_dist : nullptr,
-                            aLocation ? &pn : nullptr ) )
+            int      collision_dist = 0;
+            VECTOR2I pn;
+
+            // Without aActual this stops at the first colliding segment, as the loop below does
+            if( aA_line_chain->CollideSegments( segs, aClearance,
+                                                aActual ? &collision_dist : nullptr,
+                                                aLocation ? &pn : nullptr ) )
             {
-                if( collision_dist < closest_dist )
+                nearest = pn;
+                closest_dist = collision_dist;
+            }
+        }
+        else
+        {
+            for( size_t i = 0; i < aB.GetSegmentCount(); i++ )
+            {
+                int collision_dist = 0;
+                VECTOR2I pn;
+
+                if( aB.Type() == SH_LINE_CHAIN )
                 {
-                    nearest = pn;
-                    closest_dist = collision_dist;
+                    const SHAPE_LINE_CHAIN* aB_line_chain =
+                            static_cast<const SHAPE_LINE_CHAIN*>( &aB );
+
+                    // ignore arcs - we will collide these separately
+                    if( aB_line_chain->IsArcSegment( i ) )
+                        continue;
                 }
 
-                if( closest_dist == 0 )
-                    break;
+                if( aA.Collide( aB.GetSegment( i ), aClearance,
+                                aActual || aLocation ? &collision_dist : nullptr,
+                                aLocation ? &pn : nullptr ) )
+                {
+                    if( collision_dist < closest_dist )
+                    {
+                        nearest = pn;
+                        closest_dist = collision_dist;
+                    }
 
-                // If we're not looking for aActual then any collision will do
-                if( !aActual )
-                    break;
+                    if( closest_dist == 0 )
+                        break;
+
+                    // If we're not looking for aActual then any collision will do
+                    if( !aActual )
+                        break;
+                }
             }
         }
 
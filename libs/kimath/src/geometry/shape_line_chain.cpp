@@ -32,6 +32,7 @@
 #include <clipper.hpp>
 #include <core/kicad_algo.h> // for alg::run_on_pair
 #include <geometry/seg.h>    // for SEG, OPT_VECTOR2I
+#include <geometry/segment_batch.h>
 #include <geometry/shape_line_chain.h>
 #include <math/box2.h>       // for BOX2I
 #include <math/util.h>       // for rescale
@@ -100,18 +101,37 @@ ClipperLib::Path SHAPE_LINE_CHAIN::convertToClipper( bool aRequiredOrientation,
                                                      std::vector<SHAPE_ARC>& aArcBuffer ) const
 {
     ClipperLib::Path c_path;
-    SHAPE_LINE_CHAIN input;
     bool             orientation = Area( false ) >= 0;
     ssize_t          shape_offset = aArcBuffer.size();
+    int              pointCount = PointCount();
+
+    c_path.reserve( pointCount );
+
+    // Z value 0 is shared by all the vertices which aren't on an arc.  (Clipper also takes a Z
+    // of 0 to mean "not set", so it can't be given to a vertex which is.)
+    if( aZValueBuffer.empty() )
+        aZValueBuffer.emplace_back();
+
+    if( m_arcs.empty() )
+    {
+        bool reverse = orientation != aRequiredOrientation;
+
+        for( int i = 0; i < pointCount; i++ )
+        {
+            const VECTOR2I& vertex = m_points[ reverse ? pointCount - 1 - i : i ];
+            c_path.emplace_back( vertex.x, vertex.y, 0 );
+        }
+
+        return c_path;
+    }
+
+    SHAPE_LINE_CHAIN input;
 
     if( orientation != aRequiredOrientation )
         input = Reverse();
     else
         input = *this;
 
-    int pointCount = input.PointCount();
-    c_path.reserve( pointCount );
-
     for( int i = 0; i < pointCount; i++ )
     {
         const VECTOR2I& vertex = input.CPoint( i );
@@ -557,6 +577,91 @@ bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance, int* aActual,
 }
 
 
+/**
+ * SHAPE_LINE_CHAIN::Collide( const SEG& ) for a chain packed into \a aBatch.
+ */
+static bool collideBatch( const SHAPE_LINE_CHAIN& aChain, const BOX2I& aChainBBox,
+                          const SEGMENT_BATCH& aBatch, const SEG& aSeg, int aClearance,
+                          int* aActual, VECTOR2I* aLocation )
+{
+    // A point outside the chain's box can't be inside it
+    if( aChain.IsClosed() && aChainBBox.Contains( aSeg.A ) && aChain.PointInside( aSeg.A ) )
+    {
+        if( aLocation )
+            *aLocation = aSeg.A;
+
+        if( aActual )
+            *aActual = 0;
+
+        return true;
+    }
+
+    SEG::ecoord dist_sq = 0;
+    int         nearest = aBatch.NearestSegment( aSeg, SEG::Square( aClearance ), !aActual,
+                                                 &dist_sq );
+
+    if( nearest >= 0 )
+    {
+        if( aLocation )
+            *aLocation = aBatch.Segment( nearest ).NearestPoint( aSeg );
+
+        if( aActual )
+            *aActual = sqrt( dist_sq );
+
+        return true;
+    }
+
+    return aBatch.CollideArcs( aSeg, aClearance, aActual, aLocation );
+}
+
+
+bool SHAPE_LINE_CHAIN::CollideSegments( const std::vector<SEG>& aSegs, int aClearance,
+                                        int* aActual, VECTOR2I* aLocation ) const
+{
+    SEGMENT_BATCH batch;
+    const BOX2I   bbox = IsClosed() ? BBox() : BOX2I();
+    int           closest_dist = INT_MAX;
+    VECTOR2I      nearest;
+
+    batch.Add( *this );
+
+    for( const SEG& seg : aSegs )
+    {
+        int      collision_dist = 0;
+        VECTOR2I pn;
+
+        if( collideBatch( *this, bbox, batch, seg, aClearance,
+                          aActual || aLocation ? &collision_dist : nullptr,
+                          aLocation ? &pn : nullptr ) )
+        {
+            if( collision_dist < closest_dist )
+            {
+                nearest = pn;
+                closest_dist = collision_dist;
+            }
+
+            if( closest_dist == 0 )
+                break;
+
+            // If we're not looking for aActual then any collision will do
+            if( !aActual )
+                break;
+        }
+    }
+
+    if( closest_dist == INT_MAX )
+        return false;
+
+    if( aLocation )
+        *aLocation = nearest;
+
+    if( aActual )
+        *aActual = closest_dist;
+
+    return true;
+}
+
+
 const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Reverse() const
 {
     SHAPE_LINE_CHAIN a( *this );
@@ -29,15 +29,21 @@
  */
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <assert.h>                          // for assert
 #include <cmath>                             // for sqrt, cos, hypot, isinf
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
 #include <istream>                           // for operator<<, operator>>
 #include <limits>                            // for numeric_limits
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>                            // for char_traits, operator!=
+#include <thread>
 #include <type_traits>                       // for swap, move
 #include <unordered_set>
 #include <vector>
@@ -46,6 +52,7 @@
 #include <geometry/geometry_utils.h>
 #include <geometry/polygon_triangulation.h>
 #include <geometry/seg.h>                    // for SEG, OPT_VECTOR2I
+#include <geometry/segment_batch.h>
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_poly_set.h>
@@ -590,39 +597,128 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET
 void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET& aShape,
                                 const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode )
 {
-    if( ( aShape.OutlineCount() > 1 || aOtherShape.OutlineCount() > 0 )
-        && ( aShape.ArcCount() > 0 || aOtherShape.ArcCount() > 0 ) )
-    {
-        wxFAIL_MSG( wxT( "Boolean ops on curved polygons are not supported. You should call "
-                         "ClearArcs() before carrying out the boolean operation." ) );
-    }
+    BOOLEAN_BUILDER op;
 
-    ClipperLib::Clipper c;
+    op.AddSubject( aShape );
+    op.AddClip( aOtherShape );
+    op.execute( aType, *this, aFastMode );
+}
 
-    c.StrictlySimple( aFastMode == PM_STRICTLY_SIMPLE );
 
-    std::vector<CLIPPER_Z_VALUE> zValues;
-    std::vector<SHAPE_ARC> arcBuffer;
-    std::map<VECTOR2I, CLIPPER_Z_VALUE> newIntersectPoints;
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::AddSubject( const SHAPE_POLY_SET& aShape )
+{
+    add( ClipperLib::ptSubject, aShape );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::AddClip( const SHAPE_POLY_SET& aShape )
+{
+    add( ClipperLib::ptClip, aShape );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::AddSubject( const SHAPE_POLY_SET& aShape, int aAmount,
+                                                  int aCircleSegCount,
+                                                  CORNER_STRATEGY aCornerStrategy )
+{
+    add( ClipperLib::ptSubject, aShape, aAmount, aCircleSegCount, aCornerStrategy );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::AddClip( const SHAPE_POLY_SET& aShape, int aAmount,
+                                               int aCircleSegCount,
+                                               CORNER_STRATEGY aCornerStrategy )
+{
+    add( ClipperLib::ptClip, aShape, aAmount, aCircleSegCount, aCornerStrategy );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Union( SHAPE_POLY_SET& aResult, POLYGON_MODE aFastMode )
+{
+    execute( ClipperLib::ctUnion, aResult, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Subtract( SHAPE_POLY_SET& aResult, POLYGON_MODE aFastMode )
+{
+    execute( ClipperLib::ctDifference, aResult, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::Intersect( SHAPE_POLY_SET& aResult,
+                                                 POLYGON_MODE aFastMode )
+{
+    execute( ClipperLib::ctIntersection, aResult, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::add( ClipperLib::PolyType aType,
+                                           const SHAPE_POLY_SET& aShape )
+{
+    ClipperLib::Paths& paths = m_paths[aType];
+
+    m_outlineCount += aShape.OutlineCount();
+    m_hasArcs |= aShape.ArcCount() > 0;
 
     for( const POLYGON& poly : aShape.m_polys )
     {
         for( size_t i = 0; i < poly.size(); i++ )
-        {
-            c.AddPath( poly[i].convertToClipper( i == 0, zValues, arcBuffer ),
-                       ClipperLib::ptSubject, true );
-        }
+            paths.push_back( poly[i].convertToClipper( i == 0, m_zValues, m_arcBuffer ) );
     }
+}
 
-    for( const POLYGON& poly : aOtherShape.m_polys )
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::add( ClipperLib::PolyType aType,
+                                           const SHAPE_POLY_SET& aShape, int aAmount,
+                                           int aCircleSegCount, CORNER_STRATEGY aCornerStrategy )
+{
+    ClipperLib::Paths& paths = m_paths[aType];
+
+    m_outlineCount += aShape.OutlineCount();
+
+    // The offset output is added as plain polygons, with any arcs left as the segments they
+    // were approximated by.  ClipperOffset does copy Z values through at some corners, but
+    // they index the offset's own arc buffer rather than ours, so they're all reset to the
+    // shared Z value 0.
+    offsetPolygons( aShape.m_polys, aAmount, aCircleSegCount, aCornerStrategy,
+            [&]( ClipperLib::ClipperOffset& aOffset, std::vector<CLIPPER_Z_VALUE>& aZValues,
+                 std::vector<SHAPE_ARC>& aArcBuffer )
+            {
+                ClipperLib::Paths solution;
+
+                aOffset.Execute( solution, aAmount );
+
+                for( ClipperLib::Path& path : solution )
+                {
+                    for( ClipperLib::IntPoint& pt : path )
+                        pt.Z = 0;
+
+                    paths.push_back( std::move( path ) );
+                }
+            } );
+
+    if( m_zValues.empty() )
+        m_zValues.emplace_back();
+}
+
+
+void SHAPE_POLY_SET::BOOLEAN_BUILDER::execute( ClipperLib::ClipType aType,
+                                               SHAPE_POLY_SET& aResult, POLYGON_MODE aFastMode )
+{
+    // Arcs are only rebuilt reliably from a single outline with nothing to combine it with
+    if( m_hasArcs && ( m_outlineCount > 1 || HasClips() ) )
     {
-        for( size_t i = 0; i < poly.size(); i++ )
-        {
-            c.AddPath( poly[i].convertToClipper( i == 0, zValues, arcBuffer ),
-                       ClipperLib::ptClip, true );
-        }
+        wxFAIL_MSG( wxT( "Boolean ops on curved polygons are not supported. You should call "
+                         "ClearArcs() before carrying out the boolean operation." ) );
     }
 
+    ClipperLib::Clipper c;
+
+    c.StrictlySimple( aFastMode == PM_STRICTLY_SIMPLE );
+
+    c.AddPaths( m_paths[ClipperLib::ptSubject], ClipperLib::ptSubject, true );
+    c.AddPaths( m_paths[ClipperLib::ptClip], ClipperLib::ptClip, true );
+
     ClipperLib::PolyTree solution;
 
     ClipperLib::ZFillCallback callback =
@@ -635,10 +731,10 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET
                     {
                         ssize_t retval;
 
-                        retval = zValues.at( aZvalue ).m_SecondArcIdx;
+                        retval = m_zValues.at( aZvalue ).m_SecondArcIdx;
 
                         if( retval == -1 || ( aCompareVal > 0 && retval != aCompareVal ) )
-                            retval = zValues.at( aZvalue ).m_FirstArcIdx;
+                            retval = m_zValues.at( aZvalue ).m_FirstArcIdx;
 
                         return retval;
                     };
@@ -673,22 +769,26 @@ void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType, const SHAPE_POLY_SET
                     newZval.m_SecondArcIdx = -1;
                 }
 
-                size_t z_value_ptr = zValues.size();
-                zValues.push_back( newZval );
-
-                // Only worry about arc segments for later processing
-                if( newZval.m_FirstArcIdx != -1 )
-                    newIntersectPoints.insert( { VECTOR2I( pt.X, pt.Y ), newZval } );
+                // Points which aren't on an arc share the first Z value
+                if( newZval.m_FirstArcIdx == -1 )
+                {
+                    pt.Z = 0;
+                    return;
+                }
 
-                pt.Z = z_value_ptr;
+                pt.Z = m_zValues.size();
+                m_zValues.push_back( newZval );
                 //@todo amend X,Y values to true intersection between arcs or arc and segment
             };
 
-    c.ZFillFunction( callback ); // register callback
+    // Intersections only need tracking if there are arcs to be put back together
+    if( !m_arcBuffer.empty() )
+        c.ZFillFunction( callback );
 
     c.Execute( aType, solution, ClipperLib::pftNonZero, ClipperLib::pftNonZero );
 
-    importTree( &solution, zValues, arcBuffer );
+    aResult.m_polys.clear();
+    aResult.importTree( &solution, m_zValues, m_arcBuffer );
 }
 
 
@@ -740,7 +840,113 @@ void SHAPE_POLY_SET::InflateWithLinkedHoles( int aFactor, int aCircleSegmentsCou
 }
 
 
+/**
+ * Split \a aPolys into groups whose outlines, each grown by \a aMargin, can't touch those of
+ * any other group.
+ *
+ * @return the indices of each group's polygons, in ascending order, with the groups ordered
+ *         by their first polygon.  (So a single group holds the polygons in their own order.)
+ */
+static std::vector<std::vector<int>>
+groupOverlapping( const std::vector<SHAPE_POLY_SET::POLYGON>& aPolys, int aMargin )
+{
+    int                count = (int) aPolys.size();
+    std::vector<BOX2I> boxes( count );
+    std::vector<int>   parent( count );
+    std::vector<int>   byLeft( count );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        if( !aPolys[ii].empty() )
+            boxes[ii] = aPolys[ii][0].BBox( aMargin );
+
+        parent[ii] = ii;
+        byLeft[ii] = ii;
+    }
+
+    auto find =
+            [&]( int aIdx )
+            {
+                while( parent[aIdx] != aIdx )
+                    aIdx = parent[aIdx] = parent[parent[aIdx]];
+
+                return aIdx;
+            };
+
+    std::sort( byLeft.begin(), byLeft.end(),
+               [&]( int a, int b )
+               {
+                   return boxes[a].GetLeft() < boxes[b].GetLeft();
+               } );
+
+    // Sweep from left to right, keeping the boxes which haven't ended yet
+    std::vector<int> open;
+
+    for( int idx : byLeft )
+    {
+        const BOX2I& box = boxes[idx];
+
+        open.erase( std::remove_if( open.begin(), open.end(),
+                                    [&]( int aOther )
+                                    {
+                                        return boxes[aOther].GetRight() < box.GetLeft();
+                                    } ),
+                    open.end() );
+
+        for( int other : open )
+        {
+            if( boxes[other].GetTop() <= box.GetBottom()
+                    && box.GetTop() <= boxes[other].GetBottom() )
+            {
+                parent[find( other )] = find( idx );
+            }
+        }
+
+        open.push_back( idx );
+    }
+
+    std::vector<std::vector<int>> groups;
+    std::vector<int>              groupOf( count, -1 );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        int& group = groupOf[find( ii )];
+
+        if( group < 0 )
+        {
+            group = (int) groups.size();
+            groups.emplace_back();
+        }
+
+        groups[group].push_back( ii );
+    }
+
+    return groups;
+}
+
+
 void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegCount, CORNER_STRATEGY aCornerStrategy )
+{
+    std::vector<POLYGON> polys;
+    polys.swap( m_polys );
+
+    offsetPolygons( polys, aAmount, aCircleSegCount, aCornerStrategy,
+            [&]( ClipperLib::ClipperOffset& aOffset, std::vector<CLIPPER_Z_VALUE>& aZValues,
+                 std::vector<SHAPE_ARC>& aArcBuffer )
+            {
+                ClipperLib::PolyTree solution;
+
+                aOffset.Execute( solution, aAmount );
+                importTree( &solution, aZValues, aArcBuffer );
+            } );
+}
+
+
+void SHAPE_POLY_SET::offsetPolygons( const std::vector<POLYGON>& aPolys, int aAmount,
+                                     int aCircleSegCount, CORNER_STRATEGY aCornerStrategy,
+                                     const std::function<void( ClipperLib::ClipperOffset&,
+                                                               std::vector<CLIPPER_Z_VALUE>&,
+                                                               std::vector<SHAPE_ARC>& )>& aExecute )
 {
     using namespace ClipperLib;
     // A static table to avoid repetitive calculations of the coefficient
@@ -749,8 +955,6 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegCount, CORNER_STRATEGY
     #define SEG_CNT_MAX 64
     static double arc_tolerance_factor[SEG_CNT_MAX + 1];
 
-    ClipperOffset c;
-
     // N.B. see the Clipper documentation for jtSquare/jtMiter/jtRound.  They are poorly named
     // and are not what you'd think they are.
     // http://www.angusj.com/delphi/clipper/documentation/Docs/Units/ClipperLib/Types/JoinType.htm
@@ -787,20 +991,6 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegCount, CORNER_STRATEGY
         break;
     }
 
-    std::vector<CLIPPER_Z_VALUE> zValues;
-    std::vector<SHAPE_ARC>       arcBuffer;
-
-    for( const POLYGON& poly : m_polys )
-    {
-        for( size_t i = 0; i < poly.size(); i++ )
-        {
-            c.AddPath( poly[i].convertToClipper( i == 0, zValues, arcBuffer ),
-                       joinType, etClosedPolygon );
-        }
-    }
-
-    PolyTree solution;
-
     // Calculate the arc tolerance (arc error) from the seg count by circle. The seg count is
     // nn = M_PI / acos(1.0 - c.ArcTolerance / abs(aAmount))
     // http://www.angusj.com/delphi/clipper/documentation/Docs/Units/ClipperLib/Classes/ClipperOffset/Properties/ArcTolerance.htm
@@ -822,12 +1012,37 @@ void SHAPE_POLY_SET::Inflate( int aAmount, int aCircleSegCount, CORNER_STRATEGY
         coeff = arc_tolerance_factor[aCircleSegCount];
     }
 
-    c.ArcTolerance = std::abs( aAmount ) * coeff;
-    c.MiterLimit = miterLimit;
-    c.MiterFallback = miterFallback;
-    c.Execute( solution, aAmount );
+    // The cost of Clipper's sweep grows with the number of edges crossing each scanline, so
+    // a set of many small outlines spread over a board (pads, knockouts) is much cheaper to
+    // offset in groups which can't reach each other than in one go.
+    //
+    // Mitred corners reach out by up to miterLimit times the offset; squared ones by sqrt(2).
+    double reach = std::max( aAmount, 0 ) * ( joinType == jtMiter ? miterLimit : 2.0 );
+    int    margin = KiROUND( std::min( reach, (double) std::numeric_limits<int>::max() / 4 ) ) + 1;
+
+    for( const std::vector<int>& group : groupOverlapping( aPolys, margin ) )
+    {
+        ClipperOffset                c;
+        std::vector<CLIPPER_Z_VALUE> zValues;
+        std::vector<SHAPE_ARC>       arcBuffer;
+
+        for( int idx : group )
+        {
+            const POLYGON& poly = aPolys[idx];
+
+            for( size_t i = 0; i < poly.size(); i++ )
+            {
+                c.AddPath( poly[i].convertToClipper( i == 0, zValues, arcBuffer ),
+                           joinType, etClosedPolygon );
+            }
+        }
+
+        c.ArcTolerance = std::abs( aAmount ) * coeff;
+        c.MiterLimit = miterLimit;
+        c.MiterFallback = miterFallback;
 
-    importTree( &solution, zValues, arcBuffer );
+        aExecute( c, zValues, arcBuffer );
+    }
 }
 
 
@@ -835,8 +1050,6 @@ void SHAPE_POLY_SET::importTree( ClipperLib::PolyTree*               tree,
                                  const std::vector<CLIPPER_Z_VALUE>& aZValueBuffer,
                                  const std::vector<SHAPE_ARC>&       aArcBuffer )
 {
-    m_polys.clear();
-
     for( ClipperLib::PolyNode* n = tree->GetFirst(); n; n = n->GetNext() )
     {
         if( !n->IsHole() )
@@ -849,7 +1062,7 @@ void SHAPE_POLY_SET::importTree( ClipperLib::PolyTree*               tree,
             for( unsigned int i = 0; i < n->Childs.size(); i++ )
                 paths.emplace_back( n->Childs[i]->Contour, aZValueBuffer, aArcBuffer );
 
-            m_polys.push_back( paths );
+            m_polys.push_back( std::move( paths ) );
         }
     }
 }
@@ -1481,6 +1694,87 @@ bool SHAPE_POLY_SET::Collide( const SEG& aSeg, int aClearance, int* aActual,
 }
 
 
+bool SHAPE_POLY_SET::CollideSegments( const std::vector<SEG>& aSegs, int aClearance,
+                                      int* aActual, VECTOR2I* aLocation ) const
+{
+    std::vector<SEGMENT_BATCH> batches( m_polys.size() );
+
+    for( unsigned int polygonIdx = 0; polygonIdx < m_polys.size(); polygonIdx++ )
+    {
+        for( CONST_SEGMENT_ITERATOR it = CIterateSegmentsWithHoles( polygonIdx ); it; it++ )
+            batches[polygonIdx].Add( *it );
+    }
+
+    // As in SquaredDistanceToPolygon(), but only edges which collide can be the nearest
+    ecoord   clearance_sq = SEG::Square( aClearance );
+    bool     first = !aActual && !aLocation;
+    int      closest_dist = INT_MAX;
+    VECTOR2I nearest;
+
+    for( const SEG& seg : aSegs )
+    {
+        ecoord   dist_sq = VECTOR2I::ECOORD_MAX;
+        VECTOR2I pn;
+
+        for( unsigned int polygonIdx = 0; polygonIdx < m_polys.size() && dist_sq > 0;
+             polygonIdx++ )
+        {
+            ecoord   polygonDist_sq;
+            VECTOR2I polygonNearest;
+
+            if( containsSingle( seg.A, polygonIdx, 1 ) && containsSingle( seg.B, polygonIdx, 1 ) )
+            {
+                polygonDist_sq = 0;
+                polygonNearest = ( seg.A + seg.B ) / 2;
+            }
+            else
+            {
+                const SEGMENT_BATCH& batch = batches[polygonIdx];
+                int edge = batch.NearestSegment( seg, clearance_sq, first, &polygonDist_sq );
+
+                if( edge < 0 )
+                    continue;
+
+                if( aLocation )
+                    polygonNearest = batch.Segment( edge ).NearestPoint( seg );
+            }
+
+            if( polygonDist_sq < dist_sq )
+            {
+                dist_sq = polygonDist_sq;
+                pn = polygonNearest;
+            }
+        }
+
+        if( dist_sq == 0 || dist_sq < clearance_sq )
+        {
+            int collision_dist = sqrt( dist_sq );
+
+            if( collision_dist < closest_dist )
+            {
+                nearest = pn;
+                closest_dist = collision_dist;
+            }
+
+            // If we're not looking for aActual then any collision will do
+            if( closest_dist == 0 || !aActual )
+                break;
+        }
+    }
+
+    if( closest_dist == INT_MAX )
+        return false;
+
+    if( aLocation )
+        *aLocation = nearest;
+
+    if( aActual )
+        *aActual = closest_dist;
+
+    return true;
+}
+
+
 bool SHAPE_POLY_SET::Collide( const VECTOR2I& aP, int aClearance, int* aActual,
                               VECTOR2I* aLocation ) const
 {
@@ -1542,6 +1836,36 @@ bool SHAPE_POLY_SET::Collide( const SHAPE* aShape, int aClearance, int* aActual,
         return false;
     }
 
+    if( aShape->Type() == SH_LINE_CHAIN )
+    {
+        const SHAPE_LINE_CHAIN* chain = static_cast<const SHAPE_LINE_CHAIN*>( aShape );
+
+        // Arcs are left to the triangulation below
+        if( chain->ArcCount() == 0 && chain->PointCount() > 0 )
+        {
+            // A closed chain can surround the polygons without coming near any of their edges
+            if( chain->IsClosed() && OutlineCount() > 0 && chain->PointInside( CVertex( 0 ) ) )
+            {
+                if( aLocation )
+                    *aLocation = CVertex( 0 );
+
+                if( aActual )
+                    *aActual = 0;
+
+                return true;
+            }
+
+            std::vector<SEG> segs;
+
+            segs.reserve( chain->SegmentCount() );
+
+            for( int ii = 0; ii < chain->SegmentCount(); ii++ )
+                segs.push_back( chain->CSegment( ii ) );
+
+            return CollideSegments( segs, aClearance, aActual, aLocation );
+        }
+    }
+
     const_cast<SHAPE_POLY_SET*>( this )->CacheTriangulation( false );
 
     int      actual = INT_MAX;
@@ -2306,80 +2630,319 @@ bool SHAPE_POLY_SET::IsTriangulationUpToDate() const
 }
 
 
-static SHAPE_POLY_SET partitionPolyIntoRegularCellGrid( const SHAPE_POLY_SET& aPoly, int aSize )
+/**
+ * Call \a aTask with each index below \a aCount, sharing the calls out between the calling
+ * thread and up to \a aCount - 1 helpers handed to \a aSubmitter.
+ *
+ * The calling thread only ever waits for calls which are already running, so a helper which
+ * doesn't get to run until everything is done costs nothing (beyond finding nothing left).
+ */
+static void runTasks( size_t aCount, const std::function<void( size_t )>& aTask,
+                      const SHAPE_POLY_SET::TASK_SUBMITTER& aSubmitter )
 {
-    BOX2I bb = aPoly.BBox();
+    if( !aSubmitter || aCount < 2 )
+    {
+        for( size_t ii = 0; ii < aCount; ++ii )
+            aTask( ii );
+
+        return;
+    }
+
+    // Shared with the helpers, which may outlive this call
+    struct STATE
+    {
+        const std::function<void( size_t )>* m_task;
+        size_t                               m_count;
+        std::atomic<size_t>                  m_next{ 0 };
+        std::atomic<size_t>                  m_done{ 0 };
+        std::mutex                           m_mutex;
+        std::condition_variable              m_finished;
+    };
 
-    double w = bb.GetWidth();
-    double h = bb.GetHeight();
+    std::shared_ptr<STATE> state = std::make_shared<STATE>();
 
-    if( w == 0.0 || h == 0.0 )
-        return aPoly;
+    state->m_task = &aTask;
+    state->m_count = aCount;
 
-    int n_cells_x, n_cells_y;
+    auto work =
+            [state]()
+            {
+                for( size_t ii = state->m_next++; ii < state->m_count; ii = state->m_next++ )
+                {
+                    ( *state->m_task )( ii );
 
-    if( w > h )
-    {
-        n_cells_x = w / aSize;
-        n_cells_y = floor( h / w * n_cells_x ) + 1;
-    }
-    else
+                    if( ++state->m_done == state->m_count )
+                    {
+                        std::lock_guard<std::mutex> lock( state->m_mutex );
+                        state->m_finished.notify_all();
+                    }
+                }
+            };
+
+    size_t helpers = std::min<size_t>( aCount - 1,
+                                       std::max( 1u, std::thread::hardware_concurrency() ) );
+
+    for( size_t ii = 0; ii < helpers; ++ii )
+        aSubmitter( work );
+
+    work();
+
+    std::unique_lock<std::mutex> lock( state->m_mutex );
+    state->m_finished.wait( lock,
+                            [&]()
+                            {
+                                return state->m_done == state->m_count;
+                            } );
+}
+
+
+/**
+ * A square of the grid which polygons are partitioned on for triangulation.  The grid is
+ * aligned to the origin, so that the cells don't move when the polygon changes.
+ */
+struct GRID_CELL
+{
+    int      m_x;       ///< column
+    int      m_y;       ///< row
+    bool     m_empty;   ///< known to be outside the polygon
+    MD5_HASH m_key;     ///< identifies the part of the polygon inside the cell
+};
+
+
+static int gridIndex( int aCoord, int aSize )
+{
+    return (int) std::floor( (double) aCoord / aSize );
+}
+
+
+static int gridCoord( int aIndex, int aSize )
+{
+    int64_t coord = (int64_t) aIndex * aSize;
+
+    return (int) std::clamp<int64_t>( coord, std::numeric_limits<int>::min(),
+                                      std::numeric_limits<int>::max() );
+}
+
+
+/**
+ * @return true if \a aSeg touches the (closed) cell, given that its bounding box does.
+ */
+static bool segTouchesCell( const SEG& aSeg, int aX, int aY, int aSize )
+{
+    int left = gridCoord( aX, aSize );
+    int top = gridCoord( aY, aSize );
+    int right = gridCoord( aX + 1, aSize );
+    int bottom = gridCoord( aY + 1, aSize );
+    int sides = 0;
+
+    // It does unless all the corners are strictly on one side of it
+    for( const VECTOR2I& corner : { VECTOR2I( left, top ), VECTOR2I( right, top ),
+                                    VECTOR2I( right, bottom ), VECTOR2I( left, bottom ) } )
     {
-        n_cells_y = h / aSize;
-        n_cells_x = floor( w / h * n_cells_y ) + 1;
+        sides |= 1 << ( aSeg.Side( corner ) + 1 );
     }
 
-    SHAPE_POLY_SET ps1( aPoly ), ps2( aPoly ), maskSetOdd, maskSetEven;
+    return sides != 1 && sides != 4;
+}
+
+
+/**
+ * @return the cells of the grid of \a aSize squares which the bounding box of \a aPoly
+ *         covers, row by row.
+ *
+ * Each cell is keyed on the edges of \a aPoly which touch it (or, if there are none, on whether
+ * it's inside or out).  These determine the part of the polygon in the cell, so the
+ * part only needs cutting out and triangulating again when the key changes.
+ */
+static std::vector<GRID_CELL> polyGridCells( const SHAPE_POLY_SET& aPoly, int aSize )
+{
+    typedef std::array<int, 4> EDGE;
+
+    BOX2I bb = aPoly.BBox();
+    int   x0 = gridIndex( bb.GetLeft(), aSize );
+    int   y0 = gridIndex( bb.GetTop(), aSize );
+    int   cols = gridIndex( bb.GetRight(), aSize ) - x0 + 1;
+    int   rows = gridIndex( bb.GetBottom(), aSize ) - y0 + 1;
+
+    std::vector<std::vector<EDGE>> edges( (size_t) cols * rows );
 
-    for( int yy = 0; yy < n_cells_y; yy++ )
+    for( int ii = 0; ii < aPoly.OutlineCount(); ++ii )
     {
-        for( int xx = 0; xx < n_cells_x; xx++ )
+        for( const SHAPE_LINE_CHAIN& chain : aPoly.CPolygon( ii ) )
         {
-            VECTOR2I p;
+            for( int jj = 0; jj < chain.SegmentCount(); ++jj )
+            {
+                SEG  seg = chain.CSegment( jj );
+                EDGE edge = { seg.A.x, seg.A.y, seg.B.x, seg.B.y };
+
+                // Cells are closed, so an edge on the line between two belongs to both
+                int left = gridIndex( std::min( seg.A.x, seg.B.x ) - 1, aSize ) - x0;
+                int right = gridIndex( std::max( seg.A.x, seg.B.x ), aSize ) - x0;
+                int top = gridIndex( std::min( seg.A.y, seg.B.y ) - 1, aSize ) - y0;
+                int bottom = gridIndex( std::max( seg.A.y, seg.B.y ), aSize ) - y0;
+
+                for( int yy = std::max( top, 0 ); yy <= std::min( bottom, rows - 1 ); ++yy )
+                {
+                    for( int xx = std::max( left, 0 ); xx <= std::min( right, cols - 1 ); ++xx )
+                    {
+                        if( segTouchesCell( seg, x0 + xx, y0 + yy, aSize ) )
+                            edges[yy * cols + xx].push_back( edge );
+                    }
+                }
+            }
+        }
+    }
 
-            p.x = bb.GetX() + w * xx / n_cells_x;
-            p.y = bb.GetY() + h * yy / n_cells_y;
+    std::vector<GRID_CELL> cells( edges.size() );
 
-            VECTOR2I p2;
+    for( int yy = 0; yy < rows; ++yy )
+    {
+        for( int xx = 0; xx < cols; ++xx )
+        {
+            std::vector<EDGE>& cellEdges = edges[yy * cols + xx];
+            GRID_CELL&         cell = cells[yy * cols + xx];
 
-            p2.x = bb.GetX() + w * ( xx + 1 ) / n_cells_x;
-            p2.y = bb.GetY() + h * ( yy + 1 ) / n_cells_y;
+            cell.m_x = x0 + xx;
+            cell.m_y = y0 + yy;
+            cell.m_empty = false;
 
+            cell.m_key.Hash( cell.m_x );
+            cell.m_key.Hash( cell.m_y );
+            cell.m_key.Hash( (int) cellEdges.size() );
 
-            SHAPE_LINE_CHAIN mask;
-            mask.Append( VECTOR2I( p.x, p.y ) );
-            mask.Append( VECTOR2I( p2.x, p.y ) );
-            mask.Append( VECTOR2I( p2.x, p2.y ) );
-            mask.Append( VECTOR2I( p.x, p2.y ) );
-            mask.SetClosed( true );
+            if( cellEdges.empty() )
+            {
+                VECTOR2I centre( ( (int64_t) gridCoord( cell.m_x, aSize )
+                                           + gridCoord( cell.m_x + 1, aSize ) ) / 2,
+                                 ( (int64_t) gridCoord( cell.m_y, aSize )
+                                           + gridCoord( cell.m_y + 1, aSize ) ) / 2 );
 
-            if( ( xx ^ yy ) & 1 )
-                maskSetOdd.AddOutline( mask );
+                cell.m_empty = !aPoly.Contains( centre );
+                cell.m_key.Hash( cell.m_empty ? 0 : 1 );
+            }
             else
-                maskSetEven.AddOutline( mask );
+            {
+                // The order of the edges depends on where the chains start, which doesn't
+                // matter
+                std::sort( cellEdges.begin(), cellEdges.end() );
+                cell.m_key.Hash( (uint8_t*) cellEdges.data(),
+                                 cellEdges.size() * sizeof( EDGE ) );
+            }
+
+            cell.m_key.Finalize();
         }
     }
 
-    ps1.BooleanIntersection( maskSetOdd, SHAPE_POLY_SET::PM_FAST );
-    ps2.BooleanIntersection( maskSetEven, SHAPE_POLY_SET::PM_FAST );
-    ps1.Fracture( SHAPE_POLY_SET::PM_FAST );
-    ps2.Fracture( SHAPE_POLY_SET::PM_FAST );
+    return cells;
+}
 
-    for( int i = 0; i < ps2.OutlineCount(); i++ )
-        ps1.AddOutline( ps2.COutline( i ) );
 
-    if( ps1.OutlineCount() )
-        return ps1;
-    else
-        return aPoly;
+/**
+ * Cut the parts of \a aPoly in the cells flagged in \a aCut out of it, and fracture them.
+ *
+ * @param aPartCells is filled with the index of the cell each part came from, or -1 if a part
+ *                   spreads across more than one.
+ * @param aMixedCells is set for each cell which a part spreads out of.
+ */
+static SHAPE_POLY_SET
+partitionPolyIntoRegularCellGrid( const SHAPE_POLY_SET& aPoly, int aSize,
+                                  const std::vector<GRID_CELL>& aCells,
+                                  const std::vector<bool>& aCut, std::vector<int>& aPartCells,
+                                  std::vector<bool>& aMixedCells,
+                                  const SHAPE_POLY_SET::TASK_SUBMITTER& aSubmitter )
+{
+    SHAPE_POLY_SET ps[2] = { aPoly, aPoly };
+    SHAPE_POLY_SET maskSet[2];
+
+    for( size_t ii = 0; ii < aCells.size(); ++ii )
+    {
+        if( !aCut[ii] )
+            continue;
+
+        const GRID_CELL& cell = aCells[ii];
+
+        VECTOR2I p( gridCoord( cell.m_x, aSize ), gridCoord( cell.m_y, aSize ) );
+        VECTOR2I p2( gridCoord( cell.m_x + 1, aSize ), gridCoord( cell.m_y + 1, aSize ) );
+
+        SHAPE_LINE_CHAIN mask;
+        mask.Append( VECTOR2I( p.x, p.y ) );
+        mask.Append( VECTOR2I( p2.x, p.y ) );
+        mask.Append( VECTOR2I( p2.x, p2.y ) );
+        mask.Append( VECTOR2I( p.x, p2.y ) );
+        mask.SetClosed( true );
+
+        maskSet[ ( cell.m_x ^ cell.m_y ) & 1 ].AddOutline( mask );
+    }
+
+    // The odd and even cells don't share edges, so they can be cut out side by side
+    runTasks( 2,
+              [&]( size_t ii )
+              {
+                  if( maskSet[ii].OutlineCount() )
+                  {
+                      ps[ii].BooleanIntersection( maskSet[ii], SHAPE_POLY_SET::PM_FAST );
+                      ps[ii].Fracture( SHAPE_POLY_SET::PM_FAST );
+                  }
+                  else
+                  {
+                      ps[ii].RemoveAllContours();
+                  }
+              },
+              aSubmitter );
+
+    for( int i = 0; i < ps[0].OutlineCount(); i++ )
+        ps[1].AddOutline( ps[0].COutline( i ) );
+
+    // Cells which only touch at a corner can end up in one part
+    int x0 = aCells.front().m_x;
+    int y0 = aCells.front().m_y;
+    int cols = aCells.back().m_x - x0 + 1;
+    int rows = aCells.back().m_y - y0 + 1;
+
+    aPartCells.clear();
+    aMixedCells.assign( aCells.size(), false );
+
+    for( int ii = 0; ii < ps[1].OutlineCount(); ++ii )
+    {
+        BOX2I box = ps[1].COutline( ii ).BBox();
+        int   left = gridIndex( box.GetLeft(), aSize ) - x0;
+        int   right = gridIndex( box.GetRight() - 1, aSize ) - x0;
+        int   top = gridIndex( box.GetTop(), aSize ) - y0;
+        int   bottom = gridIndex( box.GetBottom() - 1, aSize ) - y0;
+
+        left = std::max( left, 0 );
+        right = std::max( std::min( right, cols - 1 ), left );
+        top = std::max( top, 0 );
+        bottom = std::max( std::min( bottom, rows - 1 ), top );
+
+        if( left == right && top == bottom )
+        {
+            aPartCells.push_back( top * cols + left );
+            continue;
+        }
+
+        aPartCells.push_back( -1 );
+
+        for( int yy = top; yy <= bottom; ++yy )
+        {
+            for( int xx = left; xx <= right; ++xx )
+                aMixedCells[yy * cols + xx] = true;
+        }
+    }
+
+    return ps[1];
 }
 
 
-void SHAPE_POLY_SET::CacheTriangulation( bool aPartition )
+void SHAPE_POLY_SET::CacheTriangulation( bool aPartition, const TASK_SUBMITTER& aSubmitter,
+                                         const SHAPE_POLY_SET* aHint, int* aReusedCells )
 {
     bool recalculate = !m_hash.IsValid();
     MD5_HASH hash;
 
+    if( aReusedCells )
+        *aReusedCells = 0;
+
     if( !m_triangulationValid )
         recalculate = true;
 
@@ -2428,20 +2991,140 @@ void SHAPE_POLY_SET::CacheTriangulation( bool aPartition )
                 return triangulationValid;
             };
 
-    m_triangulatedPolys.clear();
-    m_triangulationValid = true;
+    // The pieces which get triangulated on their own: the parts of each outline in the cells
+    // of the partition, or the outlines of the fractured set.
+    struct PIECE
+    {
+        int                                                m_outline;
+        MD5_HASH                                           m_cellKey;  ///< if all in one cell
+        POLYGON                                            m_poly;
+        std::vector<std::unique_ptr<TRIANGULATED_POLYGON>> m_triangulated;
+        bool                                               m_reused = false;
+        bool                                               m_valid = false;
+    };
+
+    // A deque, as a vector would try to copy the pieces when it grows (MD5_HASH can't move)
+    std::deque<PIECE> pieces;
 
     if( aPartition )
     {
-        for( int ii = 0; ii < OutlineCount(); ++ii )
+        // The triangulations of the cells of aHint, by key
+        struct HINT_CELL
+        {
+            int                                      m_outline;
+            std::vector<const TRIANGULATED_POLYGON*> m_triangulated;
+        };
+
+        std::map<MD5_HASH, HINT_CELL> hintCells;
+
+        if( aHint )
         {
-            // This partitions into regularly-sized grids (1cm in Pcbnew)
-            SHAPE_POLY_SET flattened( Outline( ii ) );
-            flattened.ClearArcs();
-            SHAPE_POLY_SET partitions = partitionPolyIntoRegularCellGrid( flattened, 1e7 );
+            for( const std::unique_ptr<TRIANGULATED_POLYGON>& tri : aHint->m_triangulatedPolys )
+            {
+                if( !tri->GetSourceCellKey().IsValid() )
+                    continue;
+
+                HINT_CELL& cell = hintCells.emplace( tri->GetSourceCellKey(),
+                                                     HINT_CELL{ tri->GetSourceOutlineIndex(), {} } )
+                                          .first->second;
 
-            m_triangulationValid &= triangulate( partitions, ii, m_triangulatedPolys );
+                // Identical outlines have identical cells; don't try to tell them apart
+                if( cell.m_outline != tri->GetSourceOutlineIndex() )
+                    cell.m_outline = -1;
+
+                cell.m_triangulated.push_back( tri.get() );
+            }
         }
+
+        std::vector<std::deque<PIECE>> outlinePieces( OutlineCount() );
+
+        runTasks( outlinePieces.size(),
+                  [&]( size_t ii )
+                  {
+                      // This partitions into regularly-sized grids (1cm in Pcbnew)
+                      const int              cellSize = 1e7;
+                      std::deque<PIECE>&     outline = outlinePieces[ii];
+                      SHAPE_POLY_SET         flattened( Outline( ii ) );
+
+                      flattened.ClearArcs();
+
+                      std::vector<GRID_CELL> cells = polyGridCells( flattened, cellSize );
+                      std::vector<bool>      cut( cells.size(), false );
+                      bool                   anyCut = false;
+
+                      for( size_t jj = 0; jj < cells.size(); ++jj )
+                      {
+                          if( cells[jj].m_empty )
+                              continue;
+
+                          auto hint = hintCells.find( cells[jj].m_key );
+
+                          if( hint == hintCells.end() || hint->second.m_outline < 0 )
+                          {
+                              cut[jj] = anyCut = true;
+                              continue;
+                          }
+
+                          PIECE& piece = outline.emplace_back();
+
+                          piece.m_outline = ii;
+                          piece.m_cellKey = cells[jj].m_key;
+                          piece.m_reused = piece.m_valid = true;
+
+                          for( const TRIANGULATED_POLYGON* tri : hint->second.m_triangulated )
+                          {
+                              piece.m_triangulated.push_back(
+                                      std::make_unique<TRIANGULATED_POLYGON>( *tri ) );
+                              piece.m_triangulated.back()->SetSourceOutlineIndex( ii );
+                          }
+                      }
+
+                      if( !anyCut )
+                          return;
+
+                      if( cells.size() == 1 )
+                      {
+                          PIECE& piece = outline.emplace_back();
+
+                          piece.m_outline = ii;
+                          piece.m_cellKey = cells[0].m_key;
+                          piece.m_poly = std::move( flattened.Polygon( 0 ) );
+                          return;
+                      }
+
+                      std::vector<int>  partCells;
+                      std::vector<bool> mixedCells;
+                      SHAPE_POLY_SET    parts = partitionPolyIntoRegularCellGrid( flattened,
+                                                                                  cellSize, cells,
+                                                                                  cut, partCells,
+                                                                                  mixedCells,
+                                                                                  aSubmitter );
+
+                      if( parts.OutlineCount() == 0 && outline.empty() )
+                      {
+                          PIECE& piece = outline.emplace_back();
+
+                          piece.m_outline = ii;
+                          piece.m_poly = std::move( flattened.Polygon( 0 ) );
+                          return;
+                      }
+
+                      for( int jj = 0; jj < parts.OutlineCount(); ++jj )
+                      {
+                          PIECE& piece = outline.emplace_back();
+                          int    cell = partCells[jj];
+
+                          piece.m_outline = ii;
+                          piece.m_poly = std::move( parts.Polygon( jj ) );
+
+                          if( cell >= 0 && !mixedCells[cell] )
+                              piece.m_cellKey = cells[cell].m_key;
+                      }
+                  },
+                  aSubmitter );
+
+        for( std::deque<PIECE>& outline : outlinePieces )
+            std::move( outline.begin(), outline.end(), std::back_inserter( pieces ) );
     }
     else
     {
@@ -2450,7 +3133,62 @@ void SHAPE_POLY_SET::CacheTriangulation( bool aPartition )
         if( tmpSet.HasHoles() )
             tmpSet.Fracture( PM_FAST );
 
-        m_triangulationValid = triangulate( tmpSet, -1, m_triangulatedPolys );
+        for( POLYGON& poly : tmpSet.m_polys )
+        {
+            PIECE& piece = pieces.emplace_back();
+
+            piece.m_outline = -1;
+            piece.m_poly = std::move( poly );
+        }
+    }
+
+    runTasks( pieces.size(),
+              [&]( size_t ii )
+              {
+                  PIECE&         piece = pieces[ii];
+                  SHAPE_POLY_SET polySet;
+
+                  if( piece.m_reused )
+                      return;
+
+                  polySet.m_polys.push_back( std::move( piece.m_poly ) );
+                  piece.m_valid = triangulate( polySet, piece.m_outline, piece.m_triangulated );
+              },
+              aSubmitter );
+
+    // The triangles of a cell can only be reused if all of its parts were triangulated
+    std::map<MD5_HASH, bool> validCells;
+
+    for( const PIECE& piece : pieces )
+    {
+        if( piece.m_cellKey.IsValid() )
+            validCells.emplace( piece.m_cellKey, true ).first->second &= piece.m_valid;
+    }
+
+    m_triangulatedPolys.clear();
+
+    // An empty set doesn't count as triangulated unless it was partitioned
+    m_triangulationValid = aPartition || !pieces.empty();
+
+    for( PIECE& piece : pieces )
+    {
+        bool reusable = piece.m_cellKey.IsValid() && validCells[piece.m_cellKey];
+
+        if( piece.m_reused && aReusedCells )
+            ( *aReusedCells )++;
+
+        for( std::unique_ptr<TRIANGULATED_POLYGON>& tri : piece.m_triangulated )
+        {
+            if( tri->GetTriangleCount() == 0 )
+                continue;
+
+            if( reusable )
+                tri->SetSourceCellKey( piece.m_cellKey );
+
+            m_triangulatedPolys.push_back( std::move( tri ) );
+        }
+
+        m_triangulationValid &= piece.m_valid;
     }
 
     if( m_triangulationValid )
@@ -2570,6 +3308,7 @@ void SHAPE_POLY_SET::TRIANGULATED_POLYGON::AddTriangle( int a, int b, int c )
 SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRIANGULATED_POLYGON( const TRIANGULATED_POLYGON& aOther )
 {
     m_sourceOutline = aOther.m_sourceOutline;
+    m_sourceCellKey = aOther.m_sourceCellKey;
     m_vertices = aOther.m_vertices;
     m_triangles = aOther.m_triangles;
 
@@ -2581,6 +3320,7 @@ SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRIANGULATED_POLYGON( const TRIANGULATED_P
 SHAPE_POLY_SET::TRIANGULATED_POLYGON& SHAPE_POLY_SET::TRIANGULATED_POLYGON::operator=( const TRIANGULATED_POLYGON& aOther )
 {
     m_sourceOutline = aOther.m_sourceOutline;
+    m_sourceCellKey = aOther.m_sourceCellKey;
     m_vertices = aOther.m_vertices;
     m_triangles = aOther.m_triangles;
 
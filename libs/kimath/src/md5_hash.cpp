@@ -94,6 +94,12 @@ bool MD5_HASH::operator!=( const MD5_HASH& aOther ) const
 }
 
 
+bool MD5_HASH::operator<( const MD5_HASH& aOther ) const
+{
+    return ( memcmp( m_hash, aOther.m_hash, 16 ) < 0 );
+}
+
+
 std::string MD5_HASH::Format( bool aCompactForm )
 {
     std::string data;
@@ -29,6 +29,7 @@
 
 #include <wx/log.h>
 
+#include <drc/drc_engine.h>
 #include <drc/drc_rtree.h>
 #include <board_design_settings.h>
 #include <board_commit.h>
@@ -217,14 +218,16 @@ void BOARD::IncrementTimeStamp()
 {
     m_timeStamp++;
 
+    m_IntersectsAreaCache.Clear();
+    m_EnclosedByAreaCache.Clear();
+    m_IntersectsCourtyardCache.Clear();
+    m_IntersectsFCourtyardCache.Clear();
+    m_IntersectsBCourtyardCache.Clear();
+    m_LayerExpressionCache.Clear();
+    m_ZoneBBoxCache.Clear();
+
     {
         std::unique_lock<std::mutex> cacheLock( m_CachesMutex );
-        m_IntersectsAreaCache.clear();
-        m_EnclosedByAreaCache.clear();
-        m_IntersectsCourtyardCache.clear();
-        m_IntersectsFCourtyardCache.clear();
-        m_IntersectsBCourtyardCache.clear();
-        m_LayerExpressionCache.clear();
 
         m_DRCMaxClearance = 0;
         m_DRCMaxPhysicalClearance = 0;
@@ -232,7 +235,6 @@ void BOARD::IncrementTimeStamp()
         m_DRCCopperZones.clear();
         m_CopperZoneRTreeCache.clear();
         m_CopperItemRTreeCache = std::make_unique<DRC_RTREE>();
-        m_ZoneBBoxCache.clear();
     }
 }
 
@@ -1468,6 +1470,10 @@ void BOARD::SynchronizeNetsAndNetClasses()
     for( NETINFO_ITEM* net : m_NetInfo )
         net->SetNetClass( bds.m_NetSettings->GetEffectiveNetClass( net->GetNetname() ) );
 
+    // Rule resolution is cached by net class
+    if( bds.m_DRCEngine )
+        bds.m_DRCEngine->ClearConstraintCache();
+
     // Set initial values for custom track width & via size to match the default
     // netclass settings
     bds.UseCustomTrackViaSize( false );
@@ -1955,11 +1961,19 @@ void BOARD::MapNets( const BOARD* aDestBoard )
 
 void BOARD::SanitizeNetcodes()
 {
+    std::vector<BOARD_ITEM*> netChanged;
+
     for ( BOARD_CONNECTED_ITEM* item : AllConnectedItems() )
     {
         if( FindNet( item->GetNetCode() ) == nullptr )
+        {
             item->SetNetCode( NETINFO_LIST::ORPHANED );
+            netChanged.push_back( item );
+        }
     }
+
+    if( !netChanged.empty() )
+        OnItemsNetChanged( netChanged );
 }
 
 
@@ -2000,6 +2014,12 @@ void BOARD::OnItemsChanged( std::vector<BOARD_ITEM*>& aItems )
 }
 
 
+void BOARD::OnItemsNetChanged( std::vector<BOARD_ITEM*>& aItems )
+{
+    InvokeListeners( &BOARD_LISTENER::OnBoardItemsNetChanged, *this, aItems );
+}
+
+
 void BOARD::ResetNetHighLight()
 {
     m_highLight.Clear();
@@ -27,6 +27,7 @@
 
 #include <board_item_container.h>
 #include <common.h> // Needed for stl hash extensions
+#include <concurrent_cache.h>
 #include <convert_shape_list_to_polygon.h> // for OUTLINE_ERROR_HANDLER
 #include <hash.h>
 #include <layer_ids.h>
@@ -244,6 +245,7 @@ public:
     virtual void OnBoardNetSettingsChanged( BOARD& aBoard ) { }
     virtual void OnBoardItemChanged( BOARD& aBoard, BOARD_ITEM* aBoardItem ) { }
     virtual void OnBoardItemsChanged( BOARD& aBoard, std::vector<BOARD_ITEM*>& aBoardItem ) { }
+    virtual void OnBoardItemsNetChanged( BOARD& aBoard, std::vector<BOARD_ITEM*>& aBoardItem ) { }
     virtual void OnBoardHighlightNetChanged( BOARD& aBoard ) { }
 };
 
@@ -1099,6 +1101,12 @@ public:
       */
     void OnItemsChanged( std::vector<BOARD_ITEM*>& aItems );
 
+    /**
+      * Notify the board's listeners that the nets of some connected items have been changed
+      * by net propagation or sanitization rather than by an edit.
+      */
+    void OnItemsNetChanged( std::vector<BOARD_ITEM*>& aItems );
+
     /**
      * Consistency check of internal m_groups structure.
      *
@@ -1142,16 +1150,19 @@ public:
     };
 
     // ------------ Run-time caches -------------
+    // These are hit from every DRC worker thread, so are individually thread-safe.
+    CONCURRENT_CACHE<PTR_PTR_CACHE_KEY, bool>             m_IntersectsCourtyardCache;
+    CONCURRENT_CACHE<PTR_PTR_CACHE_KEY, bool>             m_IntersectsFCourtyardCache;
+    CONCURRENT_CACHE<PTR_PTR_CACHE_KEY, bool>             m_IntersectsBCourtyardCache;
+    CONCURRENT_CACHE<PTR_PTR_LAYER_CACHE_KEY, bool>       m_IntersectsAreaCache;
+    CONCURRENT_CACHE<PTR_PTR_LAYER_CACHE_KEY, bool>       m_EnclosedByAreaCache;
+    CONCURRENT_CACHE<wxString, LSET>                      m_LayerExpressionCache;
+    mutable CONCURRENT_CACHE<const ZONE*, BOX2I>          m_ZoneBBoxCache;
+
+    // Guards the R-tree caches while they're being built
     std::mutex                                            m_CachesMutex;
-    std::unordered_map<PTR_PTR_CACHE_KEY, bool>           m_IntersectsCourtyardCache;
-    std::unordered_map<PTR_PTR_CACHE_KEY, bool>           m_IntersectsFCourtyardCache;
-    std::unordered_map<PTR_PTR_CACHE_KEY, bool>           m_IntersectsBCourtyardCache;
-    std::unordered_map<PTR_PTR_LAYER_CACHE_KEY, bool>     m_IntersectsAreaCache;
-    std::unordered_map<PTR_PTR_LAYER_CACHE_KEY, bool>     m_EnclosedByAreaCache;
-    std::unordered_map< wxString, LSET >                  m_LayerExpressionCache;
     std::unordered_map<ZONE*, std::unique_ptr<DRC_RTREE>> m_CopperZoneRTreeCache;
     std::unique_ptr<DRC_RTREE>                            m_CopperItemRTreeCache;
-    mutable std::unordered_map<const ZONE*, BOX2I>        m_ZoneBBoxCache;
 
     // ------------ DRC caches -------------
     std::vector<ZONE*>    m_DRCZones;
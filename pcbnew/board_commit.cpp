@@ -24,6 +24,7 @@
  */
 
 #include <board.h>
+#include <board_design_settings.h>
 #include <footprint.h>
 #include <pcb_group.h>
 #include <tool/tool_manager.h>
@@ -105,7 +106,7 @@ COMMIT& BOARD_COMMIT::Stage( const PICKED_ITEMS_LIST& aItems, UNDO_REDO aModFlag
 }
 
 
-void BOARD_COMMIT::dirtyIntersectingZones( BOARD_ITEM* item )
+void BOARD_COMMIT::dirtyIntersectingZones( BOARD_ITEM* item, int aWorstClearance )
 {
     wxCHECK( item, /* void */ );
 
@@ -119,7 +120,7 @@ void BOARD_COMMIT::dirtyIntersectingZones( BOARD_ITEM* item )
         static_cast<FOOTPRINT*>( item )->RunOnChildren(
                 [&]( BOARD_ITEM* child )
                 {
-                    dirtyIntersectingZones( child );
+                    dirtyIntersectingZones( child, aWorstClearance );
                 } );
     }
     else if( item->Type() == PCB_GROUP_T )
@@ -127,7 +128,7 @@ void BOARD_COMMIT::dirtyIntersectingZones( BOARD_ITEM* item )
         static_cast<PCB_GROUP*>( item )->RunOnChildren(
                 [&]( BOARD_ITEM* child )
                 {
-                    dirtyIntersectingZones( child );
+                    dirtyIntersectingZones( child, aWorstClearance );
                 } );
     }
     else
@@ -136,6 +137,9 @@ void BOARD_COMMIT::dirtyIntersectingZones( BOARD_ITEM* item )
         BOX2I  bbox = item->GetBoundingBox();
         LSET   layers = item->GetLayerSet();
 
+        // Items within clearance distance of a zone still knock out part of its fill
+        bbox.Inflate( aWorstClearance );
+
         if( layers.test( Edge_Cuts ) || layers.test( Margin ) )
             layers = LSET::PhysicalLayersMask();
         else
@@ -148,11 +152,10 @@ void BOARD_COMMIT::dirtyIntersectingZones( BOARD_ITEM* item )
                 if( zone->GetIsRuleArea() )
                     continue;
 
-                if( ( zone->GetLayerSet() & layers ).any()
-                        && zone->GetBoundingBox().Intersects( bbox ) )
-                {
-                    zoneFillerTool->DirtyZone( zone );
-                }
+                LSET zoneLayers = zone->GetLayerSet() & layers;
+
+                if( zoneLayers.any() && zone->GetBoundingBox().Intersects( bbox ) )
+                    zoneFillerTool->DirtyZone( zone, zoneLayers );
             }
         }
     }
@@ -171,6 +174,7 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
     bool                itemsDeselected = false;
     bool                solderMaskDirty = false;
     bool                autofillZones = false;
+    int                 worstClearance = 0;
 
     std::vector<BOARD_ITEM*> bulkAddedItems;
     std::vector<BOARD_ITEM*> bulkRemovedItems;
@@ -184,9 +188,13 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
             && ( frame && frame->GetPcbNewSettings()->m_AutoRefillZones ) )
     {
         autofillZones = true;
+        worstClearance = board->GetDesignSettings().GetBiggestClearanceValue();
 
         for( ZONE* zone : board->Zones() )
+        {
             zone->CacheBoundingBox();
+            worstClearance = std::max( worstClearance, zone->GetLocalClearance() );
+        }
     }
 
     for( COMMIT_LINE& ent : m_changes )
@@ -281,7 +289,7 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
                 }
 
                 if( autofillZones && boardItem->Type() != PCB_MARKER_T )
-                    dirtyIntersectingZones( boardItem );
+                    dirtyIntersectingZones( boardItem, worstClearance );
 
                 if( view && boardItem->Type() != PCB_NETINFO_T )
                     view->Add( boardItem );
@@ -303,7 +311,7 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
                 }
 
                 if( autofillZones )
-                    dirtyIntersectingZones( boardItem );
+                    dirtyIntersectingZones( boardItem, worstClearance );
 
                 switch( boardItem->Type() )
                 {
@@ -446,8 +454,10 @@ void BOARD_COMMIT::Push( const wxString& aMessage, int aCommitFlags )
 
                 if( autofillZones )
                 {
-                    dirtyIntersectingZones( static_cast<BOARD_ITEM*>( ent.m_copy ));   // before
-                    dirtyIntersectingZones( boardItem );                               // after
+                    BOARD_ITEM* before = static_cast<BOARD_ITEM*>( ent.m_copy );
+
+                    dirtyIntersectingZones( before, worstClearance );
+                    dirtyIntersectingZones( boardItem, worstClearance );
                 }
 
                 if( view )
@@ -75,7 +75,7 @@ public:
 private:
     virtual EDA_ITEM* parentObject( EDA_ITEM* aItem ) const override;
 
-    void dirtyIntersectingZones( BOARD_ITEM* item );
+    void dirtyIntersectingZones( BOARD_ITEM* item, int aWorstClearance );
 
 private:
     TOOL_MANAGER*  m_toolMgr;
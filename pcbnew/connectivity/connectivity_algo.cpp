@@ -27,7 +27,6 @@
 
 #include <algorithm>
 #include <future>
-#include <mutex>
 
 #include <connectivity/connectivity_algo.h>
 #include <progress_reporter.h>
@@ -42,6 +41,22 @@
 #endif
 
 
+CN_CONNECTIVITY_ALGO::CN_CONNECTIVITY_ALGO() :
+        // Nets are propagated from pads along tracks and vias; zones don't carry them
+        m_propagateForest( false,
+                           []( const CN_ITEM* aItem )
+                           {
+                               return aItem->Parent()->Type() != PCB_ZONE_T;
+                           } ),
+        m_netForest( true,
+                     []( const CN_ITEM* aItem )
+                     {
+                         return aItem->Net() > 0;
+                     } )
+{
+}
+
+
 bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
 {
     markItemNetAsDirty( aItem );
@@ -78,6 +93,15 @@ bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
         break;
 
     case PCB_ZONE_T:
+        // The zone may have changed net since its items were made
+        for( CN_ITEM* item : m_itemMap[aItem].GetItems() )
+        {
+            MarkNetAsDirty( item->Net() );
+            markZoneNetAsChanged( item->Net() );
+        }
+
+        markZoneNetAsChanged( static_cast<ZONE*>( aItem )->GetNetCode() );
+
         m_itemMap[aItem].MarkItemsAsInvalid();
         m_itemMap.erase ( aItem );
         m_itemList.SetDirty( true );
@@ -191,6 +215,8 @@ bool CN_CONNECTIVITY_ALGO::Add( BOARD_ITEM* aItem )
             for( CN_ITEM* zitem : m_itemList.Add( zone, layer ) )
                 m_itemMap[zone].Link( zitem );
         }
+
+        markZoneNetAsChanged( zone->GetNetCode() );
     }
         break;
 
@@ -215,7 +241,11 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
     m_itemList.RemoveInvalidItems( garbage );
 
     for( CN_ITEM* item : garbage )
+    {
+        m_propagateForest.Remove( item );
+        m_netForest.Remove( item );
         delete item;
+    }
 
 #ifdef PROFILE
     garbage_collection.Show();
@@ -240,26 +270,38 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
 
     if( m_itemList.IsDirty() )
     {
+        // Each batch records the connections it finds in its own list, and they're applied to
+        // the items once all batches are done.  Batches take every n-th item so that expensive
+        // items (such as zones, which are added together) are spread between them.
+        size_t batchCount = std::min<size_t>( dirtyItems.size(), tp.get_thread_count() * 4 );
 
-        std::vector<std::future<size_t>> returns( dirtyItems.size() );
+        std::vector<CN_VISITOR::CONNECTIONS> connections( batchCount );
+        std::vector<std::future<size_t>>     returns( batchCount );
 
         auto conn_lambda =
-                [&dirtyItems]( size_t aItem, CN_LIST* aItemList,
-                               PROGRESS_REPORTER* aReporter) -> size_t
+                [&dirtyItems, &connections, batchCount]( size_t aBatch, CN_LIST* aItemList,
+                                                         PROGRESS_REPORTER* aReporter) -> size_t
                 {
-                    if( aReporter && aReporter->IsCancelled() )
-                        return 0;
+                    size_t count = 0;
+
+                    for( size_t ii = aBatch; ii < dirtyItems.size(); ii += batchCount )
+                    {
+                        if( aReporter && aReporter->IsCancelled() )
+                            break;
 
-                    CN_VISITOR visitor( dirtyItems[aItem] );
-                    aItemList->FindNearby( dirtyItems[aItem], visitor );
+                        CN_VISITOR visitor( dirtyItems[ii], connections[aBatch] );
+                        aItemList->FindNearby( dirtyItems[ii], visitor );
 
-                    if( aReporter )
-                        aReporter->AdvanceProgress();
+                        if( aReporter )
+                            aReporter->AdvanceProgress();
+
+                        count++;
+                    }
 
-                    return 1;
+                    return count;
                 };
 
-        for( size_t ii = 0; ii < dirtyItems.size(); ++ii )
+        for( size_t ii = 0; ii < batchCount; ++ii )
             returns[ii] = tp.submit( conn_lambda, ii, &m_itemList, m_progressReporter );
 
         for( const std::future<size_t>& ret : returns )
@@ -276,6 +318,15 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
             }
         }
 
+        for( const CN_VISITOR::CONNECTIONS& batch : connections )
+        {
+            for( const std::pair<CN_ITEM*, CN_ITEM*>& connection : batch )
+            {
+                connection.first->Connect( connection.second );
+                connection.second->Connect( connection.first );
+            }
+        }
+
         if( m_progressReporter )
             m_progressReporter->KeepRefreshing();
     }
@@ -284,24 +335,28 @@ void CN_CONNECTIVITY_ALGO::searchConnections()
         search_basic.Show();
 #endif
 
+    for( CN_ITEM* item : dirtyItems )
+    {
+        m_propagateForest.Add( item );
+        m_netForest.Add( item );
+    }
+
     m_itemList.ClearDirtyFlags();
 }
 
 
 const CN_CONNECTIVITY_ALGO::CLUSTERS CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode )
 {
+    if( m_itemList.IsDirty() )
+        searchConnections();
+
+    if( m_progressReporter && m_progressReporter->IsCancelled() )
+        return CLUSTERS();
+
     if( aMode == CSM_PROPAGATE )
-    {
-        return SearchClusters( aMode,
-                               { PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T, PCB_FOOTPRINT_T },
-                               -1 );
-    }
+        return m_propagateForest.GetClusters();
     else
-    {
-        return SearchClusters( aMode,
-                               { PCB_TRACE_T, PCB_ARC_T, PCB_PAD_T, PCB_VIA_T, PCB_ZONE_T, PCB_FOOTPRINT_T },
-                               -1 );
-    }
+        return m_netForest.GetClusters();
 }
 
 
@@ -312,101 +367,40 @@ CN_CONNECTIVITY_ALGO::SearchClusters( CLUSTER_SEARCH_MODE aMode,
 {
     bool withinAnyNet = ( aMode != CSM_PROPAGATE );
 
-    std::deque<CN_ITEM*> Q;
-    std::set<CN_ITEM*> item_set;
-
-    CLUSTERS clusters;
-
     if( m_itemList.IsDirty() )
         searchConnections();
 
-    auto addToSearchList =
-            [&item_set, withinAnyNet, aSingleNet, &aTypes, rootItem ]( CN_ITEM *aItem )
+    CN_CLUSTER_FOREST forest( withinAnyNet,
+            [withinAnyNet, aSingleNet, &aTypes, rootItem]( const CN_ITEM* aItem ) -> bool
             {
-                if( withinAnyNet && aItem->Net() <= 0 )
-                    return;
-
                 if( !aItem->Valid() )
-                    return;
+                    return false;
+
+                if( withinAnyNet && aItem->Net() <= 0 )
+                    return false;
 
                 if( aSingleNet >=0 && aItem->Net() != aSingleNet )
-                    return;
+                    return false;
 
-                bool found = false;
+                if( aItem == rootItem )
+                    return true;
 
                 for( KICAD_T type : aTypes )
                 {
                     if( aItem->Parent()->Type() == type )
-                    {
-                        found = true;
-                        break;
-                    }
+                        return true;
                 }
 
-                if( !found && aItem != rootItem )
-                    return;
-
-                aItem->SetVisited( false );
-
-                item_set.insert( aItem );
-            };
-
-    std::for_each( m_itemList.begin(), m_itemList.end(), addToSearchList );
-
-    if( m_progressReporter && m_progressReporter->IsCancelled() )
-        return CLUSTERS();
-
-    while( !item_set.empty() )
-    {
-        std::shared_ptr<CN_CLUSTER> cluster = std::make_shared<CN_CLUSTER>();
-        CN_ITEM*                    root;
-        auto                        it = item_set.begin();
-
-        while( it != item_set.end() && (*it)->Visited() )
-            it = item_set.erase( item_set.begin() );
-
-        if( it == item_set.end() )
-            break;
-
-        root = *it;
-        root->SetVisited( true );
-
-        Q.clear();
-        Q.push_back( root );
-
-        while( Q.size() )
-        {
-            CN_ITEM* current = Q.front();
-
-            Q.pop_front();
-            cluster->Add( current );
-
-            for( CN_ITEM* n : current->ConnectedItems() )
-            {
-                if( withinAnyNet && n->Net() != root->Net() )
-                    continue;
-
-                if( !n->Visited() && n->Valid() )
-                {
-                    n->SetVisited( true );
-                    Q.push_back( n );
-                }
-            }
-        }
+                return false;
+            } );
 
-        clusters.push_back( cluster );
-    }
+    for( CN_ITEM* item : m_itemList )
+        forest.Add( item );
 
     if( m_progressReporter && m_progressReporter->IsCancelled() )
         return CLUSTERS();
 
-    std::sort( clusters.begin(), clusters.end(),
-               []( const std::shared_ptr<CN_CLUSTER>& a, const std::shared_ptr<CN_CLUSTER>& b )
-               {
-                   return a->OriginNet() < b->OriginNet();
-               } );
-
-    return clusters;
+    return forest.GetClusters();
 }
 
 
@@ -558,6 +552,8 @@ void CN_CONNECTIVITY_ALGO::propagateConnections( BOARD_COMMIT* aCommit, PROPAGAT
     wxLogTrace( wxT( "CN" ), wxT( "propagateConnections: propagate skip conflicts? %d" ),
                 skipConflicts );
 
+    std::vector<BOARD_ITEM*> netChanged;
+
     for( const std::shared_ptr<CN_CLUSTER>& cluster : m_connClusters )
     {
         if( skipConflicts && cluster->IsConflicting() )
@@ -597,6 +593,7 @@ void CN_CONNECTIVITY_ALGO::propagateConnections( BOARD_COMMIT* aCommit, PROPAGAT
                             aCommit->Modify( item->Parent() );
 
                         item->Parent()->SetNetCode( cluster->OriginNet() );
+                        netChanged.push_back( item->Parent() );
                         n_changed++;
                     }
                 }
@@ -621,6 +618,13 @@ void CN_CONNECTIVITY_ALGO::propagateConnections( BOARD_COMMIT* aCommit, PROPAGAT
                         cluster.get() );
         }
     }
+
+    // With or without a commit, nothing else tells the board's listeners
+    if( !netChanged.empty() )
+    {
+        if( BOARD* board = netChanged.front()->GetBoard() )
+            board->OnItemsNetChanged( netChanged );
+    }
 }
 
 
@@ -743,6 +747,18 @@ void CN_CONNECTIVITY_ALGO::MarkNetAsDirty( int aNet )
 }
 
 
+void CN_CONNECTIVITY_ALGO::markZoneNetAsChanged( int aNet )
+{
+    if( aNet < 0 )
+        return;
+
+    if( (int) m_zoneNets.size() <= aNet )
+        m_zoneNets.resize( aNet + 1, false );
+
+    m_zoneNets[aNet] = true;
+}
+
+
 void CN_VISITOR::checkZoneItemConnection( CN_ZONE_LAYER* aZoneLayer, CN_ITEM* aItem )
 {
     if( aZoneLayer->Net() != aItem->Net() && !aItem->CanChangeNet() )
@@ -756,8 +772,7 @@ void CN_VISITOR::checkZoneItemConnection( CN_ZONE_LAYER* aZoneLayer, CN_ITEM* aI
     auto connect =
             [&]()
             {
-                aZoneLayer->Connect( aItem );
-                aItem->Connect( aZoneLayer );
+                m_connections.emplace_back( aZoneLayer, aItem );
             };
 
     // Try quick checks first...
@@ -813,8 +828,7 @@ void CN_VISITOR::checkZoneZoneConnection( CN_ZONE_LAYER* aZoneLayerA, CN_ZONE_LA
 
         if( aZoneLayerB->ContainsPoint( outline.CPoint( i ) ) )
         {
-            aZoneLayerA->Connect( aZoneLayerB );
-            aZoneLayerB->Connect( aZoneLayerA );
+            m_connections.emplace_back( aZoneLayerA, aZoneLayerB );
             return;
         }
     }
@@ -829,8 +843,7 @@ void CN_VISITOR::checkZoneZoneConnection( CN_ZONE_LAYER* aZoneLayerA, CN_ZONE_LA
 
         if( aZoneLayerA->ContainsPoint( outline2.CPoint( i ) ) )
         {
-            aZoneLayerA->Connect( aZoneLayerB );
-            aZoneLayerB->Connect( aZoneLayerA );
+            m_connections.emplace_back( aZoneLayerA, aZoneLayerB );
             return;
         }
     }
@@ -906,8 +919,7 @@ bool CN_VISITOR::operator()( CN_ITEM* aCandidate )
         if( parentA->GetEffectiveShape( layer, flashingA )->Collide(
                 parentB->GetEffectiveShape( layer, flashingB ).get() ) )
         {
-            m_item->Connect( aCandidate );
-            aCandidate->Connect( m_item );
+            m_connections.emplace_back( m_item, aCandidate );
             return true;
         }
     }
@@ -920,6 +932,8 @@ void CN_CONNECTIVITY_ALGO::Clear()
 {
     m_ratsnestClusters.clear();
     m_connClusters.clear();
+    m_propagateForest.Clear();
+    m_netForest.Clear();
     m_itemMap.clear();
     m_itemList.Clear();
 
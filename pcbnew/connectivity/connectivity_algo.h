@@ -47,6 +47,7 @@
 #include <connectivity/connectivity_rtree.h>
 #include <connectivity/connectivity_data.h>
 #include <connectivity/connectivity_items.h>
+#include <connectivity/connectivity_clusters.h>
 
 class CN_RATSNEST_NODES;
 class BOARD;
@@ -87,8 +88,8 @@ public:
         return m_weight < aOther.m_weight;
     }
 
-    std::shared_ptr<CN_ANCHOR> GetSourceNode() const { return m_source; }
-    std::shared_ptr<CN_ANCHOR> GetTargetNode() const { return m_target; }
+    const std::shared_ptr<CN_ANCHOR>& GetSourceNode() const { return m_source; }
+    const std::shared_ptr<CN_ANCHOR>& GetTargetNode() const { return m_target; }
 
     void SetSourceNode( const std::shared_ptr<CN_ANCHOR>& aNode ) { m_source = aNode; }
     void SetTargetNode( const std::shared_ptr<CN_ANCHOR>& aNode ) { m_target = aNode; }
@@ -154,7 +155,7 @@ public:
         std::list<CN_ITEM*> m_items;
     };
 
-    CN_CONNECTIVITY_ALGO() {}
+    CN_CONNECTIVITY_ALGO();
     ~CN_CONNECTIVITY_ALGO() { Clear(); }
 
     bool ItemExists( const BOARD_CONNECTED_ITEM* aItem ) const
@@ -175,10 +176,21 @@ public:
         return m_dirtyNets[ aNet ];
     }
 
+    /**
+     * @return true if a zone on \a aNet has been added, removed or refilled since the dirty
+     *         flags were last cleared.
+     */
+    bool HaveZonesChanged( int aNet ) const
+    {
+        return aNet >= 0 && aNet < (int) m_zoneNets.size() && m_zoneNets[ aNet ];
+    }
+
     void ClearDirtyFlags()
     {
         for( size_t ii = 0; ii < m_dirtyNets.size(); ii++ )
             m_dirtyNets[ii] = false;
+
+        m_zoneNets.clear();
     }
 
     void GetDirtyClusters( CLUSTERS& aClusters ) const
@@ -205,9 +217,19 @@ public:
     bool Remove( BOARD_ITEM* aItem );
     bool Add( BOARD_ITEM* aItem );
 
+    /**
+     * Find the clusters made up of items of the given types (and optionally of a single net).
+     *
+     * This builds the clusters from scratch; prefer SearchClusters( aMode ) where possible.
+     */
     const CLUSTERS SearchClusters( CLUSTER_SEARCH_MODE aMode,
                                    const std::initializer_list<KICAD_T>& aTypes,
                                    int aSingleNet, CN_ITEM* rootItem = nullptr );
+
+    /**
+     * Find the clusters of all connectable items.  These are maintained incrementally, so only
+     * clusters touched by items added or removed since the last call are rebuilt.
+     */
     const CLUSTERS SearchClusters( CLUSTER_SEARCH_MODE aMode );
 
     /**
@@ -274,13 +296,19 @@ private:
 
     void markItemNetAsDirty( const BOARD_ITEM* aItem );
 
+    void markZoneNetAsChanged( int aNet );
+
 private:
     CN_LIST                                               m_itemList;
     std::unordered_map<const BOARD_ITEM*, ITEM_MAP_ENTRY> m_itemMap;
 
+    CN_CLUSTER_FOREST                                     m_propagateForest;
+    CN_CLUSTER_FOREST                                     m_netForest;
+
     std::vector<std::shared_ptr<CN_CLUSTER>>              m_connClusters;
     std::vector<std::shared_ptr<CN_CLUSTER>>              m_ratsnestClusters;
     std::vector<bool>                                     m_dirtyNets;
+    std::vector<bool>                                     m_zoneNets;
 
     PROGRESS_REPORTER* m_progressReporter = nullptr;
 };
@@ -289,8 +317,15 @@ private:
 class CN_VISITOR
 {
 public:
-    CN_VISITOR( CN_ITEM* aItem ) :
-        m_item( aItem )
+    /**
+     * Pairs of items found to be connected.  These are recorded rather than applied to the
+     * items straight away so that searches can run on many threads without any locking.
+     */
+    using CONNECTIONS = std::vector<std::pair<CN_ITEM*, CN_ITEM*>>;
+
+    CN_VISITOR( CN_ITEM* aItem, CONNECTIONS& aConnections ) :
+        m_item( aItem ),
+        m_connections( aConnections )
     {}
 
     bool operator()( CN_ITEM* aCandidate );
@@ -301,7 +336,8 @@ protected:
     void checkZoneZoneConnection( CN_ZONE_LAYER* aZoneLayerA, CN_ZONE_LAYER* aZoneLayerB );
 
 protected:
-    CN_ITEM* m_item;        ///< The item we are looking for connections to.
+    CN_ITEM*     m_item;          ///< The item we are looking for connections to.
+    CONNECTIONS& m_connections;
 };
 
 #endif
@@ -0,0 +1,311 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#include <connectivity/connectivity_clusters.h>
+#include <connectivity/connectivity_items.h>
+
+
+CN_CLUSTER_FOREST::CN_CLUSTER_FOREST( bool aWithinNet,
+                                      std::function<bool( const CN_ITEM* )> aFilter ) :
+        m_withinNet( aWithinNet ),
+        m_filter( std::move( aFilter ) )
+{
+}
+
+
+void CN_CLUSTER_FOREST::Clear()
+{
+    m_items.clear();
+    m_parent.clear();
+    m_size.clear();
+    m_next.clear();
+    m_net.clear();
+    m_member.clear();
+    m_clusters.clear();
+
+    m_freeSlots.clear();
+    m_slotMap.clear();
+    m_roots.clear();
+    m_toSplit.clear();
+}
+
+
+void CN_CLUSTER_FOREST::Add( CN_ITEM* aItem )
+{
+    if( m_slotMap.count( aItem ) )
+        return;
+
+    connect( allocSlot( aItem ) );
+}
+
+
+void CN_CLUSTER_FOREST::Remove( CN_ITEM* aItem )
+{
+    auto it = m_slotMap.find( aItem );
+
+    if( it == m_slotMap.end() )
+        return;
+
+    // The slot stays linked into its set (so that the set can still be found) until the set
+    // is re-split.
+    m_items[ it->second ] = nullptr;
+    m_toSplit.push_back( it->second );
+    m_slotMap.erase( it );
+}
+
+
+CN_CLUSTER_FOREST::CLUSTERS CN_CLUSTER_FOREST::GetClusters()
+{
+    checkNets();
+    resplit();
+
+    CLUSTERS clusters;
+    clusters.reserve( m_roots.size() );
+
+    for( int root : m_roots )
+    {
+        // Items which don't pass the filter never join a set, so a root which isn't a member
+        // is on its own.
+        if( !m_member[root] )
+            continue;
+
+        std::shared_ptr<CN_CLUSTER>& cluster = m_clusters[root];
+
+        if( !cluster )
+        {
+            cluster = std::make_shared<CN_CLUSTER>();
+
+            int slot = root;
+
+            do
+            {
+                cluster->Add( m_items[slot] );
+                slot = m_next[slot];
+            } while( slot != root );
+        }
+
+        clusters.push_back( cluster );
+    }
+
+    std::sort( clusters.begin(), clusters.end(),
+               []( const std::shared_ptr<CN_CLUSTER>& a, const std::shared_ptr<CN_CLUSTER>& b )
+               {
+                   return a->OriginNet() < b->OriginNet();
+               } );
+
+    return clusters;
+}
+
+
+int CN_CLUSTER_FOREST::find( int aSlot )
+{
+    // Path halving
+    while( m_parent[aSlot] != aSlot )
+    {
+        m_parent[aSlot] = m_parent[ m_parent[aSlot] ];
+        aSlot = m_parent[aSlot];
+    }
+
+    return aSlot;
+}
+
+
+void CN_CLUSTER_FOREST::unite( int aSlotA, int aSlotB )
+{
+    int rootA = find( aSlotA );
+    int rootB = find( aSlotB );
+
+    if( rootA == rootB )
+        return;
+
+    if( m_size[rootA] < m_size[rootB] )
+        std::swap( rootA, rootB );
+
+    m_parent[rootB] = rootA;
+    m_size[rootA] += m_size[rootB];
+
+    // Splice the two circular member lists together
+    std::swap( m_next[rootA], m_next[rootB] );
+
+    m_roots.erase( rootB );
+    m_clusters[rootA].reset();
+    m_clusters[rootB].reset();
+}
+
+
+bool CN_CLUSTER_FOREST::canConnect( int aSlotA, int aSlotB ) const
+{
+    if( !m_member[aSlotA] || !m_member[aSlotB] )
+        return false;
+
+    return !m_withinNet || m_net[aSlotA] == m_net[aSlotB];
+}
+
+
+void CN_CLUSTER_FOREST::connect( int aSlot )
+{
+    if( !m_member[aSlot] )
+        return;
+
+    for( CN_ITEM* connected : m_items[aSlot]->ConnectedItems() )
+    {
+        auto it = m_slotMap.find( connected );
+
+        if( it != m_slotMap.end() && canConnect( aSlot, it->second ) )
+            unite( aSlot, it->second );
+    }
+}
+
+
+int CN_CLUSTER_FOREST::allocSlot( CN_ITEM* aItem )
+{
+    int slot;
+
+    if( !m_freeSlots.empty() )
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        slot = (int) m_items.size();
+
+        m_items.push_back( nullptr );
+        m_parent.push_back( slot );
+        m_size.push_back( 1 );
+        m_next.push_back( slot );
+        m_net.push_back( -1 );
+        m_member.push_back( 0 );
+        m_clusters.emplace_back();
+    }
+
+    m_items[slot] = aItem;
+    m_net[slot] = aItem->Net();
+    m_member[slot] = m_filter( aItem );
+    m_slotMap[aItem] = slot;
+
+    makeSingleton( slot );
+
+    return slot;
+}
+
+
+void CN_CLUSTER_FOREST::makeSingleton( int aSlot )
+{
+    m_parent[aSlot] = aSlot;
+    m_size[aSlot] = 1;
+    m_next[aSlot] = aSlot;
+    m_clusters[aSlot].reset();
+    m_roots.insert( aSlot );
+}
+
+
+void CN_CLUSTER_FOREST::checkNets()
+{
+    // Nets can be changed without the items being removed and re-added (net propagation does
+    // exactly that), so compare against what the sets were built with.
+    for( size_t slot = 0; slot < m_items.size(); ++slot )
+    {
+        CN_ITEM* item = m_items[slot];
+
+        if( !item || item->Net() == m_net[slot] )
+            continue;
+
+        bool member = m_filter( item );
+
+        m_net[slot] = item->Net();
+
+        if( m_withinNet || member != (bool) m_member[slot] )
+        {
+            m_member[slot] = member;
+            m_toSplit.push_back( slot );
+        }
+        else
+        {
+            // Same membership; only the cluster's origin net may have changed
+            m_clusters[ find( slot ) ].reset();
+        }
+    }
+}
+
+
+void CN_CLUSTER_FOREST::resplit()
+{
+    if( m_toSplit.empty() )
+        return;
+
+    std::vector<int> roots;
+    roots.reserve( m_toSplit.size() );
+
+    for( int slot : m_toSplit )
+        roots.push_back( find( slot ) );
+
+    m_toSplit.clear();
+
+    std::sort( roots.begin(), roots.end() );
+    roots.erase( std::unique( roots.begin(), roots.end() ), roots.end() );
+
+    std::vector<int> members;
+    std::vector<int> live;
+
+    for( int root : roots )
+    {
+        members.clear();
+        live.clear();
+
+        // An earlier re-split in this loop may have merged this set into another one, in
+        // which case we're walking (and re-splitting) the merged set.  That's still correct.
+        int slot = root;
+
+        do
+        {
+            members.push_back( slot );
+            slot = m_next[slot];
+        } while( slot != root );
+
+        for( int member : members )
+        {
+            m_roots.erase( member );
+
+            if( m_items[member] )
+            {
+                makeSingleton( member );
+                live.push_back( member );
+            }
+            else
+            {
+                m_parent[member] = member;
+                m_size[member] = 1;
+                m_next[member] = member;
+                m_member[member] = 0;
+                m_clusters[member].reset();
+                m_freeSlots.push_back( member );
+            }
+        }
+
+        for( int member : live )
+            connect( member );
+    }
+}
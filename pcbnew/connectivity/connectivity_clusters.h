@@ -0,0 +1,106 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef PCBNEW_CONNECTIVITY_CLUSTERS_H
+#define PCBNEW_CONNECTIVITY_CLUSTERS_H
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class CN_ITEM;
+class CN_CLUSTER;
+
+
+/**
+ * The connected clusters of a set of CN_ITEMs, kept up to date as items come and go.
+ *
+ * Clusters are held in a disjoint-set forest (union by size, with path halving) over a
+ * contiguous array of item slots.  Adding an item merges it with the clusters of the items it
+ * is connected to; removing one only re-splits the cluster it belonged to.  A CN_CLUSTER is
+ * only rebuilt when its membership (or the net of one of its members) has changed.
+ *
+ * Items must be added after their connections have been searched, and removed before they are
+ * deleted.
+ */
+class CN_CLUSTER_FOREST
+{
+public:
+    using CLUSTERS = std::vector<std::shared_ptr<CN_CLUSTER>>;
+
+    /**
+     * @param aWithinNet restricts clusters to items of a single (valid) net.
+     * @param aFilter decides which items take part in clusters.  It is re-evaluated when the
+     *                net of an item changes.
+     */
+    CN_CLUSTER_FOREST( bool aWithinNet, std::function<bool( const CN_ITEM* )> aFilter );
+
+    void Clear();
+
+    void Add( CN_ITEM* aItem );
+    void Remove( CN_ITEM* aItem );
+
+    /**
+     * @return the clusters with at least one member, sorted by origin net.
+     */
+    CLUSTERS GetClusters();
+
+    size_t Size() const { return m_slotMap.size(); }
+
+private:
+    int find( int aSlot );
+    void unite( int aSlotA, int aSlotB );
+
+    bool canConnect( int aSlotA, int aSlotB ) const;
+    void connect( int aSlot );
+
+    int  allocSlot( CN_ITEM* aItem );
+    void makeSingleton( int aSlot );
+
+    void checkNets();
+    void resplit();
+
+private:
+    bool                                    m_withinNet;
+    std::function<bool( const CN_ITEM* )>   m_filter;
+
+    // Per-slot data.  A slot whose item has been removed keeps its place in its set until that
+    // set is re-split.
+    std::vector<CN_ITEM*>                   m_items;
+    std::vector<int>                        m_parent;
+    std::vector<int>                        m_size;
+    std::vector<int>                        m_next;     ///< circular list of the set's members
+    std::vector<int>                        m_net;      ///< net of the item when last seen
+    std::vector<char>                       m_member;   ///< item passed the filter
+    std::vector<std::shared_ptr<CN_CLUSTER>> m_clusters; ///< cached cluster, for roots only
+
+    std::vector<int>                        m_freeSlots;
+    std::unordered_map<const CN_ITEM*, int> m_slotMap;
+    std::unordered_set<int>                 m_roots;
+    std::vector<int>                        m_toSplit;
+};
+
+
+#endif /* PCBNEW_CONNECTIVITY_CLUSTERS_H */
@@ -28,6 +28,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <future>
 #include <initializer_list>
 
@@ -109,6 +110,10 @@ void CONNECTIVITY_DATA::Build( BOARD* aBoard, PROGRESS_REPORTER* aReporter )
     m_connAlgo.reset( new CN_CONNECTIVITY_ALGO );
     m_connAlgo->Build( aBoard, aReporter );
 
+    // Every item has been replaced
+    for( RN_NET* net : m_nets )
+        net->ClearMST();
+
     m_netclassMap.clear();
 
     for( NETINFO_ITEM* net : aBoard->GetNetInfo() )
@@ -145,6 +150,9 @@ void CONNECTIVITY_DATA::Build( const std::vector<BOARD_ITEM*>& aItems )
     m_connAlgo.reset( new CN_CONNECTIVITY_ALGO );
     m_connAlgo->LocalBuild( aItems );
 
+    for( RN_NET* net : m_nets )
+        net->ClearMST();
+
     RecalculateRatsnest();
 }
 
@@ -174,12 +182,32 @@ void CONNECTIVITY_DATA::updateRatsnest()
                 return aNet->IsDirty() && aNet->GetNodeCount() > 0;
             } );
 
-    GetKiCadThreadPool().parallelize_loop( 0, dirty_nets.size(),
-            [&]( const int a, const int b)
+    // Nets are independent of each other.  Hand them out largest first so that the big power
+    // nets don't end up being the last ones started.
+    std::sort( dirty_nets.begin(), dirty_nets.end(),
+               []( const RN_NET* a, const RN_NET* b )
+               {
+                   return a->GetNodeCount() > b->GetNodeCount();
+               } );
+
+    thread_pool&        tp = GetKiCadThreadPool();
+    size_t              num_tasks = std::min<size_t>( dirty_nets.size(), tp.get_thread_count() );
+    std::atomic<size_t> next( 0 );
+
+    std::vector<std::future<void>> returns( num_tasks );
+
+    auto update_lambda =
+            [&]()
             {
-                for( int ii = a; ii < b; ++ii )
+                for( size_t ii = next++; ii < dirty_nets.size(); ii = next++ )
                     dirty_nets[ii]->Update();
-            }).wait();
+            };
+
+    for( size_t ii = 0; ii < num_tasks; ++ii )
+        returns[ii] = tp.submit( update_lambda );
+
+    for( const std::future<void>& ret : returns )
+        ret.wait();
 
 #ifdef PROFILE
     rnUpdate.Show();
@@ -224,6 +252,10 @@ void CONNECTIVITY_DATA::RecalculateRatsnest( BOARD_COMMIT* aCommit  )
         if( m_connAlgo->IsNetDirty( net ) )
         {
             m_nets[net]->Clear();
+
+            if( m_connAlgo->HaveZonesChanged( net ) )
+                m_nets[net]->ClearMST();
+
             dirtyNets++;
         }
     }
@@ -127,7 +127,7 @@ CN_ITEM* CN_LIST::Add( PAD* pad )
          return nullptr;
 
      auto item = new CN_ITEM( pad, false, 1 );
-     item->AddAnchor( pad->ShapePos() );
+     item->AddAnchor( m_anchorArena.New( pad->ShapePos(), item ) );
      item->SetLayers( LAYER_RANGE( F_Cu, B_Cu ) );
 
      switch( pad->GetAttribute() )
@@ -163,8 +163,8 @@ CN_ITEM* CN_LIST::Add( PCB_TRACK* track )
 {
     CN_ITEM* item = new CN_ITEM( track, true );
     m_items.push_back( item );
-    item->AddAnchor( track->GetStart() );
-    item->AddAnchor( track->GetEnd() );
+    item->AddAnchor( m_anchorArena.New( track->GetStart(), item ) );
+    item->AddAnchor( m_anchorArena.New( track->GetEnd(), item ) );
     item->SetLayer( track->GetLayer() );
     addItemtoTree( item );
     SetDirty();
@@ -176,8 +176,8 @@ CN_ITEM* CN_LIST::Add( PCB_ARC* aArc )
 {
     CN_ITEM* item = new CN_ITEM( aArc, true );
     m_items.push_back( item );
-    item->AddAnchor( aArc->GetStart() );
-    item->AddAnchor( aArc->GetEnd() );
+    item->AddAnchor( m_anchorArena.New( aArc->GetStart(), item ) );
+    item->AddAnchor( m_anchorArena.New( aArc->GetEnd(), item ) );
     item->SetLayer( aArc->GetLayer() );
     addItemtoTree( item );
     SetDirty();
@@ -190,7 +190,7 @@ CN_ITEM* CN_LIST::Add( PCB_VIA* via )
     CN_ITEM* item = new CN_ITEM( via, !via->GetIsFree(), 1 );
 
     m_items.push_back( item );
-    item->AddAnchor( via->GetStart() );
+    item->AddAnchor( m_anchorArena.New( via->GetStart(), item ) );
 
     item->SetLayers( LAYER_RANGE( via->TopLayer(), via->BottomLayer() ) );
     addItemtoTree( item );
@@ -211,8 +211,8 @@ const std::vector<CN_ITEM*> CN_LIST::Add( ZONE* zone, PCB_LAYER_ID aLayer )
 
         zitem->BuildRTree();
 
-        for( VECTOR2I pt : zone->GetFilledPolysList( aLayer )->COutline( j ).CPoints() )
-            zitem->AddAnchor( pt );
+        for( const VECTOR2I& pt : polys->COutline( j ).CPoints() )
+            zitem->AddAnchor( m_anchorArena.New( pt, zitem ) );
 
         rv.push_back( Add( zitem ) );
     }
@@ -230,6 +230,23 @@ CN_ITEM* CN_LIST::Add( CN_ZONE_LAYER* zitem )
 }
 
 
+std::shared_ptr<CN_ANCHOR> CN_ANCHOR_ARENA::New( const VECTOR2I& aPos, CN_ITEM* aItem )
+{
+    // Anchors are never moved once made, as the block is never grown past its reservation
+    if( !m_block || m_block->size() == BLOCK_SIZE )
+    {
+        m_block = std::make_shared<std::vector<CN_ANCHOR>>();
+        m_block->reserve( BLOCK_SIZE );
+        m_blockCount++;
+    }
+
+    m_block->emplace_back( aPos, aItem );
+
+    // Aliasing constructor: shares ownership of the block
+    return std::shared_ptr<CN_ANCHOR>( m_block, &m_block->back() );
+}
+
+
 void CN_LIST::RemoveInvalidItems( std::vector<CN_ITEM*>& aGarbage )
 {
     if( !m_hasInvalid )
@@ -169,10 +169,9 @@ public:
     {
         m_parent = aParent;
         m_canChangeNet = aCanChangeNet;
-        m_visited = false;
         m_valid = true;
         m_dirty = true;
-        m_anchors.reserve( std::max( 6, aAnchorCount ) );
+        m_anchors.reserve( aAnchorCount );
         m_layers = LAYER_RANGE( 0, PCB_LAYER_ID_COUNT );
         m_connected.reserve( 8 );
     }
@@ -184,6 +183,11 @@ public:
         m_anchors.emplace_back( std::make_shared<CN_ANCHOR>( aPos, this ) );
     }
 
+    void AddAnchor( std::shared_ptr<CN_ANCHOR>&& aAnchor )
+    {
+        m_anchors.emplace_back( std::move( aAnchor ) );
+    }
+
     std::vector<std::shared_ptr<CN_ANCHOR>>& Anchors() { return m_anchors; }
 
     void SetValid( bool aValid ) { m_valid = aValid; }
@@ -228,15 +232,10 @@ public:
     const std::vector<CN_ITEM*>& ConnectedItems() const { return m_connected; }
     void ClearConnections() { m_connected.clear(); }
 
-    void SetVisited( bool aVisited ) { m_visited = aVisited; }
-    bool Visited() const { return m_visited; }
-
     bool CanChangeNet() const { return m_canChangeNet; }
 
     void Connect( CN_ITEM* b )
     {
-        std::lock_guard<std::mutex> lock( m_listLock );
-
         auto i = std::lower_bound( m_connected.begin(), m_connected.end(), b );
 
         if( i != m_connected.end() && *i == b )
@@ -251,13 +250,13 @@ public:
     virtual const VECTOR2I GetAnchor( int n ) const;
 
     int GetAnchorItemCount() const { return m_anchors.size(); }
-    std::shared_ptr<CN_ANCHOR> GetAnchorItem( int n ) const { return m_anchors[n]; }
+    const std::shared_ptr<CN_ANCHOR>& GetAnchorItem( int n ) const { return m_anchors[n]; }
 
     int Net() const
     {
         return ( !m_parent || !m_valid ) ? -1 : m_parent->GetNetCode();
     }
-                                     ///< allow parallel connection threads
+
 protected:
     bool            m_dirty;         ///< used to identify recently added item not yet
                                      ///< scanned into the connectivity search
@@ -272,10 +271,7 @@ private:
 
     bool            m_canChangeNet;  ///< can the net propagator modify the netcode?
 
-    bool            m_visited;       ///< visited flag for the BFS scan
     bool            m_valid;         ///< used to identify garbage items (we use lazy removal)
-
-    std::mutex      m_listLock;      ///< mutex protecting this item's connected_items set to
 };
 
 
@@ -392,6 +388,34 @@ private:
 };
 
 
+/**
+ * Hands out anchors from blocks of BLOCK_SIZE, rather than allocating each one on its own.
+ *
+ * Each anchor shares ownership of its block, so a block lives for as long as anything (such as
+ * a ratsnest edge) still refers to one of its anchors, whatever happens to the arena.
+ */
+class CN_ANCHOR_ARENA
+{
+public:
+    std::shared_ptr<CN_ANCHOR> New( const VECTOR2I& aPos, CN_ITEM* aItem );
+
+    void Clear()
+    {
+        m_block.reset();
+        m_blockCount = 0;
+    }
+
+    /**
+     * @return the number of blocks allocated since the last Clear().
+     */
+    size_t BlockCount() const { return m_blockCount; }
+
+private:
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    std::shared_ptr<std::vector<CN_ANCHOR>> m_block;
+    size_t                                  m_blockCount = 0;
+};
 
 
 class CN_LIST
@@ -418,6 +442,7 @@ public:
 
         m_items.clear();
         m_index.RemoveAll();
+        m_anchorArena.Clear();
     }
 
     using ITER       = decltype( m_items )::iterator;
@@ -457,6 +482,8 @@ public:
         return m_items.size();
     }
 
+    size_t AnchorBlockCount() const { return m_anchorArena.BlockCount(); }
+
     CN_ITEM* Add( PAD* pad );
 
     CN_ITEM* Add( PCB_TRACK* track );
@@ -473,6 +500,7 @@ private:
     bool               m_dirty;
     bool               m_hasInvalid;
     CN_RTREE<CN_ITEM*> m_index;
+    CN_ANCHOR_ARENA    m_anchorArena;
 };
 
 
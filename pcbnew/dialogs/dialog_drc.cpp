@@ -1079,6 +1079,14 @@ bool DIALOG_DRC::writeReport( const wxString& aFullFileName )
         fprintf( fp, "%s", TO_UTF8( item->ShowReport( &unitsProvider, severity, itemMap ) ) );
     }
 
+    DRC_TOOL*   drcTool = m_frame->GetToolManager()->GetTool<DRC_TOOL>();
+    DRC_ENGINE* drcEngine = drcTool->GetDRCEngine().get();
+
+    if( drcEngine && !drcEngine->GetProviderStats().empty() )
+    {
+        fprintf( fp, "\n** DRC provider statistics **\n" );
+        fprintf( fp, "%s", TO_UTF8( drcEngine->FormatProviderStats() ) );
+    }
 
     fprintf( fp, "\n** End of Report **\n" );
 
@@ -141,7 +141,10 @@ bool DRC_CACHE_GENERATOR::Run()
     };
 
     forEachGeometryItem( itemTypes, LSET::AllCuMask(), countItems );
+
+    m_board->m_CopperItemRTreeCache->BeginBulkLoad();
     forEachGeometryItem( itemTypes, LSET::AllCuMask(), addToCopperTree );
+    m_board->m_CopperItemRTreeCache->EndBulkLoad();
 
     if( !reportPhase( _( "Tessellating copper zones..." ) ) )
         return false;   // DRC cancelled
@@ -171,16 +174,21 @@ bool DRC_CACHE_GENERATOR::Run()
                 {
                    std::unique_ptr<DRC_RTREE> rtree = std::make_unique<DRC_RTREE>();
 
+                   rtree->BeginBulkLoad();
+
                    for( PCB_LAYER_ID layer : aZone->GetLayerSet().Seq() )
                    {
                        if( IsCopperLayer( layer ) )
                            rtree->Insert( aZone, layer );
                    }
 
+                   rtree->EndBulkLoad();
+
                    std::unique_lock<std::mutex> cacheLock( m_board->m_CachesMutex );
                    m_board->m_CopperZoneRTreeCache[ aZone ] = std::move( rtree );
 
                    done.fetch_add( 1 );
+                   accountItemsTested();
                 }
 
                 return 1;
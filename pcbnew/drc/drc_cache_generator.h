@@ -43,6 +43,11 @@ public:
     }
 
     virtual bool Run() override;
+
+    virtual const wxString GetName() const override
+    {
+        return wxT( "cache generator" );
+    };
 };
 
 
@@ -37,9 +37,12 @@
 #include <drc/drc_item.h>
 #include <drc/drc_cache_generator.h>
 #include <footprint.h>
+#include <hash.h>
 #include <pad.h>
 #include <pcb_track.h>
+#include <profile.h>
 #include <thread_pool.h>
+#include <core/wx_stl_compat.h>
 #include <zone.h>
 
 
@@ -72,8 +75,12 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
     m_rulesValid( false ),
     m_reportAllTrackErrors( false ),
     m_testFootprints( false ),
+    m_ruleEvaluations( 0 ),
+    m_rtreeQueries( 0 ),
+    m_violationCount( 0 ),
     m_reporter( nullptr ),
-    m_progressReporter( nullptr )
+    m_progressReporter( nullptr ),
+    m_constraintCacheGeneration( 0 )
 {
     m_errorLimits.resize( DRCE_LAST + 1 );
 
@@ -85,14 +92,6 @@ DRC_ENGINE::DRC_ENGINE( BOARD* aBoard, BOARD_DESIGN_SETTINGS *aSettings ) :
 DRC_ENGINE::~DRC_ENGINE()
 {
     m_rules.clear();
-
-    for( std::pair<DRC_CONSTRAINT_T, std::vector<DRC_ENGINE_CONSTRAINT*>*> pair : m_constraintMap )
-    {
-        for( DRC_ENGINE_CONSTRAINT* constraint : *pair.second )
-            delete constraint;
-
-        delete pair.second;
-    }
 }
 
 
@@ -494,21 +493,199 @@ void DRC_ENGINE::compileRules()
 
         for( const DRC_CONSTRAINT& constraint : rule->m_Constraints )
         {
-            if( !m_constraintMap.count( constraint.m_Type ) )
-                m_constraintMap[ constraint.m_Type ] = new std::vector<DRC_ENGINE_CONSTRAINT*>();
+            DRC_ENGINE_CONSTRAINT engineConstraint;
+
+            engineConstraint.layerTest = rule->m_LayerCondition;
+            engineConstraint.condition = condition;
+            engineConstraint.constraint = constraint;
+            engineConstraint.parentRule = rule;
+            m_constraintSets[ constraint.m_Type ].m_constraints.push_back( engineConstraint );
+        }
+    }
+
+    analyzeConstraintSets();
+}
 
-            DRC_ENGINE_CONSTRAINT* engineConstraint = new DRC_ENGINE_CONSTRAINT;
 
-            engineConstraint->layerTest = rule->m_LayerCondition;
-            engineConstraint->condition = condition;
-            engineConstraint->constraint = constraint;
-            engineConstraint->parentRule = rule;
-            m_constraintMap[ constraint.m_Type ]->push_back( engineConstraint );
+bool DRC_ENGINE::IsCacheableCondition( const wxString& aExpression )
+{
+    // Anything we don't recognize (functions, other properties, the layer, etc.) makes the
+    // condition dependent on the items themselves.
+    size_t len = aExpression.length();
+    size_t ii = 0;
+
+    auto isIdentChar =
+            [&]( size_t aPos )
+            {
+                return aPos < len && ( wxIsalnum( aExpression[aPos] ) || aExpression[aPos] == '_' );
+            };
+
+    auto skipSpaces =
+            [&]()
+            {
+                while( ii < len && wxIsspace( aExpression[ii] ) )
+                    ii++;
+            };
+
+    auto readIdent =
+            [&]() -> wxString
+            {
+                size_t start = ii;
+
+                while( isIdentChar( ii ) )
+                    ii++;
+
+                return aExpression.Mid( start, ii - start );
+            };
+
+    while( ii < len )
+    {
+        wxUniChar c = aExpression[ii];
+
+        if( c == '\'' || c == '"' )
+        {
+            // String literal
+            for( ii++; ii < len && aExpression[ii] != c; ii++ )
+            {
+                if( aExpression[ii] == '\\' )
+                    ii++;
+            }
+
+            ii++;
+        }
+        else if( wxIsdigit( c ) )
+        {
+            // Numeric literal, including any decimal point and units suffix
+            while( isIdentChar( ii ) || ( ii < len && aExpression[ii] == '.' ) )
+                ii++;
         }
+        else if( isIdentChar( ii ) )
+        {
+            wxString var = readIdent();
+
+            skipSpaces();
+
+            if( ii >= len || aExpression[ii] != '.' )
+                return false;
+
+            ii++;
+            skipSpaces();
+
+            wxString field = readIdent();
+
+            skipSpaces();
+
+            if( ii < len && aExpression[ii] == '(' )
+                return false;
+
+            if( var != wxT( "A" ) && var != wxT( "B" ) )
+                return false;
+
+            if( field.CmpNoCase( wxT( "NetClass" ) ) != 0
+                    && field.CmpNoCase( wxT( "Type" ) ) != 0
+                    && field.CmpNoCase( wxT( "Via_Type" ) ) != 0 )
+            {
+                return false;
+            }
+        }
+        else
+        {
+            ii++;
+        }
+    }
+
+    return true;
+}
+
+
+void DRC_ENGINE::analyzeConstraintSets()
+{
+    ClearConstraintCache();
+
+    for( int type = 0; type < DRC_CONSTRAINT_T_COUNT; ++type )
+    {
+        CONSTRAINT_SET& constraintSet = m_constraintSets[ type ];
+        int             worst = 0;
+
+        constraintSet.m_hasConditional = false;
+        constraintSet.m_worst = -1;
+
+        // Disallow, hole-to-hole and assertion constraints look at more than the item signature
+        // when resolving (disallow flags vs. item type, whether holes are drilled, etc.)
+        constraintSet.m_cacheable = type != DISALLOW_CONSTRAINT
+                                    && type != HOLE_TO_HOLE_CONSTRAINT
+                                    && type != ASSERTION_CONSTRAINT;
+
+        for( int ii = 0; ii < (int) constraintSet.m_constraints.size(); ++ii )
+        {
+            const DRC_ENGINE_CONSTRAINT& c = constraintSet.m_constraints[ii];
+
+            if( c.condition && !c.condition->GetExpression().IsEmpty() )
+            {
+                constraintSet.m_hasConditional = true;
+
+                if( !IsCacheableCondition( c.condition->GetExpression() ) )
+                    constraintSet.m_cacheable = false;
+            }
+
+            if( c.constraint.GetValue().Min() > worst )
+            {
+                worst = c.constraint.GetValue().Min();
+                constraintSet.m_worst = ii;
+            }
+        }
+
+        // Without conditions resolution is cheaper than a cache lookup
+        if( !constraintSet.m_hasConditional )
+            constraintSet.m_cacheable = false;
     }
 }
 
 
+// Shared by all engines, so that a generation is never mistaken for another engine's
+static std::atomic<unsigned> s_lastConstraintCacheGeneration( 0 );
+
+
+void DRC_ENGINE::ClearConstraintCache()
+{
+    // Move the generation on first so that anything resolved against the old rules and stored
+    // after the clear is never found
+    m_constraintCacheGeneration = ++s_lastConstraintCacheGeneration;
+    m_constraintCache.Clear();
+}
+
+
+bool DRC_ENGINE::CONSTRAINT_CACHE_KEY::operator==( const CONSTRAINT_CACHE_KEY& aOther ) const
+{
+    return m_constraintType == aOther.m_constraintType
+            && m_layer == aOther.m_layer
+            && m_netclassA == aOther.m_netclassA
+            && m_netclassB == aOther.m_netclassB
+            && m_typeA == aOther.m_typeA
+            && m_typeB == aOther.m_typeB
+            && m_viaTypeA == aOther.m_viaTypeA
+            && m_viaTypeB == aOther.m_viaTypeB
+            && m_nonCopperA == aOther.m_nonCopperA
+            && m_nonCopperB == aOther.m_nonCopperB
+            && m_enabledLayers == aOther.m_enabledLayers;
+}
+
+
+std::size_t DRC_ENGINE::CONSTRAINT_CACHE_KEY_HASH::operator()(
+        const CONSTRAINT_CACHE_KEY& aKey ) const
+{
+    std::size_t seed = 0;
+
+    hash_combine( seed, static_cast<int>( aKey.m_constraintType ),
+                  static_cast<int>( aKey.m_layer ), aKey.m_netclassA, aKey.m_netclassB,
+                  static_cast<int>( aKey.m_typeA ), static_cast<int>( aKey.m_typeB ),
+                  aKey.m_viaTypeA, aKey.m_viaTypeB, aKey.m_nonCopperA, aKey.m_nonCopperB,
+                  static_cast<const BASE_SET&>( aKey.m_enabledLayers ) );
+
+    return seed;
+}
+
+
 void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
 {
     m_testProviders = DRC_TEST_PROVIDER_REGISTRY::Instance().GetTestProviders();
@@ -522,15 +699,8 @@ void DRC_ENGINE::InitEngine( const wxFileName& aRulePath )
     m_rules.clear();
     m_rulesValid = false;
 
-    for( std::pair<DRC_CONSTRAINT_T, std::vector<DRC_ENGINE_CONSTRAINT*>*> pair : m_constraintMap )
-    {
-        for( DRC_ENGINE_CONSTRAINT* constraint : *pair.second )
-            delete constraint;
-
-        delete pair.second;
-    }
-
-    m_constraintMap.clear();
+    for( CONSTRAINT_SET& constraintSet : m_constraintSets )
+        constraintSet = CONSTRAINT_SET();
 
     m_board->IncrementTimeStamp();  // Clear board-level caches
 
@@ -581,12 +751,40 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
 
     DRC_TEST_PROVIDER::Init();
 
+    m_providerStats.clear();
+
+    auto runProvider =
+            [&]( DRC_TEST_PROVIDER* aProvider, const std::function<bool()>& aRun ) -> bool
+            {
+                DRC_RTREE::QUERY_COUNTER_SCOPE countQueries( &m_rtreeQueries );
+                DRC_PROVIDER_STATS             stats;
+                size_t                         queries = m_rtreeQueries.load();
+                size_t                         evaluations = m_ruleEvaluations.load();
+                size_t                         violations = m_violationCount.load();
+                PROF_TIMER                     timer;
+
+                bool ok = aRun();
+
+                timer.Stop();
+
+                stats.m_Name = aProvider->GetName();
+                stats.m_WallTime = timer.msecs();
+                stats.m_ItemsTested = aProvider->GetItemsTested();
+                stats.m_RTreeQueries = m_rtreeQueries.load() - queries;
+                stats.m_RuleEvaluations = m_ruleEvaluations.load() - evaluations;
+                stats.m_Violations = m_violationCount.load() - violations;
+                m_providerStats.push_back( stats );
+
+                return ok;
+            };
+
     m_board->IncrementTimeStamp();      // Invalidate all caches...
 
     DRC_CACHE_GENERATOR cacheGenerator;
     cacheGenerator.SetDRCEngine( this );
 
-    if( !cacheGenerator.Run() )         // ... and regenerate them.
+    // ... and regenerate them.
+    if( !runProvider( &cacheGenerator, [&]() { return cacheGenerator.Run(); } ) )
         return;
 
     int timestamp = m_board->GetTimeStamp();
@@ -595,7 +793,7 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
     {
         ReportAux( wxString::Format( wxT( "Run DRC provider: '%s'" ), provider->GetName() ) );
 
-        if( !provider->RunTests( aUnits ) )
+        if( !runProvider( provider, [&]() { return provider->RunTests( aUnits ); } ) )
             break;
     }
 
@@ -605,6 +803,31 @@ void DRC_ENGINE::RunTests( EDA_UNITS aUnits, bool aReportAllTrackErrors, bool aT
 }
 
 
+wxString DRC_ENGINE::FormatProviderStats() const
+{
+    wxString out = wxString::Format( wxT( "%-32s %12s %10s %14s %12s %10s\n" ),
+                                     wxT( "Provider" ),
+                                     wxT( "Time (ms)" ),
+                                     wxT( "Items" ),
+                                     wxT( "R-tree queries" ),
+                                     wxT( "Rule evals" ),
+                                     wxT( "Violations" ) );
+
+    for( const DRC_PROVIDER_STATS& stats : m_providerStats )
+    {
+        out += wxString::Format( wxT( "%-32s %12.1f %10llu %14llu %12llu %10llu\n" ),
+                                 stats.m_Name,
+                                 stats.m_WallTime,
+                                 (unsigned long long) stats.m_ItemsTested,
+                                 (unsigned long long) stats.m_RTreeQueries,
+                                 (unsigned long long) stats.m_RuleEvaluations,
+                                 (unsigned long long) stats.m_Violations );
+    }
+
+    return out;
+}
+
+
 #define REPORT( s ) { if( aReporter ) { aReporter->Report( s ); } }
 
 DRC_CONSTRAINT DRC_ENGINE::EvalZoneConnection( const BOARD_ITEM* a, const BOARD_ITEM* b,
@@ -1266,12 +1489,67 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
                 }
             };
 
-    if( m_constraintMap.count( aConstraintType ) )
+    const CONSTRAINT_SET& constraintSet = m_constraintSets[ aConstraintType ];
+
+    if( !constraintSet.m_constraints.empty() )
     {
-        std::vector<DRC_ENGINE_CONSTRAINT*>* ruleset = m_constraintMap[ aConstraintType ];
+        // Resolution is reported step-by-step, so only use the cache when nobody's listening.
+        bool                 useCache = !aReporter && constraintSet.m_cacheable;
+        bool                 cached = false;
+        CONSTRAINT_CACHE_KEY key;
+        unsigned             generation = m_constraintCacheGeneration;
+
+        if( useCache )
+        {
+            auto viaType =
+                    []( const BOARD_ITEM* aItem ) -> int
+                    {
+                        if( aItem && aItem->Type() == PCB_VIA_T )
+                            return static_cast<int>( static_cast<const PCB_VIA*>( aItem )->GetViaType() );
+
+                        return -1;
+                    };
+
+            key.m_constraintType = aConstraintType;
+            key.m_layer = aLayer;
 
-        for( int ii = 0; ii < (int) ruleset->size(); ++ii )
-            processConstraint( ruleset->at( ii ) );
+            // Net classes are keyed by name, as a reassigned one can be freed and another
+            // allocated at the same address
+            if( ac )
+                key.m_netclassA = ac->GetEffectiveNetClass()->GetName();
+
+            if( bc )
+                key.m_netclassB = bc->GetEffectiveNetClass()->GetName();
+
+            key.m_typeA = a ? a->Type() : TYPE_NOT_INIT;
+            key.m_typeB = b ? b->Type() : TYPE_NOT_INIT;
+            key.m_viaTypeA = viaType( a );
+            key.m_viaTypeB = viaType( b );
+            key.m_nonCopperA = a_is_non_copper;
+            key.m_nonCopperB = b_is_non_copper;
+
+            // Rules only apply on enabled layers
+            key.m_enabledLayers = m_board->GetEnabledLayers();
+
+            CACHED_CONSTRAINT entry;
+
+            if( m_constraintCache.Find( key, entry ) && entry.m_generation == generation )
+            {
+                constraint = entry.m_constraint;
+                cached = true;
+            }
+        }
+
+        if( !cached )
+        {
+            m_ruleEvaluations.fetch_add( 1, std::memory_order_relaxed );
+
+            for( const DRC_ENGINE_CONSTRAINT& c : constraintSet.m_constraints )
+                processConstraint( &c );
+
+            if( useCache )
+                m_constraintCache.Set( key, { constraint, generation } );
+        }
     }
 
     if( constraint.GetParentRule() && !constraint.GetParentRule()->m_Implicit )
@@ -1290,16 +1568,11 @@ DRC_CONSTRAINT DRC_ENGINE::EvalRules( DRC_CONSTRAINT_T aConstraintType, const BO
         else
             b = parentFootprint;
 
-        if( m_constraintMap.count( aConstraintType ) )
-        {
-            std::vector<DRC_ENGINE_CONSTRAINT*>* ruleset = m_constraintMap[ aConstraintType ];
-
-            for( int ii = 0; ii < (int) ruleset->size(); ++ii )
-                processConstraint( ruleset->at( ii ) );
+        for( const DRC_ENGINE_CONSTRAINT& c : constraintSet.m_constraints )
+            processConstraint( &c );
 
-            if( constraint.GetParentRule() && !constraint.GetParentRule()->m_Implicit )
-                return constraint;
-        }
+        if( constraint.GetParentRule() && !constraint.GetParentRule()->m_Implicit )
+            return constraint;
     }
 
     // Unfortunately implicit rules don't work for local clearances (such as zones) because
@@ -1516,13 +1789,8 @@ void DRC_ENGINE::ProcessAssertions( const BOARD_ITEM* a,
                 }
             };
 
-    if( m_constraintMap.count( ASSERTION_CONSTRAINT ) )
-    {
-        std::vector<DRC_ENGINE_CONSTRAINT*>* ruleset = m_constraintMap[ ASSERTION_CONSTRAINT ];
-
-        for( int ii = 0; ii < (int) ruleset->size(); ++ii )
-            processConstraint( ruleset->at( ii ) );
-    }
+    for( const DRC_ENGINE_CONSTRAINT& c : m_constraintSets[ ASSERTION_CONSTRAINT ].m_constraints )
+        processConstraint( &c );
 }
 
 
@@ -1542,6 +1810,7 @@ void DRC_ENGINE::ReportViolation( const std::shared_ptr<DRC_ITEM>& aItem, const
     static std::mutex globalLock;
 
     m_errorLimits[ aItem->GetErrorCode() ] -= 1;
+    m_violationCount.fetch_add( 1, std::memory_order_relaxed );
 
     if( m_violationHandler )
     {
@@ -1632,33 +1901,19 @@ bool DRC_ENGINE::IsCancelled() const
 
 bool DRC_ENGINE::HasRulesForConstraintType( DRC_CONSTRAINT_T constraintID )
 {
-    //drc_dbg(10,"hascorrect id %d size %d\n", ruleID,  m_ruleMap[ruleID]->sortedRules.size( ) );
-    if( m_constraintMap.count( constraintID ) )
-        return m_constraintMap[ constraintID ]->size() > 0;
-
-    return false;
+    return !m_constraintSets[ constraintID ].m_constraints.empty();
 }
 
 
 bool DRC_ENGINE::QueryWorstConstraint( DRC_CONSTRAINT_T aConstraintId, DRC_CONSTRAINT& aConstraint )
 {
-    int worst = 0;
-
-    if( m_constraintMap.count( aConstraintId ) )
-    {
-        for( DRC_ENGINE_CONSTRAINT* c : *m_constraintMap[aConstraintId] )
-        {
-            int current = c->constraint.GetValue().Min();
+    const CONSTRAINT_SET& constraintSet = m_constraintSets[ aConstraintId ];
 
-            if( current > worst )
-            {
-                worst = current;
-                aConstraint = c->constraint;
-            }
-        }
-    }
+    if( constraintSet.m_worst < 0 )
+        return false;
 
-    return worst > 0;
+    aConstraint = constraintSet.m_constraints[ constraintSet.m_worst ].constraint;
+    return true;
 }
 
 
@@ -1666,11 +1921,8 @@ std::set<int> DRC_ENGINE::QueryDistinctConstraints( DRC_CONSTRAINT_T aConstraint
 {
     std::set<int> distinctMinimums;
 
-    if( m_constraintMap.count( aConstraintId ) )
-    {
-        for( DRC_ENGINE_CONSTRAINT* c : *m_constraintMap[aConstraintId] )
-            distinctMinimums.emplace( c->constraint.GetValue().Min() );
-    }
+    for( const DRC_ENGINE_CONSTRAINT& c : m_constraintSets[ aConstraintId ].m_constraints )
+        distinctMinimums.emplace( c.constraint.GetValue().Min() );
 
     return distinctMinimums;
 }
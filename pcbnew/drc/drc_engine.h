@@ -24,14 +24,20 @@
 #ifndef DRC_ENGINE_H
 #define DRC_ENGINE_H
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 #include <unordered_map>
 
+#include <concurrent_cache.h>
 #include <units_provider.h>
 #include <geometry/shape.h>
 
 #include <drc/drc_rule.h>
+#include <drc/drc_provider_stats.h>
 
 
 class BOARD_DESIGN_SETTINGS;
@@ -144,6 +150,23 @@ public:
      */
     void RunTests( EDA_UNITS aUnits,  bool aReportAllTrackErrors, bool aTestFootprints );
 
+    /**
+     * @return timings and counts for each test provider (and the cache generator) from the
+     *         last call to RunTests(), in the order they ran.
+     */
+    const std::vector<DRC_PROVIDER_STATS>& GetProviderStats() const { return m_providerStats; }
+
+    /**
+     * @return the counter a DRC_RTREE::QUERY_COUNTER_SCOPE should use for R-tree searches
+     *         made on behalf of this engine's providers, including from worker threads.
+     */
+    std::atomic<size_t>* GetRTreeQueryCounter() { return &m_rtreeQueries; }
+
+    /**
+     * @return a plain-text table of GetProviderStats(), for reports.
+     */
+    wxString FormatProviderStats() const;
+
     bool IsErrorLimitExceeded( int error_code );
 
     DRC_CONSTRAINT EvalRules( DRC_CONSTRAINT_T aConstraintType, const BOARD_ITEM* a,
@@ -159,6 +182,19 @@ public:
 
     bool HasRulesForConstraintType( DRC_CONSTRAINT_T constraintID );
 
+    /**
+     * Drop memoized rule resolution.  This happens by itself when the rules are recompiled, but
+     * must be done when net classes are reassigned.  Edits to the board don't need it: the cache
+     * is keyed on everything a cacheable rule condition can test.
+     */
+    void ClearConstraintCache();
+
+    /**
+     * @return a number which changes whenever memoized rule resolution is dropped.  Anything
+     *         keeping its own cache of resolved constraints should drop it when this changes.
+     */
+    unsigned GetConstraintCacheGeneration() const { return m_constraintCacheGeneration; }
+
     bool GetReportAllTrackErrors() const { return m_reportAllTrackErrors; }
     bool GetTestFootprints() const { return m_testFootprints; }
 
@@ -194,6 +230,12 @@ public:
     static int MatchDpSuffix( const wxString& aNetName, wxString& aComplementNet,
                               wxString& aBaseDpName );
 
+    /**
+     * Check if rule resolution can be memoized for a rule condition, which is to say that it
+     * tests nothing but the net classes, types and via types of items A and B.
+     */
+    static bool IsCacheableCondition( const wxString& aExpression );
+
     /**
      * Check if the given collision between a track and another item occurs during the track's
      * entry into a net-tie pad.
@@ -227,6 +269,68 @@ private:
     void loadImplicitRules();
     std::shared_ptr<DRC_RULE> createImplicitRule( const wxString& name );
 
+    /**
+     * The properties of an item pair which a cacheable constraint type's rule conditions can
+     * depend on.  Two lookups with equal keys always resolve to the same constraint.
+     */
+    struct CONSTRAINT_CACHE_KEY
+    {
+        DRC_CONSTRAINT_T  m_constraintType;
+        PCB_LAYER_ID      m_layer;
+        wxString          m_netclassA;
+        wxString          m_netclassB;
+        KICAD_T           m_typeA;
+        KICAD_T           m_typeB;
+        int               m_viaTypeA;
+        int               m_viaTypeB;
+        bool              m_nonCopperA;
+        bool              m_nonCopperB;
+        LSET              m_enabledLayers;
+
+        bool operator==( const CONSTRAINT_CACHE_KEY& aOther ) const;
+    };
+
+    struct CONSTRAINT_CACHE_KEY_HASH
+    {
+        std::size_t operator()( const CONSTRAINT_CACHE_KEY& aKey ) const;
+    };
+
+    /**
+     * A memoized constraint along with the cache generation it was resolved under.  A lookup
+     * racing ClearConstraintCache() can store its result after the cache has been dropped, so
+     * entries from an earlier generation are ignored.
+     */
+    struct CACHED_CONSTRAINT
+    {
+        DRC_CONSTRAINT    m_constraint;
+        unsigned          m_generation = 0;
+    };
+
+    /**
+     * All the constraints of a single DRC_CONSTRAINT_T, in rule order, along with some
+     * properties of the set which are worked out when the rules are compiled.
+     */
+    struct CONSTRAINT_SET
+    {
+        std::vector<DRC_ENGINE_CONSTRAINT> m_constraints;
+
+        /// True if any of the constraints' rules has a condition.  If not, resolution never
+        /// needs the expression evaluator.
+        bool                               m_hasConditional = false;
+
+        /// True if resolution can be memoized on a CONSTRAINT_CACHE_KEY (which is to say all
+        /// the conditions only test net classes, item types and via types).
+        bool                               m_cacheable = false;
+
+        /// Index of the constraint with the largest minimum value, or -1 if none is > 0.
+        int                                m_worst = -1;
+    };
+
+    /**
+     * Work out the precomputed properties of each CONSTRAINT_SET.
+     */
+    void analyzeConstraintSets();
+
 protected:
     BOARD_DESIGN_SETTINGS*     m_designSettings;
     BOARD*                     m_board;
@@ -241,8 +345,21 @@ protected:
     bool                       m_reportAllTrackErrors;
     bool                       m_testFootprints;
 
-    // constraint -> rule -> provider
-    std::map<DRC_CONSTRAINT_T, std::vector<DRC_ENGINE_CONSTRAINT*>*> m_constraintMap;
+    // Indexed by DRC_CONSTRAINT_T
+    std::array<CONSTRAINT_SET, DRC_CONSTRAINT_T_COUNT> m_constraintSets;
+
+    // Memoized rule resolution for cacheable constraint sets.  Shared by everything resolving
+    // rules through this engine (DRC, the zone filler and the router) until the rules are
+    // recompiled or the net classes are reassigned.
+    CONCURRENT_CACHE<CONSTRAINT_CACHE_KEY, CACHED_CONSTRAINT,
+                     CONSTRAINT_CACHE_KEY_HASH> m_constraintCache;
+    std::atomic<unsigned>            m_constraintCacheGeneration;
+
+    // Counters for the provider statistics.  Read before and after each provider runs.
+    std::atomic<size_t>              m_ruleEvaluations;
+    std::atomic<size_t>              m_rtreeQueries;
+    std::atomic<size_t>              m_violationCount;
+    std::vector<DRC_PROVIDER_STATS>  m_providerStats;
 
     DRC_VIOLATION_HANDLER      m_violationHandler;
     REPORTER*                  m_reporter;
@@ -0,0 +1,44 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef DRC_PROVIDER_STATS_H
+#define DRC_PROVIDER_STATS_H
+
+#include <wx/string.h>
+
+/**
+ * What one DRC test provider did during a DRC run, and how long it took.
+ *
+ * Kept free of other DRC headers so that it can be wrapped for scripting.
+ */
+struct DRC_PROVIDER_STATS
+{
+    wxString m_Name;
+    double   m_WallTime = 0.0;          ///< in milliseconds
+    size_t   m_ItemsTested = 0;
+    size_t   m_RTreeQueries = 0;
+    size_t   m_RuleEvaluations = 0;     ///< rule sets walked; memoized lookups aren't counted
+    size_t   m_Violations = 0;
+};
+
+#endif // DRC_PROVIDER_STATS_H
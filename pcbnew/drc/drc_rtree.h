@@ -28,6 +28,7 @@
 #include <board_item.h>
 #include <pad.h>
 #include <fp_text.h>
+#include <atomic>
 #include <memory>
 #include <unordered_set>
 #include <set>
@@ -85,6 +86,7 @@ public:
             m_tree[layer] = new drc_rtree();
 
         m_count = 0;
+        m_bulkLoading = false;
     }
 
     ~DRC_RTREE()
@@ -96,6 +98,56 @@ public:
 
             delete tree;
         }
+
+        for( std::vector<PENDING_ITEM>& pending : m_pending )
+        {
+            for( PENDING_ITEM& entry : pending )
+                delete entry.second;
+        }
+    }
+
+    /**
+     * Defer the indexing of items inserted from now on until EndBulkLoad(), which packs each
+     * layer's tree in a single pass.  This is much quicker than inserting items one at a time
+     * and gives better-packed trees (and so faster queries).  Use it for trees which are built
+     * from scratch and then only queried.
+     *
+     * The tree must not be queried between BeginBulkLoad() and EndBulkLoad().
+     */
+    void BeginBulkLoad()
+    {
+        m_bulkLoading = true;
+    }
+
+    /**
+     * Index all items inserted since BeginBulkLoad().
+     */
+    void EndBulkLoad()
+    {
+        m_bulkLoading = false;
+
+        for( int layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
+        {
+            std::vector<PENDING_ITEM>& pending = m_pending[layer];
+
+            if( pending.empty() )
+                continue;
+
+            // A layer which already has items can't be packed without also knowing their
+            // bounding boxes; just add the new ones to it.
+            if( m_tree[layer]->begin() != m_tree[layer]->end() )
+            {
+                for( PENDING_ITEM& entry : pending )
+                    m_tree[layer]->Insert( entry.first.m_min, entry.first.m_max, entry.second );
+            }
+            else
+            {
+                m_tree[layer]->BulkLoad( pending );
+            }
+
+            pending.clear();
+            pending.shrink_to_fit();
+        }
     }
 
     /**
@@ -139,8 +191,7 @@ public:
             const int        mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
             ITEM_WITH_SHAPE* itemShape = new ITEM_WITH_SHAPE( aItem, subshape, shape );
 
-            m_tree[aTargetLayer]->Insert( mmin, mmax, itemShape );
-            m_count++;
+            insert( aTargetLayer, mmin, mmax, itemShape );
         }
 
         if( aItem->Type() == PCB_PAD_T && aItem->HasHole() )
@@ -154,9 +205,7 @@ public:
             const int        mmax[2] = { bbox.GetRight(), bbox.GetBottom() };
             ITEM_WITH_SHAPE* itemShape = new ITEM_WITH_SHAPE( aItem, hole, shape );
 
-            m_tree[aTargetLayer]->Insert( mmin, mmax, itemShape );
-            m_count++;
-
+            insert( aTargetLayer, mmin, mmax, itemShape );
         }
     }
 
@@ -168,7 +217,16 @@ public:
         for( auto tree : m_tree )
             tree->RemoveAll();
 
+        for( std::vector<PENDING_ITEM>& pending : m_pending )
+        {
+            for( PENDING_ITEM& entry : pending )
+                delete entry.second;
+
+            pending.clear();
+        }
+
         m_count = 0;
+        m_bulkLoading = false;
     }
 
     bool CheckColliding( SHAPE* aRefShape, PCB_LAYER_ID aTargetLayer, int aClearance = 0,
@@ -199,7 +257,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aTargetLayer]->Search( min, max, visit );
+        search( aTargetLayer, min, max, visit );
         return count > 0;
     }
 
@@ -269,7 +327,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aTargetLayer]->Search( min, max, visit );
+        search( aTargetLayer, min, max, visit );
         return count;
     }
 
@@ -316,7 +374,7 @@ public:
                     return true;
                 };
 
-        this->m_tree[aLayer]->Search( min, max, visit );
+        search( aLayer, min, max, visit );
 
         if( collision )
         {
@@ -380,9 +438,9 @@ public:
                 };
 
         if( poly && poly->OutlineCount() == 1 )
-            this->m_tree[aLayer]->Search( min, max, polyVisitor );
+            search( aLayer, min, max, polyVisitor );
         else
-            this->m_tree[aLayer]->Search( min, max, visitor );
+            search( aLayer, min, max, visitor );
 
         return collision;
     }
@@ -407,7 +465,7 @@ public:
                     return true;
                 };
 
-        m_tree[aLayer]->Search( min, max, visitor );
+        search( aLayer, min, max, visitor );
 
         return retval;
     }
@@ -459,7 +517,7 @@ public:
                             return true;
                         };
 
-                this->m_tree[targetLayer]->Search( min, max, visit );
+                search( targetLayer, min, max, visit );
             };
         }
 
@@ -569,9 +627,69 @@ public:
     }
 
 
+    /**
+     * While in scope, counts the R-tree searches made by the current thread in \a aCounter.
+     * Work handed to other threads must open its own scope there to be counted.
+     */
+    class QUERY_COUNTER_SCOPE
+    {
+    public:
+        QUERY_COUNTER_SCOPE( std::atomic<size_t>* aCounter ) :
+                m_previous( activeQueryCounter() )
+        {
+            activeQueryCounter() = aCounter;
+        }
+
+        ~QUERY_COUNTER_SCOPE()
+        {
+            activeQueryCounter() = m_previous;
+        }
+
+    private:
+        std::atomic<size_t>* m_previous;
+    };
+
+private:
+    static std::atomic<size_t>*& activeQueryCounter()
+    {
+        thread_local std::atomic<size_t>* t_queryCounter = nullptr;
+        return t_queryCounter;
+    }
+
+    template <class VISITOR>
+    int search( PCB_LAYER_ID aLayer, const int aMin[2], const int aMax[2],
+                VISITOR& aVisitor ) const
+    {
+        if( std::atomic<size_t>* counter = activeQueryCounter() )
+            counter->fetch_add( 1, std::memory_order_relaxed );
+
+        return m_tree[aLayer]->Search( aMin, aMax, aVisitor );
+    }
+
+    void insert( PCB_LAYER_ID aLayer, const int aMin[2], const int aMax[2],
+                 ITEM_WITH_SHAPE* aItem )
+    {
+        if( m_bulkLoading )
+        {
+            drc_rtree::Rect rect = { { aMin[0], aMin[1] }, { aMax[0], aMax[1] } };
+            m_pending[aLayer].emplace_back( rect, aItem );
+        }
+        else
+        {
+            m_tree[aLayer]->Insert( aMin, aMax, aItem );
+        }
+
+        m_count++;
+    }
+
 private:
-    drc_rtree*  m_tree[PCB_LAYER_ID_COUNT];
-    size_t      m_count;
+    typedef std::pair<drc_rtree::Rect, ITEM_WITH_SHAPE*> PENDING_ITEM;
+
+    drc_rtree*                m_tree[PCB_LAYER_ID_COUNT];
+    size_t                    m_count;
+
+    bool                      m_bulkLoading;
+    std::vector<PENDING_ITEM> m_pending[PCB_LAYER_ID_COUNT];
 };
 
 
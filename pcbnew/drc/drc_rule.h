@@ -69,7 +69,9 @@ enum DRC_CONSTRAINT_T
     PHYSICAL_CLEARANCE_CONSTRAINT,
     PHYSICAL_HOLE_CLEARANCE_CONSTRAINT,
     ASSERTION_CONSTRAINT,
-    CONNECTION_WIDTH_CONSTRAINT
+    CONNECTION_WIDTH_CONSTRAINT,
+
+    DRC_CONSTRAINT_T_COUNT      // Number of constraint types; must be last
 };
 
 
@@ -85,6 +85,8 @@ void DRC_TEST_PROVIDER::reportViolation( std::shared_ptr<DRC_ITEM>& item,
 
 bool DRC_TEST_PROVIDER::reportProgress( int aCount, int aSize, int aDelta )
 {
+    accountItemsTested();
+
     if( ( aCount % aDelta ) == 0 || aCount == aSize -  1 )
     {
         if( !m_drcEngine->ReportProgress( (double) aCount / (double) aSize ) )
@@ -28,6 +28,7 @@
 #include <board.h>
 #include <pcb_marker.h>
 
+#include <atomic>
 #include <functional>
 #include <set>
 
@@ -86,6 +87,7 @@ public:
     bool RunTests( EDA_UNITS aUnits )
     {
         SetUserUnits( aUnits );
+        m_itemsTested.store( 0 );
         return Run();
     }
 
@@ -97,6 +99,11 @@ public:
     virtual const wxString GetName() const;
     virtual const wxString GetDescription() const;
 
+    /**
+     * @return the number of items processed during the last call to RunTests().
+     */
+    size_t GetItemsTested() const { return m_itemsTested.load(); }
+
 protected:
     int forEachGeometryItem( const std::vector<KICAD_T>& aTypes, LSET aLayers,
                              const std::function<bool(BOARD_ITEM*)>& aFunc );
@@ -105,6 +112,15 @@ protected:
     virtual void reportViolation( std::shared_ptr<DRC_ITEM>& item, const VECTOR2I& aMarkerPos,
                                   int aMarkerLayer );
     virtual bool reportProgress( int aCount, int aSize, int aDelta );
+
+    /**
+     * Count items processed for GetItemsTested().  reportProgress() does this for serial
+     * tests; multi-threaded tests which report progress directly must call it themselves.
+     */
+    void accountItemsTested( size_t aCount = 1 )
+    {
+        m_itemsTested.fetch_add( aCount, std::memory_order_relaxed );
+    }
     virtual bool reportPhase( const wxString& aStageName );
 
     virtual void reportRuleStatistics();
@@ -123,6 +139,9 @@ protected:
     DRC_ENGINE* m_drcEngine;
     std::unordered_map<const DRC_RULE*, int> m_stats;
     bool        m_isRuleDriven = true;
+
+private:
+    std::atomic<size_t> m_itemsTested{ 0 };
 };
 
 #endif // DRC_TEST_PROVIDER__H
@@ -696,6 +696,8 @@ bool DRC_TEST_PROVIDER_CONNECTION_WIDTH::Run()
     auto min_checker =
             [&]( const ITEMS_POLY& aItemsPoly, const PCB_LAYER_ID aLayer, int aMinWidth ) -> size_t
             {
+                DRC_RTREE::QUERY_COUNTER_SCOPE countQueries( m_drcEngine->GetRTreeQueryCounter() );
+
                 if( m_drcEngine->IsCancelled() )
                     return 0;
 
@@ -773,6 +775,7 @@ bool DRC_TEST_PROVIDER_CONNECTION_WIDTH::Run()
                 }
 
                 done.fetch_add( calc_effort( aItemsPoly.Items, aLayer ) );
+                accountItemsTested( aItemsPoly.Items.size() );
 
                 return 1;
             };
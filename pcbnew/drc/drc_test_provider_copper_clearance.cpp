@@ -21,6 +21,9 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
+#include <set>
+
 #include <common.h>
 #include <math_for_graphics.h>
 #include <board_design_settings.h>
@@ -40,6 +43,7 @@
 #include <drc/drc_rule.h>
 #include <drc/drc_test_provider_clearance_base.h>
 #include <pcb_dimension.h>
+#include <thread_pool.h>
 
 /*
     Copper clearance test. Checks all copper items (pads, vias, tracks, drawings, zones) for their
@@ -79,18 +83,52 @@ public:
     }
 
 private:
+    /**
+     * A violation found on a worker thread.  Violations are buffered per item (or per zone
+     * and layer) and reported from the calling thread once all workers have finished, in
+     * board order, so that the results don't depend on thread scheduling.
+     */
+    struct PENDING_VIOLATION
+    {
+        PENDING_VIOLATION( std::shared_ptr<DRC_ITEM> aItem, const VECTOR2I& aPos,
+                           PCB_LAYER_ID aLayer ) :
+                m_item( std::move( aItem ) ),
+                m_pos( aPos ),
+                m_layer( aLayer )
+        {}
+
+        std::shared_ptr<DRC_ITEM> m_item;
+        VECTOR2I                  m_pos;
+        PCB_LAYER_ID              m_layer;
+    };
+
+    typedef std::vector<PENDING_VIOLATION> VIOLATIONS;
+
     bool testTrackAgainstItem( PCB_TRACK* track, SHAPE* trackShape, PCB_LAYER_ID layer,
-                               BOARD_ITEM* other );
+                               BOARD_ITEM* other, VIOLATIONS& aViolations );
 
     void testTrackClearances();
 
-    bool testPadAgainstItem( PAD* pad, SHAPE* padShape, PCB_LAYER_ID layer, BOARD_ITEM* other );
+    bool testPadAgainstItem( PAD* pad, SHAPE* padShape, PCB_LAYER_ID layer, BOARD_ITEM* other,
+                             VIOLATIONS& aViolations );
 
     void testPadClearances();
 
     void testZonesToZones();
 
-    void testItemAgainstZone( BOARD_ITEM* aItem, ZONE* aZone, PCB_LAYER_ID aLayer );
+    void testItemAgainstZone( BOARD_ITEM* aItem, ZONE* aZone, PCB_LAYER_ID aLayer,
+                              VIOLATIONS& aViolations );
+
+    /**
+     * Run \a aTest for each index in [0, aCount) on the thread pool, in batches of
+     * \a aBatchSize, and report progress until all of them have finished.
+     *
+     * @return the number of indices tested, which is less than \a aCount if DRC was cancelled.
+     */
+    size_t runBatched( size_t aCount, size_t aBatchSize,
+                       const std::function<void( size_t )>& aTest );
+
+    void reportViolations( VIOLATIONS& aViolations );
 
 private:
     int m_drcEpsilon;
@@ -163,7 +201,8 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::Run()
 
 bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track, SHAPE* trackShape,
                                                                PCB_LAYER_ID layer,
-                                                               BOARD_ITEM* other )
+                                                               BOARD_ITEM* other,
+                                                               VIOLATIONS& aViolations )
 {
     bool           testClearance = !m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE );
     bool           testHoles = !m_drcEngine->IsErrorLimitExceeded( DRCE_HOLE_CLEARANCE );
@@ -202,7 +241,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
                 drcItem->SetItems( track, other );
                 drcItem->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drcItem, *intersection, layer );
+                aViolations.emplace_back( drcItem, *intersection, layer );
 
                 return m_drcEngine->GetReportAllTrackErrors();
             }
@@ -229,7 +268,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
                 drce->SetItems( track, other );
                 drce->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drce, pos, layer );
+                aViolations.emplace_back( drce, pos, layer );
 
                 if( !m_drcEngine->GetReportAllTrackErrors() )
                     return false;
@@ -283,7 +322,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
                     drce->SetItems( a[ii], b[ii] );
                     drce->SetViolatingRule( constraint.GetParentRule() );
 
-                    reportViolation( drce, pos, layer );
+                    aViolations.emplace_back( drce, pos, layer );
                     has_error = true;
 
                     if( !m_drcEngine->GetReportAllTrackErrors() )
@@ -298,7 +337,8 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackAgainstItem( PCB_TRACK* track,
 
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZone( BOARD_ITEM* aItem, ZONE* aZone,
-                                                              PCB_LAYER_ID aLayer )
+                                                              PCB_LAYER_ID aLayer,
+                                                              VIOLATIONS& aViolations )
 {
     if( !aZone->GetLayerSet().test( aLayer ) )
         return;
@@ -323,11 +363,14 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZone( BOARD_ITEM* aItem,
     if( !testClearance && !testHoles )
         return;
 
-    DRC_RTREE*  zoneTree = m_board->m_CopperZoneRTreeCache[ aZone ].get();
+    // Don't use operator[] here; this is called from several threads at once.
+    auto zoneTreeIt = m_board->m_CopperZoneRTreeCache.find( aZone );
 
-    if( !zoneTree )
+    if( zoneTreeIt == m_board->m_CopperZoneRTreeCache.end() || !zoneTreeIt->second )
         return;
 
+    DRC_RTREE* zoneTree = zoneTreeIt->second.get();
+
     DRC_CONSTRAINT constraint;
     int            clearance = -1;
     int            actual;
@@ -368,7 +411,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZone( BOARD_ITEM* aItem,
             drce->SetItems( aItem, aZone );
             drce->SetViolatingRule( constraint.GetParentRule() );
 
-            reportViolation( drce, pos, aLayer );
+            aViolations.emplace_back( drce, pos, aLayer );
         }
     }
 
@@ -409,7 +452,7 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZone( BOARD_ITEM* aItem,
                     drce->SetItems( aItem, aZone );
                     drce->SetViolatingRule( constraint.GetParentRule() );
 
-                    reportViolation( drce, pos, aLayer );
+                    aViolations.emplace_back( drce, pos, aLayer );
                 }
             }
         }
@@ -417,95 +460,171 @@ void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testItemAgainstZone( BOARD_ITEM* aItem,
 }
 
 
-void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackClearances()
+size_t DRC_TEST_PROVIDER_COPPER_CLEARANCE::runBatched( size_t aCount, size_t aBatchSize,
+                                                       const std::function<void( size_t )>& aTest )
 {
-    // This is the number of tests between 2 calls to the progress bar
-    const int progressDelta = 100;
-    int       ii = 0;
+    std::atomic<size_t> done( 0 );
 
-    reportAux( wxT( "Testing %d tracks & vias..." ), m_board->Tracks().size() );
+    thread_pool& tp = GetKiCadThreadPool();
+    std::vector<std::future<size_t>> returns;
 
-    std::map<BOARD_ITEM*, int>                  freePadsUsageMap;
-    std::unordered_map<PTR_PTR_CACHE_KEY, LSET> checkedPairs;
+    returns.reserve( aCount / aBatchSize + 1 );
 
-    for( PCB_TRACK* track : m_board->Tracks() )
+    for( size_t start = 0; start < aCount; start += aBatchSize )
     {
-        if( !reportProgress( ii++, m_board->Tracks().size(), progressDelta ) )
-            break;
+        returns.emplace_back( tp.submit(
+                [&]( size_t aStart, size_t aEnd ) -> size_t
+                {
+                    DRC_RTREE::QUERY_COUNTER_SCOPE countQueries(
+                            m_drcEngine->GetRTreeQueryCounter() );
+
+                    for( size_t ii = aStart; ii < aEnd; ++ii )
+                    {
+                        if( m_drcEngine->IsCancelled() )
+                            return ii - aStart;
+
+                        aTest( ii );
+                        done.fetch_add( 1 );
+                    }
 
-        for( PCB_LAYER_ID layer : LSET( track->GetLayerSet() & LSET::AllCuMask() ).Seq() )
+                    return aEnd - aStart;
+                },
+                start, std::min( start + aBatchSize, aCount ) ) );
+    }
+
+    for( const std::future<size_t>& ret : returns )
+    {
+        std::future_status status = ret.wait_for( std::chrono::milliseconds( 250 ) );
+
+        while( status != std::future_status::ready )
         {
-            std::shared_ptr<SHAPE> trackShape = track->GetEffectiveShape( layer );
+            m_drcEngine->ReportProgress( static_cast<double>( done ) / aCount );
+            status = ret.wait_for( std::chrono::milliseconds( 250 ) );
+        }
+    }
 
-            m_board->m_CopperItemRTreeCache->QueryColliding( track, layer, layer,
-                    // Filter:
-                    [&]( BOARD_ITEM* other ) -> bool
-                    {
-                        auto otherCItem = dynamic_cast<BOARD_CONNECTED_ITEM*>( other );
+    return done;
+}
 
-                        if( otherCItem && otherCItem->GetNetCode() == track->GetNetCode() )
-                            return false;
 
-                        BOARD_ITEM* a = track;
-                        BOARD_ITEM* b = other;
+void DRC_TEST_PROVIDER_COPPER_CLEARANCE::reportViolations( VIOLATIONS& aViolations )
+{
+    for( PENDING_VIOLATION& violation : aViolations )
+    {
+        // The workers can't see each other's results, so error limits are applied here
+        if( !m_drcEngine->IsErrorLimitExceeded( violation.m_item->GetErrorCode() ) )
+            reportViolation( violation.m_item, violation.m_pos, violation.m_layer );
+    }
+}
 
-                        // store canonical order so we don't collide in both directions
-                        // (a:b and b:a)
-                        if( static_cast<void*>( a ) > static_cast<void*>( b ) )
-                            std::swap( a, b );
 
-                        auto it = checkedPairs.find( { a, b } );
+void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testTrackClearances()
+{
+    // This is the number of tracks handed to a worker thread at a time
+    const size_t batchSize = 100;
 
-                        if( it != checkedPairs.end() && it->second.test( layer ) )
-                        {
-                            return false;
-                        }
-                        else
-                        {
-                            checkedPairs[ { a, b } ].set( layer );
-                            return true;
-                        }
-                    },
-                    // Visitor:
-                    [&]( BOARD_ITEM* other ) -> bool
-                    {
-                        if( other->Type() == PCB_PAD_T && static_cast<PAD*>( other )->IsFreePad() )
-                        {
-                            if( other->GetEffectiveShape( layer )->Collide( trackShape.get() ) )
+    reportAux( wxT( "Testing %d tracks & vias..." ), m_board->Tracks().size() );
+
+    std::vector<PCB_TRACK*>                 tracks( m_board->Tracks().begin(),
+                                                    m_board->Tracks().end() );
+    std::unordered_map<BOARD_ITEM*, size_t> trackIndex;
+
+    for( size_t ii = 0; ii < tracks.size(); ++ii )
+        trackIndex[ tracks[ii] ] = ii;
+
+    // Which track gets to claim a free pad depends on board order, so collisions with free
+    // pads (and any violations against them) are kept aside until all tracks have been tested.
+    struct FREE_PAD_HIT
+    {
+        BOARD_ITEM* m_pad;
+        VIOLATIONS  m_violations;
+    };
+
+    std::vector<VIOLATIONS>                violations( tracks.size() );
+    std::vector<std::vector<FREE_PAD_HIT>> freePadHits( tracks.size() );
+
+    auto testTrack =
+            [&]( size_t aIdx )
+            {
+                PCB_TRACK* track = tracks[aIdx];
+
+                for( PCB_LAYER_ID layer : LSET( track->GetLayerSet() & LSET::AllCuMask() ).Seq() )
+                {
+                    std::shared_ptr<SHAPE> trackShape = track->GetEffectiveShape( layer );
+
+                    m_board->m_CopperItemRTreeCache->QueryColliding( track, layer, layer,
+                            // Filter:
+                            [&]( BOARD_ITEM* other ) -> bool
                             {
-                                auto it = freePadsUsageMap.find( other );
+                                auto otherCItem = dynamic_cast<BOARD_CONNECTED_ITEM*>( other );
 
-                                if( it == freePadsUsageMap.end() )
-                                {
-                                    freePadsUsageMap[ other ] = track->GetNetCode();
+                                if( otherCItem && otherCItem->GetNetCode() == track->GetNetCode() )
                                     return false;
-                                }
-                                else if( it->second == track->GetNetCode() )
+
+                                // A track:track pair is tested by whichever comes first in board
+                                // order so we don't collide in both directions (a:b and b:a)
+                                auto it = trackIndex.find( other );
+
+                                return it == trackIndex.end() || it->second > aIdx;
+                            },
+                            // Visitor:
+                            [&]( BOARD_ITEM* other ) -> bool
+                            {
+                                if( other->Type() == PCB_PAD_T
+                                        && static_cast<PAD*>( other )->IsFreePad()
+                                        && other->GetEffectiveShape( layer )->Collide(
+                                                trackShape.get() ) )
                                 {
-                                    return false;
+                                    freePadHits[aIdx].push_back( { other, {} } );
+
+                                    testTrackAgainstItem( track, trackShape.get(), layer, other,
+                                                          freePadHits[aIdx].back().m_violations );
+
+                                    return !m_drcEngine->IsCancelled();
                                 }
-                            }
-                        }
 
-                        return testTrackAgainstItem( track, trackShape.get(), layer, other );
-                    },
-                    m_board->m_DRCMaxClearance );
+                                return testTrackAgainstItem( track, trackShape.get(), layer, other,
+                                                             violations[aIdx] );
+                            },
+                            m_board->m_DRCMaxClearance );
 
-            for( ZONE* zone : m_board->m_DRCCopperZones )
-            {
-                testItemAgainstZone( track, zone, layer );
+                    for( ZONE* zone : m_board->m_DRCCopperZones )
+                    {
+                        testItemAgainstZone( track, zone, layer, violations[aIdx] );
 
-                if( m_drcEngine->IsCancelled() )
-                    break;
-            }
+                        if( m_drcEngine->IsCancelled() )
+                            break;
+                    }
+                }
+            };
+
+    accountItemsTested( runBatched( tracks.size(), batchSize, testTrack ) );
+
+    // A free pad takes on the net of the first track to connect to it; tracks of that net may
+    // then touch it freely.
+    std::map<BOARD_ITEM*, int> freePadsUsageMap;
+
+    for( size_t ii = 0; ii < tracks.size() && !m_drcEngine->IsCancelled(); ++ii )
+    {
+        for( FREE_PAD_HIT& hit : freePadHits[ii] )
+        {
+            auto it = freePadsUsageMap.find( hit.m_pad );
+
+            if( it == freePadsUsageMap.end() )
+                freePadsUsageMap[ hit.m_pad ] = tracks[ii]->GetNetCode();
+            else if( it->second != tracks[ii]->GetNetCode() )
+                reportViolations( hit.m_violations );
         }
+
+        reportViolations( violations[ii] );
     }
 }
 
 
 bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* padShape,
                                                              PCB_LAYER_ID aLayer,
-                                                             BOARD_ITEM* other )
+                                                             BOARD_ITEM* other,
+                                                             VIOLATIONS& aViolations )
 {
     bool testClearance = !m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE );
     bool testShorting = !m_drcEngine->IsErrorLimitExceeded( DRCE_SHORTING_ITEMS );
@@ -574,8 +693,9 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
         testHoles = false;
     }
 
+    // Nothing to test against this item, but keep looking at the others
     if( !testClearance && !testShorting && !testHoles )
-        return false;
+        return !m_drcEngine->IsCancelled();
 
     std::shared_ptr<SHAPE> otherShape = other->GetEffectiveShape( aLayer );
     DRC_CONSTRAINT         constraint;
@@ -602,7 +722,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
             drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
             drce->SetItems( pad, otherPad );
 
-            reportViolation( drce, otherPad->GetPosition(), aLayer );
+            aViolations.emplace_back( drce, otherPad->GetPosition(), aLayer );
         }
 
         return !m_drcEngine->IsCancelled();
@@ -630,7 +750,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
                 drce->SetItems( pad, other );
                 drce->SetViolatingRule( constraint.GetParentRule() );
 
-                reportViolation( drce, pos, aLayer );
+                aViolations.emplace_back( drce, pos, aLayer );
                 testHoles = false;  // No need for multiple violations
             }
         }
@@ -663,7 +783,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
             drce->SetItems( pad, other );
             drce->SetViolatingRule( constraint.GetParentRule() );
 
-            reportViolation( drce, pos, aLayer );
+            aViolations.emplace_back( drce, pos, aLayer );
             testHoles = false;  // No need for multiple violations
         }
     }
@@ -686,7 +806,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
             drce->SetItems( pad, other );
             drce->SetViolatingRule( constraint.GetParentRule() );
 
-            reportViolation( drce, pos, aLayer );
+            aViolations.emplace_back( drce, pos, aLayer );
             testHoles = false;  // No need for multiple violations
         }
     }
@@ -709,7 +829,7 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
             drce->SetItems( pad, otherVia );
             drce->SetViolatingRule( constraint.GetParentRule() );
 
-            reportViolation( drce, pos, aLayer );
+            aViolations.emplace_back( drce, pos, aLayer );
         }
     }
 
@@ -719,262 +839,283 @@ bool DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadAgainstItem( PAD* pad, SHAPE* pa
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testPadClearances( )
 {
-    const int progressDelta = 100;
-    size_t    count = 0;
-    int       ii = 0;
+    // This is the number of pads handed to a worker thread at a time
+    const size_t batchSize = 50;
 
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-        count += footprint->Pads().size();
-
-    reportAux( wxT( "Testing %d pads..." ), count );
-
-    std::unordered_map<PTR_PTR_CACHE_KEY, int> checkedPairs;
+    std::vector<PAD*>                       pads;
+    std::unordered_map<BOARD_ITEM*, size_t> padIndex;
 
     for( FOOTPRINT* footprint : m_board->Footprints() )
     {
         for( PAD* pad : footprint->Pads() )
         {
-            for( PCB_LAYER_ID layer : pad->GetLayerSet().Seq() )
-            {
-                std::shared_ptr<SHAPE> padShape = pad->GetEffectiveShape( layer );
+            padIndex[ pad ] = pads.size();
+            pads.push_back( pad );
+        }
+    }
 
-                m_board->m_CopperItemRTreeCache->QueryColliding( pad, layer, layer,
-                        // Filter:
-                        [&]( BOARD_ITEM* other ) -> bool
-                        {
-                            BOARD_ITEM* a = pad;
-                            BOARD_ITEM* b = other;
+    reportAux( wxT( "Testing %d pads..." ), pads.size() );
+
+    std::vector<VIOLATIONS> violations( pads.size() );
+
+    auto testPad =
+            [&]( size_t aIdx )
+            {
+                PAD*                  pad = pads[aIdx];
+                std::set<BOARD_ITEM*> checkedItems;
 
-                            // store canonical order so we don't collide in both directions
-                            // (a:b and b:a)
-                            if( static_cast<void*>( a ) > static_cast<void*>( b ) )
-                                std::swap( a, b );
+                for( PCB_LAYER_ID layer : pad->GetLayerSet().Seq() )
+                {
+                    std::shared_ptr<SHAPE> padShape = pad->GetEffectiveShape( layer );
 
-                            if( checkedPairs.find( { a, b } ) != checkedPairs.end() )
+                    m_board->m_CopperItemRTreeCache->QueryColliding( pad, layer, layer,
+                            // Filter:
+                            [&]( BOARD_ITEM* other ) -> bool
                             {
-                                return false;
-                            }
-                            else
+                                // A pad:pad pair is tested by whichever comes first in board
+                                // order so we don't collide in both directions (a:b and b:a)
+                                auto it = padIndex.find( other );
+
+                                if( it != padIndex.end() && it->second < aIdx )
+                                    return false;
+
+                                // Each pair is only tested on the first layer it's found on
+                                return checkedItems.insert( other ).second;
+                            },
+                            // Visitor
+                            [&]( BOARD_ITEM* other ) -> bool
                             {
-                                checkedPairs[ { a, b } ] = 1;
-                                return true;
-                            }
-                        },
-                        // Visitor
-                        [&]( BOARD_ITEM* other ) -> bool
-                        {
-                            return testPadAgainstItem( pad, padShape.get(), layer, other );
-                        },
-                        m_board->m_DRCMaxClearance );
+                                return testPadAgainstItem( pad, padShape.get(), layer, other,
+                                                           violations[aIdx] );
+                            },
+                            m_board->m_DRCMaxClearance );
 
-                for( ZONE* zone : m_board->m_DRCCopperZones )
-                {
-                    testItemAgainstZone( pad, zone, layer );
+                    for( ZONE* zone : m_board->m_DRCCopperZones )
+                    {
+                        testItemAgainstZone( pad, zone, layer, violations[aIdx] );
 
-                    if( m_drcEngine->IsCancelled() )
-                        return;
+                        if( m_drcEngine->IsCancelled() )
+                            return;
+                    }
                 }
-            }
+            };
 
-            if( !reportProgress( ii++, count, progressDelta ) )
-                return;
-        }
+    accountItemsTested( runBatched( pads.size(), batchSize, testPad ) );
 
-        if( m_drcEngine->IsCancelled() )
-            return;
-    }
+    for( size_t ii = 0; ii < pads.size() && !m_drcEngine->IsCancelled(); ++ii )
+        reportViolations( violations[ii] );
 }
 
 
 void DRC_TEST_PROVIDER_COPPER_CLEARANCE::testZonesToZones()
 {
-    const int progressDelta = 50;
-
     bool      testClearance = !m_drcEngine->IsErrorLimitExceeded( DRCE_CLEARANCE );
     bool      testIntersects = !m_drcEngine->IsErrorLimitExceeded( DRCE_ZONES_INTERSECT );
 
     SHAPE_POLY_SET  buffer;
     SHAPE_POLY_SET* boardOutline = nullptr;
-    DRC_CONSTRAINT  constraint;
-    int             zone2zoneClearance;
 
     if( m_board->GetBoardPolygonOutlines( buffer ) )
         boardOutline = &buffer;
 
+    const std::vector<ZONE*>& zones = m_board->m_DRCCopperZones;
+    std::vector<PCB_LAYER_ID> layers;
+
+    if( zones.empty() )
+        return;
+
+    // Skip over layers not used on the current board
     for( int layer_id = F_Cu; layer_id <= B_Cu; ++layer_id )
     {
-        PCB_LAYER_ID layer = static_cast<PCB_LAYER_ID>( layer_id );
-        std::vector<SHAPE_POLY_SET> smoothed_polys;
-        smoothed_polys.resize( m_board->m_DRCCopperZones.size() );
+        if( m_board->IsLayerEnabled( static_cast<PCB_LAYER_ID>( layer_id ) ) )
+            layers.push_back( static_cast<PCB_LAYER_ID>( layer_id ) );
+    }
 
-        // Skip over layers not used on the current board
-        if( !m_board->IsLayerEnabled( layer ) )
-            continue;
+    // Work is split up by (layer, zone), in layer-major order.  Each task compares its zone
+    // with all following zones on that layer.
+    size_t                                   count = layers.size() * zones.size();
+    std::vector<std::vector<SHAPE_POLY_SET>> smoothed_polys( layers.size() );
 
-        for( size_t ii = 0; ii < m_board->m_DRCCopperZones.size(); ii++ )
-        {
-            if( m_board->m_DRCCopperZones[ii]->IsOnLayer( layer ) )
-            {
-                m_board->m_DRCCopperZones[ii]->BuildSmoothedPoly( smoothed_polys[ii], layer,
-                                                                  boardOutline );
-            }
-        }
+    for( std::vector<SHAPE_POLY_SET>& polys : smoothed_polys )
+        polys.resize( zones.size() );
 
-        // iterate through all areas
-        for( size_t ia = 0; ia < m_board->m_DRCCopperZones.size(); ia++ )
-        {
-            if( !reportProgress( layer_id * m_board->m_DRCCopperZones.size() + ia,
-                                 B_Cu * m_board->m_DRCCopperZones.size(), progressDelta ) )
+    runBatched( count, 1,
+            [&]( size_t aIdx )
             {
-                return;     // DRC cancelled
-            }
+                PCB_LAYER_ID layer = layers[ aIdx / zones.size() ];
+                size_t       ii = aIdx % zones.size();
 
-            ZONE* zoneA = m_board->m_DRCCopperZones[ia];
+                if( zones[ii]->IsOnLayer( layer ) )
+                {
+                    zones[ii]->BuildSmoothedPoly( smoothed_polys[ aIdx / zones.size() ][ii],
+                                                  layer, boardOutline );
+                }
+            } );
 
-            if( !zoneA->IsOnLayer( layer ) )
-                continue;
+    std::vector<VIOLATIONS> violations( count );
 
-            for( size_t ia2 = ia + 1; ia2 < m_board->m_DRCCopperZones.size(); ia2++ )
+    runBatched( count, 1,
+            [&]( size_t aIdx )
             {
-                ZONE* zoneB = m_board->m_DRCCopperZones[ia2];
+                PCB_LAYER_ID                 layer = layers[ aIdx / zones.size() ];
+                std::vector<SHAPE_POLY_SET>& polys = smoothed_polys[ aIdx / zones.size() ];
+                size_t                       ia = aIdx % zones.size();
+                ZONE*                        zoneA = zones[ia];
 
-                // test for same layer
-                if( !zoneB->IsOnLayer( layer ) )
-                    continue;
+                if( !zoneA->IsOnLayer( layer ) )
+                    return;
 
-                // Test for same net
-                if( zoneA->GetNetCode() == zoneB->GetNetCode() && zoneA->GetNetCode() >= 0 )
-                    continue;
+                for( size_t ia2 = ia + 1; ia2 < zones.size(); ia2++ )
+                {
+                    ZONE* zoneB = zones[ia2];
 
-                // test for different priorities
-                if( zoneA->GetAssignedPriority() != zoneB->GetAssignedPriority() )
-                    continue;
+                    // test for same layer
+                    if( !zoneB->IsOnLayer( layer ) )
+                        continue;
 
-                // rule areas may overlap at will
-                if( zoneA->GetIsRuleArea() || zoneB->GetIsRuleArea() )
-                    continue;
+                    // Test for same net
+                    if( zoneA->GetNetCode() == zoneB->GetNetCode() && zoneA->GetNetCode() >= 0 )
+                        continue;
 
-                // Examine a candidate zone: compare zoneB to zoneA
+                    // test for different priorities
+                    if( zoneA->GetAssignedPriority() != zoneB->GetAssignedPriority() )
+                        continue;
 
-                // Get clearance used in zone to zone test.
-                constraint = m_drcEngine->EvalRules( CLEARANCE_CONSTRAINT, zoneA, zoneB, layer );
-                zone2zoneClearance = constraint.GetValue().Min();
+                    // rule areas may overlap at will
+                    if( zoneA->GetIsRuleArea() || zoneB->GetIsRuleArea() )
+                        continue;
 
-                if( constraint.GetSeverity() == RPT_SEVERITY_IGNORE )
-                    continue;
+                    // Examine a candidate zone: compare zoneB to zoneA
 
-                if( testIntersects )
-                {
-                    // test for some corners of zoneA inside zoneB
-                    for( auto it = smoothed_polys[ia].IterateWithHoles(); it; it++ )
-                    {
-                        VECTOR2I currentVertex = *it;
-                        wxPoint pt( currentVertex.x, currentVertex.y );
+                    // Get clearance used in zone to zone test.
+                    DRC_CONSTRAINT constraint = m_drcEngine->EvalRules( CLEARANCE_CONSTRAINT, zoneA,
+                                                                        zoneB, layer );
+                    int            zone2zoneClearance = constraint.GetValue().Min();
+
+                    if( constraint.GetSeverity() == RPT_SEVERITY_IGNORE )
+                        continue;
 
-                        if( smoothed_polys[ia2].Contains( currentVertex ) )
+                    if( testIntersects )
+                    {
+                        // test for some corners of zoneA inside zoneB
+                        for( auto it = polys[ia].IterateWithHoles(); it; it++ )
                         {
-                            std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
-                            drce->SetItems( zoneA, zoneB );
-                            drce->SetViolatingRule( constraint.GetParentRule() );
+                            VECTOR2I currentVertex = *it;
+                            wxPoint pt( currentVertex.x, currentVertex.y );
 
-                            reportViolation( drce, pt, layer );
-                        }
-                    }
+                            if( polys[ia2].Contains( currentVertex ) )
+                            {
+                                std::shared_ptr<DRC_ITEM> drce;
 
-                    // test for some corners of zoneB inside zoneA
-                    for( auto it = smoothed_polys[ia2].IterateWithHoles(); it; it++ )
-                    {
-                        VECTOR2I currentVertex = *it;
-                        wxPoint pt( currentVertex.x, currentVertex.y );
+                                drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
+                                drce->SetItems( zoneA, zoneB );
+                                drce->SetViolatingRule( constraint.GetParentRule() );
+
+                                violations[aIdx].emplace_back( drce, pt, layer );
+                            }
+                        }
 
-                        if( smoothed_polys[ia].Contains( currentVertex ) )
+                        // test for some corners of zoneB inside zoneA
+                        for( auto it = polys[ia2].IterateWithHoles(); it; it++ )
                         {
-                            std::shared_ptr<DRC_ITEM> drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
-                            drce->SetItems( zoneB, zoneA );
-                            drce->SetViolatingRule( constraint.GetParentRule() );
+                            VECTOR2I currentVertex = *it;
+                            wxPoint pt( currentVertex.x, currentVertex.y );
+
+                            if( polys[ia].Contains( currentVertex ) )
+                            {
+                                std::shared_ptr<DRC_ITEM> drce;
 
-                            reportViolation( drce, pt, layer );
+                                drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
+                                drce->SetItems( zoneB, zoneA );
+                                drce->SetViolatingRule( constraint.GetParentRule() );
+
+                                violations[aIdx].emplace_back( drce, pt, layer );
+                            }
                         }
                     }
-                }
-
-                // Iterate through all the segments of refSmoothedPoly
-                std::map<VECTOR2I, int> conflictPoints;
 
-                for( auto refIt = smoothed_polys[ia].IterateSegmentsWithHoles(); refIt; refIt++ )
-                {
-                    // Build ref segment
-                    SEG refSegment = *refIt;
+                    // Iterate through all the segments of refSmoothedPoly
+                    std::map<VECTOR2I, int> conflictPoints;
 
-                    // Iterate through all the segments in smoothed_polys[ia2]
-                    for( auto it = smoothed_polys[ia2].IterateSegmentsWithHoles(); it; it++ )
+                    for( auto refIt = polys[ia].IterateSegmentsWithHoles(); refIt; refIt++ )
                     {
-                        // Build test segment
-                        SEG testSegment = *it;
-                        VECTOR2I pt;
-
-                        int ax1, ay1, ax2, ay2;
-                        ax1 = refSegment.A.x;
-                        ay1 = refSegment.A.y;
-                        ax2 = refSegment.B.x;
-                        ay2 = refSegment.B.y;
-
-                        int bx1, by1, bx2, by2;
-                        bx1 = testSegment.A.x;
-                        by1 = testSegment.A.y;
-                        bx2 = testSegment.B.x;
-                        by2 = testSegment.B.y;
-
-                        int d = GetClearanceBetweenSegments( bx1, by1, bx2, by2, 0,
-                                                             ax1, ay1, ax2, ay2, 0,
-                                                             zone2zoneClearance, &pt.x, &pt.y );
-
-                        if( d < zone2zoneClearance )
+                        // Build ref segment
+                        SEG refSegment = *refIt;
+
+                        // Iterate through all the segments in polys[ia2]
+                        for( auto it = polys[ia2].IterateSegmentsWithHoles(); it; it++ )
                         {
-                            if( conflictPoints.count( pt ) )
-                                conflictPoints[ pt ] = std::min( conflictPoints[ pt ], d );
-                            else
-                                conflictPoints[ pt ] = d;
+                            // Build test segment
+                            SEG testSegment = *it;
+                            VECTOR2I pt;
+
+                            int ax1, ay1, ax2, ay2;
+                            ax1 = refSegment.A.x;
+                            ay1 = refSegment.A.y;
+                            ax2 = refSegment.B.x;
+                            ay2 = refSegment.B.y;
+
+                            int bx1, by1, bx2, by2;
+                            bx1 = testSegment.A.x;
+                            by1 = testSegment.A.y;
+                            bx2 = testSegment.B.x;
+                            by2 = testSegment.B.y;
+
+                            int d = GetClearanceBetweenSegments( bx1, by1, bx2, by2, 0,
+                                                                 ax1, ay1, ax2, ay2, 0,
+                                                                 zone2zoneClearance, &pt.x, &pt.y );
+
+                            if( d < zone2zoneClearance )
+                            {
+                                if( conflictPoints.count( pt ) )
+                                    conflictPoints[ pt ] = std::min( conflictPoints[ pt ], d );
+                                else
+                                    conflictPoints[ pt ] = d;
+                            }
                         }
                     }
-                }
 
-                for( const std::pair<const VECTOR2I, int>& conflict : conflictPoints )
-                {
-                    int actual = conflict.second;
-                    std::shared_ptr<DRC_ITEM> drce;
-
-                    if( actual <= 0 && testIntersects )
-                    {
-                        drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
-                    }
-                    else if( testClearance )
+                    for( const std::pair<const VECTOR2I, int>& conflict : conflictPoints )
                     {
-                        drce = DRC_ITEM::Create( DRCE_CLEARANCE );
-                        wxString msg;
+                        int actual = conflict.second;
+                        std::shared_ptr<DRC_ITEM> drce;
 
-                        msg.Printf( _( "(%s clearance %s; actual %s)" ),
-                                      constraint.GetName(),
-                                      MessageTextFromValue( zone2zoneClearance ),
-                                      MessageTextFromValue( std::max( actual, 0 ) ) );
+                        if( actual <= 0 && testIntersects )
+                        {
+                            drce = DRC_ITEM::Create( DRCE_ZONES_INTERSECT );
+                        }
+                        else if( testClearance )
+                        {
+                            drce = DRC_ITEM::Create( DRCE_CLEARANCE );
+                            wxString msg;
 
-                        drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
-                    }
+                            msg.Printf( _( "(%s clearance %s; actual %s)" ),
+                                          constraint.GetName(),
+                                          MessageTextFromValue( zone2zoneClearance ),
+                                          MessageTextFromValue( std::max( actual, 0 ) ) );
 
-                    if( drce )
-                    {
-                        drce->SetItems( zoneA, zoneB );
-                        drce->SetViolatingRule( constraint.GetParentRule() );
+                            drce->SetErrorMessage( drce->GetErrorText() + wxS( " " ) + msg );
+                        }
+
+                        if( drce )
+                        {
+                            drce->SetItems( zoneA, zoneB );
+                            drce->SetViolatingRule( constraint.GetParentRule() );
 
-                        reportViolation( drce, conflict.first, layer );
+                            violations[aIdx].emplace_back( drce, conflict.first, layer );
+                        }
                     }
+
+                    if( m_drcEngine->IsCancelled() )
+                        return;
                 }
+            } );
 
-                if( m_drcEngine->IsCancelled() )
-                    return;
-            }
-        }
-    }
+    // Each zone is visited once per layer by each pass, but only counts as one item
+    accountItemsTested( zones.size() );
+
+    for( size_t ii = 0; ii < count && !m_drcEngine->IsCancelled(); ++ii )
+        reportViolations( violations[ii] );
 }
 
 
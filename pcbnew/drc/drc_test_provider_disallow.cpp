@@ -111,6 +111,8 @@ bool DRC_TEST_PROVIDER_DISALLOW::Run()
     auto query_areas =
             [&]( std::pair<ZONE* /* rule area */, ZONE* /* copper zone */> areaZonePair ) -> size_t
             {
+                DRC_RTREE::QUERY_COUNTER_SCOPE countQueries( m_drcEngine->GetRTreeQueryCounter() );
+
                 if( m_drcEngine->IsCancelled() )
                     return 0;
 
@@ -152,11 +154,10 @@ bool DRC_TEST_PROVIDER_DISALLOW::Run()
 
                 PTR_PTR_LAYER_CACHE_KEY key = { ruleArea, copperZone, UNDEFINED_LAYER };
 
-                {
-                    std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-                    board->m_IntersectsAreaCache[ key ] = isInside;
-                }
+                board->m_IntersectsAreaCache.Set( key, isInside );
 
+                // Not counted in the items tested: the zones are counted when they're checked
+                // below, along with everything else.
                 done.fetch_add( 1 );
 
                 return 1;
@@ -228,6 +228,8 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
                 return true;
             } );
 
+    edgesTree.BeginBulkLoad();
+
     for( const std::unique_ptr<PCB_SHAPE>& edge : edges )
     {
         for( PCB_LAYER_ID layer : { Edge_Cuts, Margin } )
@@ -249,6 +251,8 @@ bool DRC_TEST_PROVIDER_EDGE_CLEARANCE::Run()
         }
     }
 
+    edgesTree.EndBulkLoad();
+
     /*
      * Test copper and silk items against the set of edges.
      */
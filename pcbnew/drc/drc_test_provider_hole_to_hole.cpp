@@ -135,6 +135,8 @@ bool DRC_TEST_PROVIDER_HOLE_TO_HOLE::Run()
 
     count *= 2;  // One for adding to the rtree; one for checking
 
+    m_holeTree.BeginBulkLoad();
+
     forEachGeometryItem( { PCB_PAD_T, PCB_VIA_T }, LSET::AllLayersMask(),
             [&]( BOARD_ITEM* item ) -> bool
             {
@@ -161,6 +163,8 @@ bool DRC_TEST_PROVIDER_HOLE_TO_HOLE::Run()
                 return true;
             } );
 
+    m_holeTree.EndBulkLoad();
+
     std::unordered_map<PTR_PTR_CACHE_KEY, int> checkedPairs;
 
     for( PCB_TRACK* track : m_board->Tracks() )
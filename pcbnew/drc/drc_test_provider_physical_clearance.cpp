@@ -134,6 +134,8 @@ bool DRC_TEST_PROVIDER_PHYSICAL_CLEARANCE::Run()
     // Generate a BOARD_ITEM RTree.
     //
 
+    m_itemTree.BeginBulkLoad();
+
     forEachGeometryItem( itemTypes, LSET::AllLayersMask(),
             [&]( BOARD_ITEM* item ) -> bool
             {
@@ -162,6 +164,8 @@ bool DRC_TEST_PROVIDER_PHYSICAL_CLEARANCE::Run()
                 return true;
             } );
 
+    m_itemTree.EndBulkLoad();
+
     std::unordered_map<PTR_PTR_CACHE_KEY, LSET> checkedPairs;
     progressDelta = 100;
     ii = 0;
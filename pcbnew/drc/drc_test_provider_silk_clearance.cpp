@@ -142,12 +142,18 @@ bool DRC_TEST_PROVIDER_SILK_CLEARANCE::Run()
                          LSET::FrontMask() | LSET::BackMask() | LSET( 2, Edge_Cuts, Margin ),
                          countItems );
 
+    silkTree.BeginBulkLoad();
+    targetTree.BeginBulkLoad();
+
     forEachGeometryItem( s_allBasicItems, LSET( 2, F_SilkS, B_SilkS ), addToSilkTree );
 
     forEachGeometryItem( s_allBasicItems,
                          LSET::FrontMask() | LSET::BackMask() | LSET( 2, Edge_Cuts, Margin ),
                          addToTargetTree );
 
+    silkTree.EndBulkLoad();
+    targetTree.EndBulkLoad();
+
     reportAux( wxT( "Testing %d silkscreen features against %d board items." ),
                silkTree.size(),
                targetTree.size() );
@@ -165,6 +165,7 @@ bool DRC_TEST_PROVIDER_SLIVER_CHECKER::Run()
                 poly.Deflate( widthTolerance / 2, ARC_LOW_DEF,
                               SHAPE_POLY_SET::ALLOW_ACUTE_CORNERS );
 
+                accountItemsTested();
                 return 1;
             };
 
@@ -119,11 +119,9 @@ void DRC_TEST_PROVIDER_SOLDER_MASK::addItemToRTrees( BOARD_ITEM* aItem )
 
         for( PCB_LAYER_ID layer : { F_Mask, B_Mask } )
         {
+            // Merged with everything else by the Simplify() in buildRTrees()
             if( zone->IsOnLayer( layer ) )
-            {
-                solderMask->GetFill( layer )->BooleanAdd( *zone->GetFilledPolysList( layer ),
-                                                          SHAPE_POLY_SET::PM_FAST );
-            }
+                solderMask->GetFill( layer )->Append( *zone->GetFilledPolysList( layer ) );
         }
     }
     else if( aItem->Type() == PCB_PAD_T )
@@ -197,6 +195,8 @@ void DRC_TEST_PROVIDER_SOLDER_MASK::buildRTrees()
                 return true;
             } );
 
+    m_itemTree->BeginBulkLoad();
+
     forEachGeometryItem( s_allBasicItems, layers,
             [&]( BOARD_ITEM* item ) -> bool
             {
@@ -207,6 +207,8 @@ void DRC_TEST_PROVIDER_SOLDER_MASK::buildRTrees()
                 return true;
             } );
 
+    m_itemTree->EndBulkLoad();
+
     solderMask->GetFill( F_Mask )->Simplify( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
     solderMask->GetFill( B_Mask )->Simplify( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
 
@@ -221,8 +223,10 @@ void DRC_TEST_PROVIDER_SOLDER_MASK::buildRTrees()
 
     solderMask->CacheTriangulation();
 
+    m_fullSolderMaskRTree->BeginBulkLoad();
     m_fullSolderMaskRTree->Insert( solderMask, F_Mask );
     m_fullSolderMaskRTree->Insert( solderMask, B_Mask );
+    m_fullSolderMaskRTree->EndBulkLoad();
 
     m_checkedPairs.clear();
 }
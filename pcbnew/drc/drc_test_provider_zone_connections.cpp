@@ -33,6 +33,7 @@
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_poly_set.h>
 #include <drc/drc_rule.h>
+#include <drc/drc_rtree.h>
 #include <drc/drc_item.h>
 #include <drc/drc_test_provider.h>
 
@@ -220,9 +221,13 @@ bool DRC_TEST_PROVIDER_ZONE_CONNECTIONS::Run()
         returns.emplace_back( tp.submit(
                 [&]( ZONE* aZone, PCB_LAYER_ID aLayer ) -> int
                 {
+                    DRC_RTREE::QUERY_COUNTER_SCOPE countQueries(
+                            m_drcEngine->GetRTreeQueryCounter() );
+
                     if( !m_drcEngine->IsCancelled() )
                     {
                         testZoneLayer( aZone, aLayer );
+                        accountItemsTested();
                         done.fetch_add( aZone->GetFilledPolysList( aLayer )->FullPointCount() );
                     }
 
@@ -216,12 +216,16 @@ void PAD::addPadPrimitivesToPolygon( SHAPE_POLY_SET* aMergedPolygon, int aError,
         }
     }
 
-    polyset.Simplify( SHAPE_POLY_SET::PM_FAST );
-
-    // Merge all polygons with the initial pad anchor shape
+    // Merge all polygons with the initial pad anchor shape (which unions the primitives with
+    // each other at the same time)
     if( polyset.OutlineCount() )
     {
-        aMergedPolygon->BooleanAdd( polyset, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+        SHAPE_POLY_SET::BOOLEAN_BUILDER merge;
+
+        merge.AddSubject( *aMergedPolygon );
+        merge.AddSubject( polyset );
+        merge.Union( *aMergedPolygon, SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
+
         aMergedPolygon->Fracture( SHAPE_POLY_SET::PM_STRICTLY_SIMPLE );
     }
 }
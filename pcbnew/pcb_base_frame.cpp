@@ -91,6 +91,13 @@ PCB_BASE_FRAME::~PCB_BASE_FRAME()
     // Ensure m_canvasType is up to date, to save it in config
     m_canvasType = GetCanvas()->GetBackend();
 
+    // The tools outlive the board, so don't leave them holding it
+    if( m_toolManager )
+    {
+        m_toolManager->SetEnvironment( nullptr, GetCanvas()->GetView(),
+                                       GetCanvas()->GetViewControls(), config(), this );
+    }
+
     delete m_pcb;
 }
 
@@ -136,26 +136,21 @@ static void existsOnLayerFunc( LIBEVAL::CONTEXT* aCtx, void *self )
                      */
 
                     BOARD* board = item->GetBoard();
-                    std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-                    auto i = board->m_LayerExpressionCache.find( layerName );
-                    LSET mask;
+                    LSET   mask = board->m_LayerExpressionCache.GetOrCompute( layerName,
+                            [&]()
+                            {
+                                LSET layers;
 
-                    if( i == board->m_LayerExpressionCache.end() )
-                    {
-                        for( unsigned ii = 0; ii < layerMap.GetCount(); ++ii )
-                        {
-                            wxPGChoiceEntry& entry = layerMap[ ii ];
+                                for( unsigned ii = 0; ii < layerMap.GetCount(); ++ii )
+                                {
+                                    wxPGChoiceEntry& entry = layerMap[ ii ];
 
-                            if( entry.GetText().Matches( layerName ) )
-                                mask.set( ToLAYER_ID( entry.GetValue() ) );
-                        }
+                                    if( entry.GetText().Matches( layerName ) )
+                                        layers.set( ToLAYER_ID( entry.GetValue() ) );
+                                }
 
-                        board->m_LayerExpressionCache[ layerName ] = mask;
-                    }
-                    else
-                    {
-                        mask = i->second;
-                    }
+                                return layers;
+                            } );
 
                     if( ( item->GetLayerSet() & mask ).any() )
                         return 1.0;
@@ -272,19 +267,16 @@ static void intersectsCourtyardFunc( LIBEVAL::CONTEXT* aCtx, void* self )
                 if( searchFootprints( board, arg->AsString(), context,
                         [&]( FOOTPRINT* fp )
                         {
-                            PTR_PTR_CACHE_KEY            key = { fp, item };
-                            std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-
-                            auto i = board->m_IntersectsCourtyardCache.find( key );
-
-                            if( i != board->m_IntersectsCourtyardCache.end() )
-                                return i->second;
-
-                            bool res = collidesWithCourtyard( item, itemShape, context, fp, F_Cu )
-                                    || collidesWithCourtyard( item, itemShape, context, fp, B_Cu );
-
-                            board->m_IntersectsCourtyardCache[ key ] = res;
-                            return res;
+                            PTR_PTR_CACHE_KEY key = { fp, item };
+
+                            return board->m_IntersectsCourtyardCache.GetOrCompute( key,
+                                    [&]()
+                                    {
+                                        return collidesWithCourtyard( item, itemShape, context,
+                                                                      fp, F_Cu )
+                                                || collidesWithCourtyard( item, itemShape, context,
+                                                                          fp, B_Cu );
+                                    } );
                         } ) )
                 {
                     return 1.0;
@@ -327,18 +319,14 @@ static void intersectsFrontCourtyardFunc( LIBEVAL::CONTEXT* aCtx, void* self )
                 if( searchFootprints( board, arg->AsString(), context,
                         [&]( FOOTPRINT* fp )
                         {
-                            PTR_PTR_CACHE_KEY            key = { fp, item };
-                            std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-
-                            auto i = board->m_IntersectsFCourtyardCache.find( key );
-
-                            if( i != board->m_IntersectsFCourtyardCache.end() )
-                                return i->second;
-
-                            bool res = collidesWithCourtyard( item, itemShape, context, fp, F_Cu );
-
-                            board->m_IntersectsFCourtyardCache[ key ] = res;
-                            return res;
+                            PTR_PTR_CACHE_KEY key = { fp, item };
+
+                            return board->m_IntersectsFCourtyardCache.GetOrCompute( key,
+                                    [&]()
+                                    {
+                                        return collidesWithCourtyard( item, itemShape, context,
+                                                                      fp, F_Cu );
+                                    } );
                         } ) )
                 {
                     return 1.0;
@@ -381,18 +369,14 @@ static void intersectsBackCourtyardFunc( LIBEVAL::CONTEXT* aCtx, void* self )
                 if( searchFootprints( board, arg->AsString(), context,
                         [&]( FOOTPRINT* fp )
                         {
-                            PTR_PTR_CACHE_KEY            key = { fp, item };
-                            std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-
-                            auto i = board->m_IntersectsBCourtyardCache.find( key );
-
-                            if( i != board->m_IntersectsBCourtyardCache.end() )
-                                return i->second;
-
-                            bool res = collidesWithCourtyard( item, itemShape, context, fp, B_Cu );
-
-                            board->m_IntersectsBCourtyardCache[ key ] = res;
-                            return res;
+                            PTR_PTR_CACHE_KEY key = { fp, item };
+
+                            return board->m_IntersectsBCourtyardCache.GetOrCompute( key,
+                                    [&]()
+                                    {
+                                        return collidesWithCourtyard( item, itemShape, context,
+                                                                      fp, B_Cu );
+                                    } );
                         } ) )
                 {
                     return 1.0;
@@ -632,19 +616,13 @@ static void intersectsAreaFunc( LIBEVAL::CONTEXT* aCtx, void* self )
                             if( !aArea->GetBoundingBox().Intersects( itemBBox ) )
                                 return false;
 
-                            std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-                            PTR_PTR_LAYER_CACHE_KEY      key = { aArea, item, layer };
-
-                            auto i = board->m_IntersectsAreaCache.find( key );
-
-                            if( i != board->m_IntersectsAreaCache.end() )
-                                return i->second;
-
-                            bool collides = collidesWithArea( item, context, aArea );
+                            PTR_PTR_LAYER_CACHE_KEY key = { aArea, item, layer };
 
-                            board->m_IntersectsAreaCache[ key ] = collides;
-
-                            return collides;
+                            return board->m_IntersectsAreaCache.GetOrCompute( key,
+                                    [&]()
+                                    {
+                                        return collidesWithArea( item, context, aArea );
+                                    } );
                         } ) )
                 {
                     return 1.0;
@@ -695,13 +673,11 @@ static void enclosedByAreaFunc( LIBEVAL::CONTEXT* aCtx, void* self )
                             if( !aArea->GetBoundingBox().Intersects( itemBBox ) )
                                 return false;
 
-                            std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-                            PTR_PTR_LAYER_CACHE_KEY      key = { aArea, item, layer };
-
-                            auto i = board->m_EnclosedByAreaCache.find( key );
+                            PTR_PTR_LAYER_CACHE_KEY key = { aArea, item, layer };
+                            bool                    cached;
 
-                            if( i != board->m_EnclosedByAreaCache.end() )
-                                return i->second;
+                            if( board->m_EnclosedByAreaCache.Find( key, cached ) )
+                                return cached;
 
                             SHAPE_POLY_SET itemShape;
                             bool           enclosedByArea;
@@ -722,7 +698,7 @@ static void enclosedByAreaFunc( LIBEVAL::CONTEXT* aCtx, void* self )
                                 enclosedByArea = itemShape.IsEmpty();
                             }
 
-                            board->m_EnclosedByAreaCache[ key ] = enclosedByArea;
+                            board->m_EnclosedByAreaCache.Set( key, enclosedByArea );
 
                             return enclosedByArea;
                         } ) )
@@ -1002,29 +978,24 @@ public:
         // in the ENUM_MAP: one for the canonical layer name and one for the user layer name.
         // We need to check against both.
 
-        wxPGChoices&                 layerMap = ENUM_MAP<PCB_LAYER_ID>::Instance().Choices();
-        const wxString&              layerName = b->AsString();
-        BOARD*                       board = static_cast<PCB_EXPR_CONTEXT*>( aCtx )->GetBoard();
-        std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-        auto                         i = board->m_LayerExpressionCache.find( layerName );
-        LSET                         mask;
+        wxPGChoices&    layerMap = ENUM_MAP<PCB_LAYER_ID>::Instance().Choices();
+        const wxString& layerName = b->AsString();
+        BOARD*          board = static_cast<PCB_EXPR_CONTEXT*>( aCtx )->GetBoard();
+        LSET            mask = board->m_LayerExpressionCache.GetOrCompute( layerName,
+                [&]()
+                {
+                    LSET layers;
 
-        if( i == board->m_LayerExpressionCache.end() )
-        {
-            for( unsigned ii = 0; ii < layerMap.GetCount(); ++ii )
-            {
-                wxPGChoiceEntry& entry = layerMap[ii];
+                    for( unsigned ii = 0; ii < layerMap.GetCount(); ++ii )
+                    {
+                        wxPGChoiceEntry& entry = layerMap[ii];
 
-                if( entry.GetText().Matches( layerName ) )
-                    mask.set( ToLAYER_ID( entry.GetValue() ) );
-            }
+                        if( entry.GetText().Matches( layerName ) )
+                            layers.set( ToLAYER_ID( entry.GetValue() ) );
+                    }
 
-            board->m_LayerExpressionCache[ layerName ] = mask;
-        }
-        else
-        {
-            mask = i->second;
-        }
+                    return layers;
+                } );
 
         return mask.Contains( m_layer );
     }
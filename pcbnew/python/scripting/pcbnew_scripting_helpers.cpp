@@ -553,8 +553,24 @@ bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
         fprintf( fp, "%s", TO_UTF8( item->ShowReport( &unitsProvider, severity, itemMap ) ) );
     }
 
+    fprintf( fp, "\n** DRC provider statistics **\n" );
+    fprintf( fp, "%s", TO_UTF8( engine->FormatProviderStats() ) );
+
     fprintf( fp, "\n** End of Report **\n" );
     fclose( fp );
 
     return true;
 }
+
+
+std::vector<DRC_PROVIDER_STATS> GetDRCProviderStats( BOARD* aBoard )
+{
+    wxCHECK( aBoard, std::vector<DRC_PROVIDER_STATS>() );
+
+    std::shared_ptr<DRC_ENGINE> engine = aBoard->GetDesignSettings().m_DRCEngine;
+
+    if( !engine )
+        return std::vector<DRC_PROVIDER_STATS>();
+
+    return engine->GetProviderStats();
+}
@@ -27,6 +27,9 @@
 
 #include <pcb_edit_frame.h>
 #include <io_mgr.h>
+#include <drc/drc_provider_stats.h>
+
+#include <vector>
 
 /* we could be including all these methods as static in a class, but
  * we want plain pcbnew.<method_name> access from python
@@ -187,4 +190,13 @@ bool IsActionRunning();
 bool WriteDRCReport( BOARD* aBoard, const wxString& aFileName, EDA_UNITS aUnits,
                      bool aReportAllTrackErrors );
 
+/**
+ * Get the timings and counts for each DRC test provider from the last DRC run on the board
+ * (for instance by WriteDRCReport()).
+ *
+ * @param aBoard is a valid loaded board.
+ * @return one entry per provider, in the order they ran; empty if DRC hasn't been run.
+ */
+std::vector<DRC_PROVIDER_STATS> GetDRCProviderStats( BOARD* aBoard );
+
 #endif      // __PCBNEW_SCRIPTING_HELPERS_H
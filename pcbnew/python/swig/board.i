@@ -79,6 +79,7 @@ HANDLE_EXCEPTIONS(BOARD::TracksInNetBetweenPoints)
 %ignore BOARD::m_IntersectsAreaCache;
 %ignore BOARD::m_EnclosedByAreaCache;
 %ignore BOARD::m_LayerExpressionCache;
+%ignore BOARD::m_ZoneBBoxCache;
 %ignore BOARD::m_CopperZoneRTreeCache;
 %ignore BOARD::m_CopperItemRTreeCache;
 %ignore BOARD::m_DRCZones;
@@ -124,6 +124,9 @@ HANDLE_EXCEPTIONS(PLUGIN::FootprintDelete)
 %include <gal/color4d.h>
 %include <id.h>
 
+%include <drc/drc_provider_stats.h>
+%template(VECTOR_DRC_PROVIDER_STATS) std::vector<DRC_PROVIDER_STATS>;
+
 HANDLE_EXCEPTIONS(LoadBoard)
 HANDLE_EXCEPTIONS(WriteDRCReport)
 %include <pcbnew_scripting_helpers.h>
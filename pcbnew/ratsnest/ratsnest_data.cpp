@@ -41,6 +41,8 @@ using namespace std::placeholders;
 #include <algorithm>
 #include <cassert>
 #include <limits>
+#include <tuple>
+#include <unordered_map>
 
 #include <delaunator.hpp>
 
@@ -328,7 +330,198 @@ void RN_NET::compute()
 }
 
 
-void RN_NET::optimizeRNEdges()
+bool RN_NET::repairMST( size_t& aFirstNew )
+{
+    // Only worth it when a handful of anchors need looking at; beyond that triangulating the
+    // whole net is cheaper.
+    constexpr size_t MAX_CHANGED_ANCHORS = 64;
+
+    if( m_mstClusters.empty() || m_nodes.size() <= 2 )
+        return false;
+
+    std::unordered_map<const CN_CLUSTER*, int> clusterIndex;
+
+    for( size_t ii = 0; ii < m_clusters.size(); ++ii )
+        clusterIndex[ m_clusters[ii].get() ] = (int) ii;
+
+    auto indexOf =
+            [&]( const std::shared_ptr<CN_ANCHOR>& aAnchor )
+            {
+                auto it = clusterIndex.find( aAnchor->GetCluster().get() );
+                return it == clusterIndex.end() ? -1 : it->second;
+            };
+
+    // A cluster is only ever reused when its items (and so its anchors) are unchanged.
+    // Anything else is new.
+    std::vector<char> isNew( m_clusters.size(), 1 );
+    bool              anyKept = false;
+
+    for( const std::shared_ptr<CN_CLUSTER>& cluster : m_mstClusters )
+    {
+        auto it = clusterIndex.find( cluster.get() );
+
+        if( it != clusterIndex.end() )
+        {
+            isNew[ it->second ] = 0;
+            anyKept = true;
+        }
+    }
+
+    if( !anyKept )
+        return false;
+
+    struct CANDIDATE
+    {
+        int      m_clusterA;
+        int      m_clusterB;
+        unsigned m_weight;
+        int      m_cached;      ///< Index in m_mstEdges, or -1 for a new edge
+        int      m_nodeA;       ///< Indices in nodes, for new edges
+        int      m_nodeB;
+    };
+
+    std::vector<CANDIDATE> candidates;
+    disjoint_set           groups( m_clusters.size() );
+
+    // The old tree's edges between unchanged clusters stay in the tree of the unchanged
+    // clusters.  The components they leave are the groups which need reconnecting.
+    for( size_t ii = 0; ii < m_mstEdges.size(); ++ii )
+    {
+        const std::shared_ptr<CN_ANCHOR>& source = m_mstEdges[ii].GetSourceNode();
+        const std::shared_ptr<CN_ANCHOR>& target = m_mstEdges[ii].GetTargetNode();
+        int                               a = indexOf( source );
+        int                               b = indexOf( target );
+
+        if( a < 0 || b < 0 || isNew[a] || isNew[b] )
+            continue;
+
+        groups.unite( a, b );
+        candidates.push_back( { a, b, std::max( 1u, source->Dist( *target ) ), (int) ii, -1,
+                                -1 } );
+    }
+
+    std::vector<const std::shared_ptr<CN_ANCHOR>*> nodes;
+    std::vector<int>                               nodeCluster;
+    std::vector<int>                               clusterGroup( m_clusters.size() );
+    std::vector<size_t>                            groupSize( m_clusters.size(), 0 );
+
+    nodes.reserve( m_nodes.size() );
+    nodeCluster.reserve( m_nodes.size() );
+
+    for( size_t ii = 0; ii < m_clusters.size(); ++ii )
+        clusterGroup[ii] = groups.find( ii );
+
+    for( const std::shared_ptr<CN_ANCHOR>& node : m_nodes )
+    {
+        int cluster = indexOf( node );
+
+        assert( cluster >= 0 );
+
+        nodes.push_back( &node );
+        nodeCluster.push_back( cluster );
+        groupSize[ clusterGroup[cluster] ]++;
+    }
+
+    // Everything outside the largest group has to be reconnected
+    int base = std::max_element( groupSize.begin(), groupSize.end() ) - groupSize.begin();
+    std::vector<int> changed;
+
+    for( size_t ii = 0; ii < nodes.size(); ++ii )
+    {
+        if( clusterGroup[ nodeCluster[ii] ] != base )
+            changed.push_back( ii );
+    }
+
+    if( changed.size() > std::min( MAX_CHANGED_ANCHORS, m_nodes.size() / 4 ) )
+        return false;
+
+    // Shortest links from the changed anchors.  A new cluster may end up linked to several
+    // clusters of the same group, so its links are kept per cluster; between unchanged groups
+    // only the shortest link can be part of the tree.
+    std::unordered_map<uint64_t, CANDIDATE> shortest;
+
+    for( int ii : changed )
+    {
+        int                               ci = nodeCluster[ii];
+        int                               gi = clusterGroup[ci];
+        const std::shared_ptr<CN_ANCHOR>& nodeA = *nodes[ii];
+
+        for( size_t jj = 0; jj < nodes.size(); ++jj )
+        {
+            int cj = nodeCluster[jj];
+            int gj = clusterGroup[cj];
+            int a, b;
+
+            if( isNew[ci] || isNew[cj] )
+            {
+                if( ci == cj )
+                    continue;
+
+                std::tie( a, b ) = std::minmax( ci, cj );
+            }
+            else
+            {
+                if( gi == gj )
+                    continue;
+
+                std::tie( a, b ) = std::minmax( gi, gj );
+            }
+
+            uint64_t key = ( (uint64_t) a << 32 ) | (uint32_t) b;
+            unsigned weight = std::max( 1u, nodeA->Dist( **nodes[jj] ) );
+            auto     it = shortest.find( key );
+
+            if( it == shortest.end() )
+                shortest.emplace( key, CANDIDATE{ ci, cj, weight, -1, ii, (int) jj } );
+            else if( weight < it->second.m_weight )
+                it->second = CANDIDATE{ ci, cj, weight, -1, ii, (int) jj };
+        }
+    }
+
+    for( const std::pair<const uint64_t, CANDIDATE>& entry : shortest )
+        candidates.push_back( entry.second );
+
+    std::sort( candidates.begin(), candidates.end(),
+               []( const CANDIDATE& a, const CANDIDATE& b )
+               {
+                   return a.m_weight < b.m_weight;
+               } );
+
+    disjoint_set         dset( m_clusters.size() );
+    std::vector<CN_EDGE> mstEdges;
+    std::vector<CN_EDGE> newEdges;
+
+    m_rnEdges.clear();
+
+    // The reused edges go first as they are already optimized
+    for( const CANDIDATE& candidate : candidates )
+    {
+        if( !dset.unite( candidate.m_clusterA, candidate.m_clusterB ) )
+            continue;
+
+        if( candidate.m_cached >= 0 )
+        {
+            mstEdges.push_back( m_mstEdges[ candidate.m_cached ] );
+            m_rnEdges.push_back( m_mstOptimizedEdges[ candidate.m_cached ] );
+        }
+        else
+        {
+            newEdges.emplace_back( *nodes[ candidate.m_nodeA ], *nodes[ candidate.m_nodeB ],
+                                   candidate.m_weight );
+        }
+    }
+
+    aFirstNew = m_rnEdges.size();
+
+    m_rnEdges.insert( m_rnEdges.end(), newEdges.begin(), newEdges.end() );
+    mstEdges.insert( mstEdges.end(), newEdges.begin(), newEdges.end() );
+    m_mstEdges = std::move( mstEdges );
+
+    return true;
+}
+
+
+void RN_NET::optimizeRNEdges( size_t aFirstEdge )
 {
     auto findZoneAnchor =
             [&]( const VECTOR2I& aPos, const LSET& aLayerSet,
@@ -412,8 +605,9 @@ void RN_NET::optimizeRNEdges()
                 }
             };
 
-    for( CN_EDGE& edge : m_rnEdges )
+    for( size_t ii = aFirstEdge; ii < m_rnEdges.size(); ++ii )
     {
+        CN_EDGE&                   edge = m_rnEdges[ii];
         std::shared_ptr<CN_ANCHOR> source = edge.GetSourceNode();
         std::shared_ptr<CN_ANCHOR> target = edge.GetTargetNode();
 
@@ -439,16 +633,27 @@ void RN_NET::optimizeRNEdges()
 
 void RN_NET::Update()
 {
-    compute();
+    size_t firstNew = 0;
+
+    if( !repairMST( firstNew ) )
+    {
+        compute();
+
+        firstNew = 0;
+        m_mstEdges = m_rnEdges;
+    }
 
 #ifdef PROFILE
     PROF_TIMER cnt( "optimize" );
 #endif
-    optimizeRNEdges();
+    optimizeRNEdges( firstNew );
 #ifdef PROFILE
     cnt.Show();
 #endif
 
+    m_mstOptimizedEdges = m_rnEdges;
+    m_mstClusters = m_clusters;
+
     m_dirty = false;
 }
 
@@ -458,15 +663,26 @@ void RN_NET::Clear()
     m_rnEdges.clear();
     m_boardEdges.clear();
     m_nodes.clear();
+    m_clusters.clear();
 
     m_dirty = true;
 }
 
 
+void RN_NET::ClearMST()
+{
+    m_mstClusters.clear();
+    m_mstEdges.clear();
+    m_mstOptimizedEdges.clear();
+}
+
+
 void RN_NET::AddCluster( std::shared_ptr<CN_CLUSTER> aCluster )
 {
     std::shared_ptr<CN_ANCHOR> firstAnchor;
 
+    m_clusters.push_back( aCluster );
+
     for( CN_ITEM* item : *aCluster )
     {
         std::vector<std::shared_ptr<CN_ANCHOR>>& anchors = item->Anchors();
@@ -83,6 +83,12 @@ public:
     void Update();
     void Clear();
 
+    /**
+     * Forget the spanning tree of the last update, so that the next update starts from scratch.
+     * Its edges point into the anchors of zone items, which are replaced on a refill.
+     */
+    void ClearMST();
+
     void AddCluster( std::shared_ptr<CN_CLUSTER> aCluster );
 
     unsigned int GetNodeCount() const { return m_nodes.size(); }
@@ -99,9 +105,16 @@ protected:
     ///< Compute the minimum spanning tree using Kruskal's algorithm
     void kruskalMST( const std::vector<CN_EDGE> &aEdges );
 
+    ///< Rework the spanning tree of the last update around the clusters which have been
+    ///< replaced since, rather than triangulating the whole net again.  Returns false if too
+    ///< much has changed for that to pay off.  Edges from \a aFirstNew on are new and still
+    ///< need optimizing.
+    bool repairMST( size_t& aFirstNew );
+
     ///< Find optimal ends of RNEdges.  The MST will have found the closest anchors, but when
-    ///< zones are involved we might have points closer than the anchors.
-    void optimizeRNEdges();
+    ///< zones are involved we might have points closer than the anchors.  Edges before
+    ///< \a aFirstEdge have been optimized already.
+    void optimizeRNEdges( size_t aFirstEdge = 0 );
 
 protected:
     ///< Vector of nodes
@@ -110,6 +123,15 @@ protected:
     ///< Vector of edges that make pre-defined connections
     std::vector<CN_EDGE> m_boardEdges;
 
+    ///< Clusters making up the net
+    std::vector<std::shared_ptr<CN_CLUSTER>> m_clusters;
+
+    ///< The spanning tree of the last update (the clusters it spans, and its edges before and
+    ///< after optimizeRNEdges()).  Survives Clear() so that the next update can reuse it.
+    std::vector<std::shared_ptr<CN_CLUSTER>> m_mstClusters;
+    std::vector<CN_EDGE>                     m_mstEdges;
+    std::vector<CN_EDGE>                     m_mstOptimizedEdges;
+
     ///< Vector of edges that makes ratsnest for a given net.
     std::vector<CN_EDGE> m_rnEdges;
 
@@ -19,12 +19,39 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include "pns_index.h"
 #include "pns_router.h"
 
 namespace PNS {
 
 
+INDEX::INDEX( const INDEX& aOther ) :
+        m_subIndices( aOther.m_subIndices.size() ),
+        m_netMap( aOther.m_netMap ),
+        m_allItems( aOther.m_allItems )
+{
+    for( size_t i = 0; i < m_subIndices.size(); ++i )
+    {
+        const SUBINDEX& other = aOther.m_subIndices[i];
+        SUBINDEX&       sub = m_subIndices[i];
+
+        // The packed tree is just a few arrays; the dynamic one has to be rebuilt item by item
+        sub.m_packed = other.m_packed;
+        sub.m_recentCount = other.m_recentCount;
+
+        other.m_recent.Accept(
+                [&sub]( ITEM* aItem )
+                {
+                    sub.m_recent.Add( aItem );
+                } );
+    }
+
+    Pack();
+}
+
+
 void INDEX::Add( ITEM* aItem )
 {
     const LAYER_RANGE& range = aItem->Layers();
@@ -33,13 +60,21 @@ void INDEX::Add( ITEM* aItem )
         m_subIndices.resize( 2 * range.End() + 1 ); // +1 handles the 0 case
 
     for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i].Add( aItem );
+    {
+        m_subIndices[i].m_recent.Add( aItem );
+        m_subIndices[i].m_recentCount++;
+    }
 
     m_allItems.insert( aItem );
     int net = aItem->Net();
 
     if( net >= 0 )
+    {
+        if( m_netMap.size() <= static_cast<size_t>( net ) )
+            m_netMap.resize( net + 1 );
+
         m_netMap[net].push_back( aItem );
+    }
 }
 
 
@@ -47,17 +82,46 @@ void INDEX::Remove( ITEM* aItem )
 {
     const LAYER_RANGE& range = aItem->Layers();
 
-    if( m_subIndices.size() <= static_cast<size_t>( range.End() ) )
+    if( m_subIndices.size() <= static_cast<size_t>( range.End() ) || !Contains( aItem ) )
         return;
 
+    BOX2I box = boundingBox( aItem );
+    int   min[2] = { box.GetX(), box.GetY() };
+    int   max[2] = { box.GetRight(), box.GetBottom() };
+
     for( int i = range.Start(); i <= range.End(); ++i )
-        m_subIndices[i].Remove( aItem );
+    {
+        SUBINDEX& sub = m_subIndices[i];
+
+        if( sub.m_packed.Remove( min, max, aItem ) )
+            continue;
+
+        if( sub.m_recent.Remove( aItem ) )
+        {
+            wxASSERT( sub.m_recentCount > 0 );
+            sub.m_recentCount--;
+            continue;
+        }
+
+        // The item's box has changed since it was packed, so it has to be looked for
+        if( !sub.m_packed.Remove( aItem ) )
+            wxFAIL_MSG( wxT( "PNS::INDEX::Remove: item not found in its layer's index" ) );
+    }
 
     m_allItems.erase( aItem );
     int net = aItem->Net();
 
-    if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+    if( net >= 0 && static_cast<size_t>( net ) < m_netMap.size() )
+    {
+        NET_ITEMS_LIST& items = m_netMap[net];
+        auto            it = std::find( items.begin(), items.end(), aItem );
+
+        if( it != items.end() )
+        {
+            *it = items.back();
+            items.pop_back();
+        }
+    }
 }
 
 
@@ -68,9 +132,44 @@ void INDEX::Replace( ITEM* aOldItem, ITEM* aNewItem )
 }
 
 
+void INDEX::Pack()
+{
+    std::vector<ITEM_PACKED_INDEX::ENTRY> entries;
+
+    for( SUBINDEX& sub : m_subIndices )
+    {
+        // Packing sorts the whole layer, so leave small changes in the dynamic tree
+        size_t changes = sub.m_recentCount + sub.m_packed.RemovedCount();
+
+        if( changes <= std::max<size_t>( 32, sub.m_packed.Size() / 8 ) )
+            continue;
+
+        auto addEntry =
+                [&entries]( ITEM* aItem )
+                {
+                    BOX2I box = boundingBox( aItem );
+
+                    entries.push_back( { { box.GetX(), box.GetY() },
+                                         { box.GetRight(), box.GetBottom() },
+                                         aItem } );
+                };
+
+        entries.clear();
+        entries.reserve( sub.m_packed.Size() + sub.m_recentCount );
+
+        sub.m_packed.ForEach( addEntry );
+        sub.m_recent.Accept( addEntry );
+
+        sub.m_packed.Build( entries );
+        sub.m_recent.RemoveAll();
+        sub.m_recentCount = 0;
+    }
+}
+
+
 INDEX::NET_ITEMS_LIST* INDEX::GetItemsForNet( int aNet )
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
+    if( aNet < 0 || static_cast<size_t>( aNet ) >= m_netMap.size() || m_netMap[aNet].empty() )
         return nullptr;
 
     return &m_netMap[aNet];
@@ -23,11 +23,11 @@
 #define __PNS_INDEX_H
 
 #include <deque>
-#include <list>
-#include <map>
 #include <unordered_set>
+#include <vector>
 
 #include <layer_ids.h>
+#include <geometry/packed_rtree.h>
 #include <geometry/shape_index.h>
 
 #include "pns_item.h"
@@ -41,16 +41,28 @@ namespace PNS {
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * Each subindex is a packed (static) R-tree, which is quick to search and to copy, plus a
+ * dynamic R-tree holding the items added since it was last packed.  Pack() is meant to be
+ * called on the root node's index between routing operations, and on copies.
  **/
 class INDEX
 {
 public:
-    typedef std::list<ITEM*>            NET_ITEMS_LIST;
+    typedef std::vector<ITEM*>          NET_ITEMS_LIST;
     typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
+    typedef PACKED_RTREE<ITEM*>         ITEM_PACKED_INDEX;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
     INDEX(){};
 
+    /**
+     * Copies the index, packing the copy if that is worth it.
+     */
+    INDEX( const INDEX& aOther );
+
+    INDEX& operator=( const INDEX& ) = delete;
+
     /**
      * Adds item to the spatial index.
      */
@@ -66,6 +78,12 @@ public:
      */
     void Replace( ITEM* aOldItem, ITEM* aNewItem );
 
+    /**
+     * Repacks the subindices which have changed enough since they were last packed for it to
+     * be worth the cost.
+     */
+    void Pack();
+
     /**
      * Searches items in the index that are in proximity of aItem.
      * For each item, function object aVisitor is called. Only items on
@@ -95,7 +113,8 @@ public:
     int Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const;
 
     /**
-     * Returns list of all items in a given net.
+     * Returns list of all items in a given net (in no particular order), or nullptr if there
+     * are none.
      */
     NET_ITEMS_LIST* GetItemsForNet( int aNet );
 
@@ -118,12 +137,19 @@ public:
     ITEM_SET::iterator end() { return m_allItems.end(); }
 
 private:
+    struct SUBINDEX
+    {
+        ITEM_PACKED_INDEX m_packed;
+        ITEM_SHAPE_INDEX  m_recent;         ///< items added since the last Pack()
+        size_t            m_recentCount = 0;
+    };
+
     template <class Visitor>
     int querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor ) const;
 
 private:
-    std::deque<ITEM_SHAPE_INDEX>  m_subIndices;
-    std::map<int, NET_ITEMS_LIST> m_netMap;
+    std::deque<SUBINDEX>          m_subIndices;
+    std::vector<NET_ITEMS_LIST>   m_netMap;         ///< indexed by net code
     ITEM_SET                      m_allItems;
 };
 
@@ -134,7 +160,20 @@ int INDEX::querySingle( std::size_t aIndex, const SHAPE* aShape, int aMinDistanc
     if( aIndex >= m_subIndices.size() )
         return 0;
 
-    return m_subIndices[aIndex].Query( aShape, aMinDistance, aVisitor);
+    const SUBINDEX& sub = m_subIndices[aIndex];
+
+    BOX2I box = aShape->BBox();
+    box.Inflate( aMinDistance );
+
+    int min[2] = { box.GetX(),         box.GetY() };
+    int max[2] = { box.GetRight(),     box.GetBottom() };
+
+    int total = sub.m_packed.Search( min, max, aVisitor );
+
+    if( sub.m_recentCount )
+        total += sub.m_recent.Query( aShape, aMinDistance, aVisitor );
+
+    return total;
 }
 
 template<class Visitor>
@@ -51,6 +51,9 @@
 
 #include <memory>
 
+#include <concurrent_cache.h>
+#include <hash.h>
+
 #include <advanced_config.h>
 #include <pcbnew_settings.h>
 #include <macros.h>
@@ -71,15 +74,40 @@
 typedef VECTOR2I::extended_type ecoord;
 
 
+/**
+ * What a clearance between two items depends on.  An item made from a board item resolves the
+ * same as any other made from it on that layer (a shoved copy of a track, say).  One being
+ * routed has no board item; it stands in for a track or via with only a net and a layer, so
+ * those (and its kind) are all that tell it apart.  None of this goes stale as the router
+ * creates and destroys items, which pointers to the items themselves would.
+ */
 struct CLEARANCE_CACHE_KEY
 {
-    const PNS::ITEM*  A;
-    const PNS::ITEM*  B;
+    const BOARD_ITEM* ParentA;
+    const BOARD_ITEM* ParentB;
+    int               KindA;
+    int               KindB;    ///< 0 if there's no item B
+    int               NetA;
+    int               NetB;
+    int               Layer;
     bool              Flag;
 
-    bool operator==(const CLEARANCE_CACHE_KEY& other) const
+    CLEARANCE_CACHE_KEY( const PNS::ITEM* aA, const PNS::ITEM* aB, int aLayer, bool aFlag ) :
+            ParentA( aA->Parent() ),
+            ParentB( aB ? aB->Parent() : nullptr ),
+            KindA( aA->Kind() ),
+            KindB( aB ? aB->Kind() : 0 ),
+            NetA( aA->Net() ),
+            NetB( aB ? aB->Net() : 0 ),
+            Layer( aLayer ),
+            Flag( aFlag )
+    {}
+
+    bool operator==( const CLEARANCE_CACHE_KEY& other ) const
     {
-        return A == other.A && B == other.B && Flag == other.Flag;
+        return ParentA == other.ParentA && ParentB == other.ParentB && KindA == other.KindA
+               && KindB == other.KindB && NetA == other.NetA && NetB == other.NetB
+               && Layer == other.Layer && Flag == other.Flag;
     }
 };
 
@@ -90,7 +118,12 @@ namespace std
     {
         std::size_t operator()( const CLEARANCE_CACHE_KEY& k ) const
         {
-            return hash<const void*>()( k.A ) ^ hash<const void*>()( k.B ) ^ hash<int>()( k.Flag );
+            std::size_t seed = 0;
+
+            hash_combine( seed, k.ParentA, k.ParentB, k.KindA, k.KindB, k.NetA, k.NetB, k.Layer,
+                          k.Flag );
+
+            return seed;
         }
     };
 }
@@ -125,11 +158,23 @@ public:
 
     int ClearanceEpsilon() const { return m_clearanceEpsilon; }
 
-    void ClearCacheForItem( const PNS::ITEM* aItem ) override;
+    BOARD* GetBoard() const { return m_board; }
+
+    /**
+     * Drop the memoized clearances if \a aItemsChanged (they are keyed on board items, whose
+     * addresses can be reused once they're deleted), or if the DRC engine has dropped the rule
+     * resolution they came from.
+     */
+    void SyncCaches( bool aItemsChanged );
 
 private:
     int holeRadius( const PNS::ITEM* aItem ) const;
 
+    /**
+     * @return the layer to resolve the clearance between \a aA and \a aB on.
+     */
+    static int clearanceLayer( const PNS::ITEM* aA, const PNS::ITEM* aB );
+
     /**
      * Checks for netnamed differential pairs.
      * This accepts nets named suffixed by 'P', 'N', '+', '-', as well as additional
@@ -149,9 +194,10 @@ private:
     PCB_VIA            m_dummyVias[2];
     int                m_clearanceEpsilon;
 
-    std::unordered_map<CLEARANCE_CACHE_KEY, int> m_clearanceCache;
-    std::unordered_map<CLEARANCE_CACHE_KEY, int> m_holeClearanceCache;
-    std::unordered_map<CLEARANCE_CACHE_KEY, int> m_holeToHoleClearanceCache;
+    CONCURRENT_CACHE<CLEARANCE_CACHE_KEY, int> m_clearanceCache;
+    CONCURRENT_CACHE<CLEARANCE_CACHE_KEY, int> m_holeClearanceCache;
+    CONCURRENT_CACHE<CLEARANCE_CACHE_KEY, int> m_holeToHoleClearanceCache;
+    unsigned                                   m_cacheGeneration;
 };
 
 
@@ -161,7 +207,8 @@ PNS_PCBNEW_RULE_RESOLVER::PNS_PCBNEW_RULE_RESOLVER( BOARD* aBoard,
     m_board( aBoard ),
     m_dummyTracks{ { aBoard }, { aBoard } },
     m_dummyArcs{ { aBoard }, { aBoard } },
-    m_dummyVias{ { aBoard }, { aBoard } }
+    m_dummyVias{ { aBoard }, { aBoard } },
+    m_cacheGeneration( 0 )
 {
     if( aBoard )
         m_clearanceEpsilon = aBoard->GetDesignSettings().GetDRCEpsilon();
@@ -175,6 +222,30 @@ PNS_PCBNEW_RULE_RESOLVER::~PNS_PCBNEW_RULE_RESOLVER()
 }
 
 
+void PNS_PCBNEW_RULE_RESOLVER::SyncCaches( bool aItemsChanged )
+{
+    std::shared_ptr<DRC_ENGINE> drcEngine;
+    unsigned                    generation = 0;
+
+    if( m_board )
+    {
+        m_clearanceEpsilon = m_board->GetDesignSettings().GetDRCEpsilon();
+        drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+    }
+
+    if( drcEngine )
+        generation = drcEngine->GetConstraintCacheGeneration();
+
+    if( aItemsChanged || generation != m_cacheGeneration )
+    {
+        m_clearanceCache.Clear();
+        m_holeClearanceCache.Clear();
+        m_holeToHoleClearanceCache.Clear();
+        m_cacheGeneration = generation;
+    }
+}
+
+
 int PNS_PCBNEW_RULE_RESOLVER::holeRadius( const PNS::ITEM* aItem ) const
 {
     if( aItem->Kind() == PNS::ITEM::SOLID_T )
@@ -365,33 +436,27 @@ bool PNS_PCBNEW_RULE_RESOLVER::QueryConstraint( PNS::CONSTRAINT_TYPE aType,
 }
 
 
-void PNS_PCBNEW_RULE_RESOLVER::ClearCacheForItem( const PNS::ITEM* aItem )
+int PNS_PCBNEW_RULE_RESOLVER::clearanceLayer( const PNS::ITEM* aA, const PNS::ITEM* aB )
 {
-    CLEARANCE_CACHE_KEY key = { aItem, nullptr, false };
-    m_clearanceCache.erase( key );
+    if( !aA->Layers().IsMultilayer() || !aB || aB->Layers().IsMultilayer() )
+        return aA->Layer();
 
-    key.Flag = true;
-    m_clearanceCache.erase( key );
+    return aB->Layer();
 }
 
 
 int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* aB,
                                          bool aUseClearanceEpsilon )
 {
-    CLEARANCE_CACHE_KEY key = { aA, aB, aUseClearanceEpsilon };
-    auto it = m_clearanceCache.find( key );
+    int                 layer = clearanceLayer( aA, aB );
+    CLEARANCE_CACHE_KEY key( aA, aB, layer, aUseClearanceEpsilon );
+    int                 rv;
 
-    if( it != m_clearanceCache.end() )
-        return it->second;
+    if( m_clearanceCache.Find( key, rv ) )
+        return rv;
 
     PNS::CONSTRAINT constraint;
-    int rv = 0;
-    int layer;
-
-    if( !aA->Layers().IsMultilayer() || !aB || aB->Layers().IsMultilayer() )
-        layer = aA->Layer();
-    else
-        layer = aB->Layer();
+    rv = 0;
 
     if( isCopper( aA ) && ( !aB || isCopper( aB ) ) )
     {
@@ -411,7 +476,7 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
     if( aUseClearanceEpsilon )
         rv -= m_clearanceEpsilon;
 
-    m_clearanceCache[ key ] = rv;
+    m_clearanceCache.Set( key, rv );
     return rv;
 }
 
@@ -419,20 +484,15 @@ int PNS_PCBNEW_RULE_RESOLVER::Clearance( const PNS::ITEM* aA, const PNS::ITEM* a
 int PNS_PCBNEW_RULE_RESOLVER::HoleClearance( const PNS::ITEM* aA, const PNS::ITEM* aB,
                                              bool aUseClearanceEpsilon )
 {
-    CLEARANCE_CACHE_KEY key = { aA, aB, aUseClearanceEpsilon };
-    auto it = m_holeClearanceCache.find( key );
+    int                 layer = clearanceLayer( aA, aB );
+    CLEARANCE_CACHE_KEY key( aA, aB, layer, aUseClearanceEpsilon );
+    int                 rv;
 
-    if( it != m_holeClearanceCache.end() )
-        return it->second;
+    if( m_holeClearanceCache.Find( key, rv ) )
+        return rv;
 
     PNS::CONSTRAINT constraint;
-    int rv = 0;
-    int layer;
-
-    if( !aA->Layers().IsMultilayer() || !aB || aB->Layers().IsMultilayer() )
-        layer = aA->Layer();
-    else
-        layer = aB->Layer();
+    rv = 0;
 
     if( QueryConstraint( PNS::CONSTRAINT_TYPE::CT_HOLE_CLEARANCE, aA, aB, layer, &constraint ) )
         rv = constraint.m_Value.Min();
@@ -440,7 +500,7 @@ int PNS_PCBNEW_RULE_RESOLVER::HoleClearance( const PNS::ITEM* aA, const PNS::ITE
     if( aUseClearanceEpsilon )
         rv -= m_clearanceEpsilon;
 
-    m_holeClearanceCache[ key ] = rv;
+    m_holeClearanceCache.Set( key, rv );
     return rv;
 }
 
@@ -448,20 +508,15 @@ int PNS_PCBNEW_RULE_RESOLVER::HoleClearance( const PNS::ITEM* aA, const PNS::ITE
 int PNS_PCBNEW_RULE_RESOLVER::HoleToHoleClearance( const PNS::ITEM* aA, const PNS::ITEM* aB,
                                                    bool aUseClearanceEpsilon )
 {
-    CLEARANCE_CACHE_KEY key = { aA, aB, aUseClearanceEpsilon };
-    auto it = m_holeToHoleClearanceCache.find( key );
+    int                 layer = clearanceLayer( aA, aB );
+    CLEARANCE_CACHE_KEY key( aA, aB, layer, aUseClearanceEpsilon );
+    int                 rv;
 
-    if( it != m_holeToHoleClearanceCache.end() )
-        return it->second;
+    if( m_holeToHoleClearanceCache.Find( key, rv ) )
+        return rv;
 
     PNS::CONSTRAINT constraint;
-    int rv = 0;
-    int layer;
-
-    if( !aA->Layers().IsMultilayer() || !aB || aB->Layers().IsMultilayer() )
-        layer = aA->Layer();
-    else
-        layer = aB->Layer();
+    rv = 0;
 
     if( QueryConstraint( PNS::CONSTRAINT_TYPE::CT_HOLE_TO_HOLE, aA, aB, layer, &constraint ) )
         rv = constraint.m_Value.Min();
@@ -469,7 +524,7 @@ int PNS_PCBNEW_RULE_RESOLVER::HoleToHoleClearance( const PNS::ITEM* aA, const PN
     if( aUseClearanceEpsilon )
         rv -= m_clearanceEpsilon;
 
-    m_holeToHoleClearanceCache[ key ] = rv;
+    m_holeToHoleClearanceCache.Set( key, rv );
     return rv;
 }
 
@@ -886,6 +941,7 @@ PNS_KICAD_IFACE_BASE::PNS_KICAD_IFACE_BASE()
     m_world = nullptr;
     m_debugDecorator = nullptr;
     m_startLayer = -1;
+    m_needsFullSync = true;
 }
 
 
@@ -900,12 +956,12 @@ PNS_KICAD_IFACE::PNS_KICAD_IFACE()
 
 PNS_KICAD_IFACE_BASE::~PNS_KICAD_IFACE_BASE()
 {
+    delete m_ruleResolver;
 }
 
 
 PNS_KICAD_IFACE::~PNS_KICAD_IFACE()
 {
-    delete m_ruleResolver;
     delete m_debugDecorator;
 
      if( m_previewItems )
@@ -1231,8 +1287,17 @@ bool PNS_KICAD_IFACE_BASE::syncGraphicalItem( PNS::NODE* aWorld, PCB_SHAPE* aIte
 
 void PNS_KICAD_IFACE_BASE::SetBoard( BOARD* aBoard )
 {
+    if( m_board )
+        m_board->RemoveListener( this );
+
     m_board = aBoard;
     wxLogTrace( wxT( "PNS" ), wxT( "m_board = %p" ), m_board );
+
+    if( m_board )
+        m_board->AddListener( this );
+
+    clearChanges();
+    m_needsFullSync = true;
 }
 
 
@@ -1315,48 +1380,105 @@ bool PNS_KICAD_IFACE::IsItemVisible( const PNS::ITEM* aItem ) const
 }
 
 
-void PNS_KICAD_IFACE_BASE::SyncWorld( PNS::NODE *aWorld )
+void PNS_KICAD_IFACE_BASE::syncFootprint( PNS::NODE* aWorld, FOOTPRINT* aFootprint,
+                                          SHAPE_POLY_SET* aBoardOutline )
 {
-    if( !m_board )
+    std::vector<const BOARD_ITEM*>& children = m_footprintChildren[ aFootprint ];
+
+    children.clear();
+
+    for( PAD* pad : aFootprint->Pads() )
     {
-        wxLogTrace( wxT( "PNS" ), wxT( "No board attached, aborting sync." ) );
-        return;
+        if( std::unique_ptr<PNS::SOLID> solid = syncPad( pad ) )
+            aWorld->Add( std::move( solid ) );
+
+        children.push_back( pad );
     }
 
-    int worstClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+    syncTextItem( aWorld, &aFootprint->Reference(), aFootprint->Reference().GetLayer() );
+    syncTextItem( aWorld, &aFootprint->Value(), aFootprint->Value().GetLayer() );
 
-    m_world = aWorld;
+    children.push_back( &aFootprint->Reference() );
+    children.push_back( &aFootprint->Value() );
 
-    for( BOARD_ITEM* gitem : m_board->Drawings() )
+    for( FP_ZONE* zone : aFootprint->Zones() )
     {
-        if ( gitem->Type() == PCB_SHAPE_T || gitem->Type() == PCB_TEXTBOX_T )
+        syncZone( aWorld, zone, aBoardOutline );
+        children.push_back( zone );
+    }
+
+    for( BOARD_ITEM* mgitem : aFootprint->GraphicalItems() )
+    {
+        if( mgitem->Type() == PCB_FP_SHAPE_T || mgitem->Type() == PCB_FP_TEXTBOX_T )
         {
-            syncGraphicalItem( aWorld, static_cast<PCB_SHAPE*>( gitem ) );
+            syncGraphicalItem( aWorld, static_cast<PCB_SHAPE*>( mgitem ) );
         }
-        else if( gitem->Type() == PCB_TEXT_T )
+        else if( mgitem->Type() == PCB_FP_TEXT_T )
         {
-            syncTextItem( aWorld, static_cast<PCB_TEXT*>( gitem ), gitem->GetLayer() );
+            syncTextItem( aWorld, static_cast<FP_TEXT*>( mgitem ), mgitem->GetLayer() );
         }
+
+        children.push_back( mgitem );
     }
+}
 
-    SHAPE_POLY_SET  buffer;
-    SHAPE_POLY_SET* boardOutline = nullptr;
 
-    if( m_board->GetBoardPolygonOutlines( buffer ) )
-        boardOutline = &buffer;
-
-    for( ZONE* zone : m_board->Zones() )
+void PNS_KICAD_IFACE_BASE::syncBoardItem( PNS::NODE* aWorld, BOARD_ITEM* aItem,
+                                          SHAPE_POLY_SET* aBoardOutline )
+{
+    switch( aItem->Type() )
     {
-        syncZone( aWorld, zone, boardOutline );
+    case PCB_SHAPE_T:
+    case PCB_TEXTBOX_T:
+        syncGraphicalItem( aWorld, static_cast<PCB_SHAPE*>( aItem ) );
+        break;
+
+    case PCB_TEXT_T:
+        syncTextItem( aWorld, static_cast<PCB_TEXT*>( aItem ), aItem->GetLayer() );
+        break;
+
+    case PCB_ZONE_T:
+        syncZone( aWorld, static_cast<ZONE*>( aItem ), aBoardOutline );
+        break;
+
+    case PCB_FOOTPRINT_T:
+        syncFootprint( aWorld, static_cast<FOOTPRINT*>( aItem ), aBoardOutline );
+        break;
+
+    case PCB_TRACE_T:
+        if( std::unique_ptr<PNS::SEGMENT> segment = syncTrack( static_cast<PCB_TRACK*>( aItem ) ) )
+            aWorld->Add( std::move( segment ) );
+
+        break;
+
+    case PCB_ARC_T:
+        if( std::unique_ptr<PNS::ARC> arc = syncArc( static_cast<PCB_ARC*>( aItem ) ) )
+            aWorld->Add( std::move( arc ) );
+
+        break;
+
+    case PCB_VIA_T:
+        if( std::unique_ptr<PNS::VIA> via = syncVia( static_cast<PCB_VIA*>( aItem ) ) )
+            aWorld->Add( std::move( via ) );
+
+        break;
+
+    default:
+        break;
     }
+}
+
+
+void PNS_KICAD_IFACE_BASE::syncRules( PNS::NODE* aWorld, bool aItemsChanged )
+{
+    int worstClearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+
+    aWorld->ClearEdgeExclusions();
 
     for( FOOTPRINT* footprint : m_board->Footprints() )
     {
         for( PAD* pad : footprint->Pads() )
         {
-            if( std::unique_ptr<PNS::SOLID> solid = syncPad( pad ) )
-                aWorld->Add( std::move( solid ) );
-
             worstClearance = std::max( worstClearance, pad->GetLocalClearance() );
 
             if( pad->GetProperty() == PAD_PROP::CASTELLATED )
@@ -1366,54 +1488,197 @@ void PNS_KICAD_IFACE_BASE::SyncWorld( PNS::NODE *aWorld )
                 aWorld->AddEdgeExclusion( std::move( hole ) );
             }
         }
+    }
 
-        syncTextItem( aWorld, &footprint->Reference(), footprint->Reference().GetLayer() );
-        syncTextItem( aWorld, &footprint->Value(), footprint->Value().GetLayer() );
+    // The rule resolver outlives the world, so that its clearances can be reused from one
+    // routing session to the next while nothing changes.
+    if( !m_ruleResolver || m_ruleResolver->GetBoard() != m_board )
+    {
+        delete m_ruleResolver;
+        m_ruleResolver = new PNS_PCBNEW_RULE_RESOLVER( m_board, this );
+    }
+    else
+    {
+        m_ruleResolver->SyncCaches( aItemsChanged );
+    }
 
-        for( FP_ZONE* zone : footprint->Zones() )
-            syncZone( aWorld, zone, boardOutline );
+    aWorld->SetRuleResolver( m_ruleResolver );
+    aWorld->SetMaxClearance( worstClearance + m_ruleResolver->ClearanceEpsilon() );
+}
 
-        for( BOARD_ITEM* mgitem : footprint->GraphicalItems() )
-        {
-            if( mgitem->Type() == PCB_FP_SHAPE_T || mgitem->Type() == PCB_FP_TEXTBOX_T )
-            {
-                syncGraphicalItem( aWorld, static_cast<PCB_SHAPE*>( mgitem ) );
-            }
-            else if( mgitem->Type() == PCB_FP_TEXT_T )
-            {
-                syncTextItem( aWorld, static_cast<FP_TEXT*>( mgitem ), mgitem->GetLayer() );
-            }
-        }
+
+void PNS_KICAD_IFACE_BASE::SyncWorld( PNS::NODE *aWorld )
+{
+    if( !m_board )
+    {
+        wxLogTrace( wxT( "PNS" ), wxT( "No board attached, aborting sync." ) );
+        return;
     }
 
+    m_world = aWorld;
+
+    clearChanges();
+    m_footprintChildren.clear();
+
+    for( BOARD_ITEM* gitem : m_board->Drawings() )
+        syncBoardItem( aWorld, gitem, nullptr );
+
+    SHAPE_POLY_SET  buffer;
+    SHAPE_POLY_SET* boardOutline = nullptr;
+
+    if( m_board->GetBoardPolygonOutlines( buffer ) )
+        boardOutline = &buffer;
+
+    for( ZONE* zone : m_board->Zones() )
+        syncZone( aWorld, zone, boardOutline );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+        syncFootprint( aWorld, footprint, boardOutline );
+
     for( PCB_TRACK* t : m_board->Tracks() )
+        syncBoardItem( aWorld, t, nullptr );
+
+    syncRules( aWorld );
+}
+
+
+bool PNS_KICAD_IFACE_BASE::SyncChanges( PNS::NODE* aWorld )
+{
+    if( !m_board || aWorld != m_world || m_needsFullSync )
+        return false;
+
+    // The rules may still have changed
+    if( m_changedItems.empty() )
     {
-        KICAD_T type = t->Type();
+        syncRules( aWorld, false );
+        return true;
+    }
 
-        if( type == PCB_TRACE_T )
-        {
-            if( auto segment = syncTrack( t ) )
-                aWorld->Add( std::move( segment ) );
-        }
-        else if( type == PCB_ARC_T )
-        {
-            if( auto arc = syncArc( static_cast<PCB_ARC*>( t ) ) )
-                aWorld->Add( std::move( arc ) );
-        }
-        else if( type == PCB_VIA_T )
+    // Take out everything made from a changed item (a footprint's world items are made from
+    // its children), along with the virtual vias, which depend on the joints around them.
+    std::unordered_set<const BOARD_ITEM*> staleParents;
+
+    for( const std::pair<BOARD_ITEM* const, bool>& change : m_changedItems )
+    {
+        staleParents.insert( change.first );
+
+        auto it = m_footprintChildren.find( change.first );
+
+        if( it != m_footprintChildren.end() )
         {
-            if( auto via = syncVia( static_cast<PCB_VIA*>( t ) ) )
-                aWorld->Add( std::move( via ) );
+            staleParents.insert( it->second.begin(), it->second.end() );
+            m_footprintChildren.erase( it );
         }
     }
 
-    // NB: if this were ever to become a long-lived object we would need to dirty its
-    // clearance cache here....
-    delete m_ruleResolver;
-    m_ruleResolver = new PNS_PCBNEW_RULE_RESOLVER( m_board, this );
+    aWorld->RemoveIf(
+            [&]( const PNS::ITEM* aItem )
+            {
+                return aItem->IsVirtual() || staleParents.count( aItem->Parent() );
+            } );
 
-    aWorld->SetRuleResolver( m_ruleResolver );
-    aWorld->SetMaxClearance( worstClearance + m_ruleResolver->ClearanceEpsilon() );
+    // syncZone() makes no use of the board outline (yet), so don't go to the expense of
+    // building it.
+    for( const std::pair<BOARD_ITEM* const, bool>& change : m_changedItems )
+    {
+        if( !change.second )
+            syncBoardItem( aWorld, change.first, nullptr );
+    }
+
+    syncRules( aWorld );
+    clearChanges();
+
+    return true;
+}
+
+
+void PNS_KICAD_IFACE_BASE::markChanged( BOARD_ITEM* aItem, bool aRemoved )
+{
+    if( m_needsFullSync )
+        return;
+
+    // The world items of a footprint are synced with the footprint
+    if( BOARD_ITEM_CONTAINER* footprint = aItem->GetParentFootprint() )
+    {
+        auto it = m_changedItems.find( footprint );
+
+        if( it != m_changedItems.end() && it->second )
+            return;
+
+        aItem = footprint;
+        aRemoved = false;
+    }
+
+    m_changedItems[ aItem ] = aRemoved;
+
+    // Past a point a full sync is just as quick, and remembering the changes isn't free
+    if( m_changedItems.size() > std::max<size_t>( 1000, m_board->Tracks().size() / 2 ) )
+    {
+        clearChanges();
+        m_needsFullSync = true;
+    }
+}
+
+
+void PNS_KICAD_IFACE_BASE::clearChanges()
+{
+    m_changedItems.clear();
+    m_needsFullSync = false;
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aItem )
+{
+    markChanged( aItem, false );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemsAdded( BOARD& aBoard, std::vector<BOARD_ITEM*>& aItems )
+{
+    for( BOARD_ITEM* item : aItems )
+        markChanged( item, false );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aItem )
+{
+    markChanged( aItem, true );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemsRemoved( BOARD& aBoard, std::vector<BOARD_ITEM*>& aItems )
+{
+    for( BOARD_ITEM* item : aItems )
+        markChanged( item, true );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemChanged( BOARD& aBoard, BOARD_ITEM* aItem )
+{
+    markChanged( aItem, false );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemsChanged( BOARD& aBoard, std::vector<BOARD_ITEM*>& aItems )
+{
+    for( BOARD_ITEM* item : aItems )
+        markChanged( item, false );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardItemsNetChanged( BOARD& aBoard,
+                                                   std::vector<BOARD_ITEM*>& aItems )
+{
+    for( BOARD_ITEM* item : aItems )
+        markChanged( item, false );
+}
+
+
+void PNS_KICAD_IFACE_BASE::OnBoardNetSettingsChanged( BOARD& aBoard )
+{
+    // Net classes feed the rule resolver and net codes may have been reassigned
+    clearChanges();
+    m_needsFullSync = true;
 }
 
 
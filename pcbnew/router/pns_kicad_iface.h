@@ -22,8 +22,11 @@
 #ifndef __PNS_KICAD_IFACE_H
 #define __PNS_KICAD_IFACE_H
 
+#include <unordered_map>
 #include <unordered_set>
 
+#include <board.h>
+
 #include "pns_router.h"
 
 class PNS_PCBNEW_RULE_RESOLVER;
@@ -46,7 +49,15 @@ namespace KIGFX
     class VIEW;
 }
 
-class PNS_KICAD_IFACE_BASE : public PNS::ROUTER_IFACE
+/**
+ * The interface between the router and a BOARD.
+ *
+ * While attached to a board it listens to the board's change notifications, so that the world
+ * it last synced can be brought up to date with just the items that changed (SyncChanges()).
+ * The board must outlive the listening: detach with SetBoard( nullptr ) before deleting the
+ * interface, unless the board is already gone.
+ */
+class PNS_KICAD_IFACE_BASE : public PNS::ROUTER_IFACE, public BOARD_LISTENER
 {
 public:
     PNS_KICAD_IFACE_BASE();
@@ -55,6 +66,7 @@ public:
     void EraseView() override {};
     void SetBoard( BOARD* aBoard );
     void SyncWorld( PNS::NODE* aWorld ) override;
+    bool SyncChanges( PNS::NODE* aWorld ) override;
     bool IsAnyLayerVisible( const LAYER_RANGE& aLayer ) const override { return true; };
     bool IsFlashedOnLayer( const PNS::ITEM* aItem, int aLayer ) const override;
     bool IsItemVisible( const PNS::ITEM* aItem ) const override { return true; };
@@ -83,6 +95,15 @@ public:
     PNS::RULE_RESOLVER* GetRuleResolver() override;
     PNS::DEBUG_DECORATOR* GetDebugDecorator() override;
 
+    void OnBoardItemAdded( BOARD& aBoard, BOARD_ITEM* aItem ) override;
+    void OnBoardItemsAdded( BOARD& aBoard, std::vector<BOARD_ITEM*>& aItems ) override;
+    void OnBoardItemRemoved( BOARD& aBoard, BOARD_ITEM* aItem ) override;
+    void OnBoardItemsRemoved( BOARD& aBoard, std::vector<BOARD_ITEM*>& aItems ) override;
+    void OnBoardItemChanged( BOARD& aBoard, BOARD_ITEM* aItem ) override;
+    void OnBoardItemsChanged( BOARD& aBoard, std::vector<BOARD_ITEM*>& aItems ) override;
+    void OnBoardItemsNetChanged( BOARD& aBoard, std::vector<BOARD_ITEM*>& aItems ) override;
+    void OnBoardNetSettingsChanged( BOARD& aBoard ) override;
+
 protected:
     PNS_PCBNEW_RULE_RESOLVER* m_ruleResolver;
     PNS::DEBUG_DECORATOR* m_debugDecorator;
@@ -96,10 +117,26 @@ protected:
     bool syncZone( PNS::NODE* aWorld, ZONE* aZone, SHAPE_POLY_SET* aBoardOutline );
     bool inheritTrackWidth( PNS::ITEM* aItem, int* aInheritedWidth );
 
+    void syncFootprint( PNS::NODE* aWorld, FOOTPRINT* aFootprint, SHAPE_POLY_SET* aBoardOutline );
+    void syncBoardItem( PNS::NODE* aWorld, BOARD_ITEM* aItem, SHAPE_POLY_SET* aBoardOutline );
+    void syncRules( PNS::NODE* aWorld, bool aItemsChanged = true );
+
+    void markChanged( BOARD_ITEM* aItem, bool aRemoved );
+    void clearChanges();
+
 protected:
     PNS::NODE* m_world;
     BOARD*     m_board;
     int        m_startLayer;
+
+    ///< Top-level items changed since the last sync, and whether they have been removed.
+    ///< Removed items may have been deleted since, so are never dereferenced.
+    std::unordered_map<BOARD_ITEM*, bool> m_changedItems;
+
+    ///< The children each synced footprint's world items were made from, by footprint.
+    std::unordered_map<const BOARD_ITEM*, std::vector<const BOARD_ITEM*>> m_footprintChildren;
+
+    bool       m_needsFullSync;
 };
 
 class PNS_KICAD_IFACE : public PNS_KICAD_IFACE_BASE
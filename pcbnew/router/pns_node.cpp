@@ -51,6 +51,14 @@ namespace PNS {
 static std::unordered_set<NODE*> allocNodes;
 #endif
 
+
+PERF_COUNTERS& GetPerfCounters()
+{
+    static PERF_COUNTERS counters;
+    return counters;
+}
+
+
 NODE::NODE()
 {
     m_depth = 0;
@@ -58,9 +66,16 @@ NODE::NODE()
     m_parent = nullptr;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = nullptr;
-    m_index = new INDEX;
+    m_index = std::make_shared<INDEX>();
+    m_joints = std::make_shared<JOINT_MAP>();
+    m_override = std::make_shared<std::unordered_set<ITEM*>>();
+    m_ownsJoints = true;
+    m_ownsOverride = true;
+    m_ownsIndex = true;
     m_collisionQueryScope = CQS_ALL_RULES;
 
+    PNS_PERF_COUNT( m_nodes );
+
 #ifdef DEBUG
     allocNodes.insert( this );
 #endif
@@ -85,7 +100,7 @@ NODE::~NODE()
     allocNodes.erase( this );
 #endif
 
-    m_joints.clear();
+    m_joints.reset();
 
     for( ITEM* item : *m_index )
     {
@@ -95,8 +110,6 @@ NODE::~NODE()
 
     releaseGarbage();
     unlinkParent();
-
-    delete m_index;
 }
 
 
@@ -149,24 +162,22 @@ NODE* NODE::Branch()
     child->m_maxClearance = m_maxClearance;
     child->m_collisionQueryScope = m_collisionQueryScope;
 
-    // Immediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
+    // Immediate offspring of the root branch start out empty. The rest share their parent's
+    // joints, overridden items and stored items, and only copy what they go on to change.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( ITEM* item : *m_index )
-            child->m_index->Add( item );
-
+        child->m_index = m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
+        child->m_ownsJoints = child->m_ownsOverride = child->m_ownsIndex = false;
+        m_ownsJoints = m_ownsOverride = m_ownsIndex = false;
     }
 
 #if 0
     wxLogTrace( wxT( "PNS" ), wxT( "%d items, %d joints, %d overrides" ),
                 child->m_index->Size(),
-                (int) child->m_joints.size(),
-                (int) child->m_override.size() );
+                (int) child->m_joints->size(),
+                (int) child->m_override->size() );
 #endif
 
     return child;
@@ -275,6 +286,8 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles, int aK
     if( aItem->IsVirtual() )
         return 0;
 
+    PNS_PERF_COUNT( m_collisionQueries );
+
     DEFAULT_OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask, aDifferentNetsOnly, aOverrideClearance );
 
 #ifdef DEBUG
@@ -566,7 +579,7 @@ void NODE::addSolid( SOLID* aSolid )
     if( aSolid->IsRoutable() )
         linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
 
-    m_index->Add( aSolid );
+    unshare( m_index, m_ownsIndex ).Add( aSolid );
 }
 
 
@@ -581,7 +594,7 @@ void NODE::addVia( VIA* aVia )
 {
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
 
-    m_index->Add( aVia );
+    unshare( m_index, m_ownsIndex ).Add( aVia );
 }
 
 
@@ -649,7 +662,7 @@ void NODE::addSegment( SEGMENT* aSeg )
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
-    m_index->Add( aSeg );
+    unshare( m_index, m_ownsIndex ).Add( aSeg );
 }
 
 
@@ -677,7 +690,7 @@ void NODE::addArc( ARC* aArc )
     linkJoint( aArc->Anchor( 0 ), aArc->Layers(), aArc->Net(), aArc );
     linkJoint( aArc->Anchor( 1 ), aArc->Layers(), aArc->Net(), aArc );
 
-    m_index->Add( aArc );
+    unshare( m_index, m_ownsIndex ).Add( aArc );
 }
 
 
@@ -740,12 +753,12 @@ void NODE::doRemove( ITEM* aItem )
     // case 1: removing an item that is stored in the root node from any branch:
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+        unshare( m_override, m_ownsOverride ).insert( aItem );
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
     else if( !aItem->BelongsTo( m_root ) || isRoot() )
-        m_index->Remove( aItem );
+        unshare( m_index, m_ownsIndex ).Remove( aItem );
 
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
@@ -779,6 +792,7 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
     JOINT::LINKED_ITEMS links( aJoint->LinkList() );
     JOINT::HASH_TAG tag;
     int net = aItem->Net();
+    JOINT_MAP& joints = unshare( m_joints, m_ownsJoints );
 
     tag.net = net;
     tag.pos = aJoint->Pos();
@@ -788,9 +802,9 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
     do
     {
         split = false;
-        auto range = m_joints.equal_range( tag );
+        auto range = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         // find and remove all joints containing the via to be removed
@@ -799,7 +813,7 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
         {
             if( aItem->LayersOverlap( &f->second ) )
             {
-                m_joints.erase( f );
+                joints.erase( f );
                 split = true;
                 break;
             }
@@ -1112,7 +1126,7 @@ void NODE::FixupVirtualVias()
     SEGMENT* locked_seg = nullptr;
     std::vector<VVIA*> vvias;
 
-    for( auto& jointPair : m_joints )
+    for( auto& jointPair : *m_joints )
     {
         JOINT joint = jointPair.second;
 
@@ -1185,12 +1199,12 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP::iterator f = m_joints->find( tag ), end = m_joints->end();
 
     if( f == end && !isRoot() )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        end = m_root->m_joints->end();
+        f = m_root->m_joints->find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
     }
 
     if( f == end )
@@ -1222,18 +1236,20 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     tag.pos = aPos;
     tag.net = aNet;
 
+    JOINT_MAP& joints = unshare( m_joints, m_ownsJoints );
+
     // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    JOINT_MAP::iterator f = joints.find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
     // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    if( f == joints.end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        range = m_root->m_joints->equal_range( tag );
 
         for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+            joints.insert( *f );
     }
 
     // now insert and combine overlapping joints
@@ -1244,9 +1260,9 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     do
     {
         merged  = false;
-        range   = m_joints.equal_range( tag );
+        range   = joints.equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == joints.end() )
             break;
 
         for( f = range.first; f != range.second; ++f )
@@ -1254,7 +1270,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
             if( aLayers.Overlaps( f->second.Layers() ) )
             {
                 jt.Merge( f->second );
-                m_joints.erase( f );
+                joints.erase( f );
                 merged = true;
                 break;
             }
@@ -1262,7 +1278,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     }
     while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return joints.insert( TagJointPair( tag, jt ) )->second;
 }
 
 
@@ -1287,10 +1303,28 @@ void NODE::linkJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int aNet
 
 void NODE::unlinkJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int aNet, ITEM* aWhere )
 {
-    // fixme: remove dangling joints
     JOINT& jt = touchJoint( aPos, aLayers, aNet );
 
-    jt.Unlink( aWhere );
+    if( !jt.Unlink( aWhere ) || !isRoot() )
+        return;
+
+    // The root outlives routing sessions (it is kept in sync with the board), so don't let it
+    // collect dangling joints.  A branch must keep its empty copy, which hides the root's.
+    JOINT::HASH_TAG tag;
+
+    tag.pos = aPos;
+    tag.net = aNet;
+
+    std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = m_joints->equal_range( tag );
+
+    for( JOINT_MAP::iterator f = range.first; f != range.second; ++f )
+    {
+        if( &f->second == &jt )
+        {
+            m_joints->erase( f );
+            break;
+        }
+    }
 }
 
 
@@ -1386,13 +1420,13 @@ void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
     if( isRoot() )
         return;
 
-    if( m_override.size() )
-        aRemoved.reserve( m_override.size() );
+    if( m_override->size() )
+        aRemoved.reserve( m_override->size() );
 
     if( m_index->Size() )
         aAdded.reserve( m_index->Size() );
 
-    for( ITEM* item : m_override )
+    for( ITEM* item : *m_override )
         aRemoved.push_back( item );
 
     for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
@@ -1433,7 +1467,7 @@ void NODE::Commit( NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    for( ITEM* item : aNode->m_override )
+    for( ITEM* item : *aNode->m_override )
         Remove( item );
 
     for( ITEM* item : *aNode->m_index )
@@ -1445,6 +1479,7 @@ void NODE::Commit( NODE* aNode )
 
     releaseChildren();
     releaseGarbage();
+    PackIndex();
 }
 
 
@@ -1454,6 +1489,14 @@ void NODE::KillChildren()
 }
 
 
+void NODE::PackIndex()
+{
+    // Branches are short-lived and mostly small; they aren't worth packing
+    if( isRoot() )
+        m_index->Pack();
+}
+
+
 void NODE::AllItemsInNet( int aNet, std::set<ITEM*>& aItems, int aKindMask )
 {
     INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aNet );
@@ -1508,6 +1551,23 @@ void NODE::RemoveByMarker( int aMarker )
 }
 
 
+void NODE::RemoveIf( const std::function<bool( const ITEM* )>& aPredicate )
+{
+    std::vector<ITEM*> garbage;
+
+    for( ITEM* item : *m_index )
+    {
+        if( aPredicate( item ) )
+            garbage.emplace_back( item );
+    }
+
+    for( ITEM* item : garbage )
+        Remove( item );
+
+    releaseGarbage();
+}
+
+
 SEGMENT* NODE::findRedundantSegment( const VECTOR2I& A, const VECTOR2I& B, const LAYER_RANGE& lr,
                                      int aNet )
 {
@@ -1585,7 +1645,7 @@ int NODE::QueryJoints( const BOX2I& aBox, std::vector<JOINT*>& aJoints, LAYER_RA
 
     aJoints.clear();
 
-    for( JOINT_MAP::value_type& j : m_joints )
+    for( JOINT_MAP::value_type& j : *m_joints )
     {
         if( !j.second.Layers().Overlaps( aLayerMask ) )
             continue;
@@ -1600,7 +1660,7 @@ int NODE::QueryJoints( const BOX2I& aBox, std::vector<JOINT*>& aJoints, LAYER_RA
     if( isRoot() )
         return n;
 
-    for( JOINT_MAP::value_type& j : m_root->m_joints )
+    for( JOINT_MAP::value_type& j : *m_root->m_joints )
     {
         if( !Overrides( &j.second ) && j.second.Layers().Overlaps( aLayerMask ) )
         {
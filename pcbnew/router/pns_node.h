@@ -26,7 +26,9 @@
 #include <vector>
 #include <list>
 #include <unordered_set>
+#include <functional>
 #include <core/minoptmax.h>
+#include <profile.h>
 
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_index.h>
@@ -101,10 +103,30 @@ public:
                                   PNS::CONSTRAINT* aConstraint ) = 0;
 
     virtual wxString NetName( int aNet ) = 0;
+};
 
-    virtual void ClearCacheForItem( const ITEM* aItem ) {}
+/**
+ * Counts of the router's most expensive operations, for benchmarking it on recorded sessions
+ * (see qa/tools/pns).  Shared by all routers and threads, and never reset by the router itself.
+ *
+ * They're only counted in builds with KICAD_PNS_PERF_COUNTERS, as they'd otherwise put atomic
+ * increments on the router's hottest paths for nothing.
+ */
+struct PERF_COUNTERS
+{
+    PROF_COUNTER m_nodes{ "NODEs allocated" };
+    PROF_COUNTER m_collisionQueries{ "NODE::QueryColliding() calls" };
+    PROF_COUNTER m_shoveIterations{ "Shove iterations" };
 };
 
+PERF_COUNTERS& GetPerfCounters();
+
+#ifdef PNS_PERF_COUNTERS
+#define PNS_PERF_COUNT( counter ) PNS::GetPerfCounters().counter++
+#else
+#define PNS_PERF_COUNT( counter )
+#endif
+
 /**
  * Hold an object colliding with another object, along with some useful data about the collision.
  */
@@ -201,7 +223,7 @@ public:
     ///< Return the number of joints.
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints->size();
     }
 
     ///< Return the number of nodes in the inheritance chain (wrs to the root node).
@@ -285,6 +307,8 @@ public:
 
     void AddEdgeExclusion( std::unique_ptr<SHAPE> aShape );
 
+    void ClearEdgeExclusions() { m_edgeExclusions.clear(); }
+
     bool QueryEdgeExclusions( const VECTOR2I& aPos ) const;
 
     /**
@@ -314,7 +338,8 @@ public:
 
     /**
      * Create a lightweight copy (called branch) of self that tracks the changes (added/removed
-     * items) wrs to the root.
+     * items) wrs to the root.  This takes constant time: the branch shares its parent's changes
+     * until one of the two modifies them.
      *
      * @note If there are any branches in use, their parents must **not** be deleted.
      *
@@ -386,12 +411,18 @@ public:
     ///< Destroy all child nodes. Applicable only to the root node.
     void KillChildren();
 
+    ///< Repack the spatial index after many changes. Applicable only to the root node.
+    void PackIndex();
+
     void AllItemsInNet( int aNet, std::set<ITEM*>& aItems, int aKindMask = -1 );
 
     void ClearRanks( int aMarkerMask = MK_HEAD | MK_VIOLATION | MK_HOLE );
 
     void RemoveByMarker( int aMarker );
 
+    ///< Remove (and, in the root node, free) all items for which \a aPredicate is true.
+    void RemoveIf( const std::function<bool( const ITEM* )>& aPredicate );
+
     ITEM* FindItemByParent( const BOARD_ITEM* aParent );
 
     bool HasChildren() const
@@ -407,7 +438,7 @@ public:
     ///< Check if this branch contains an updated version of the m_item from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override->find( aItem ) != m_override->end();
     }
 
     void FixupVirtualVias();
@@ -460,6 +491,20 @@ private:
         return m_parent == nullptr;
     }
 
+    ///< Return \a aData for modification, copying it first unless this node has \a aOwned it
+    ///< since the last Branch() that shared it.
+    template <class T>
+    static T& unshare( std::shared_ptr<T>& aData, bool& aOwned )
+    {
+        if( !aOwned )
+        {
+            aData = std::make_shared<T>( *aData );
+            aOwned = true;
+        }
+
+        return *aData;
+    }
+
     SEGMENT* findRedundantSegment( const VECTOR2I& A, const VECTOR2I& B, const LAYER_RANGE& lr,
                                    int aNet );
     SEGMENT* findRedundantSegment( SEGMENT* aSeg );
@@ -477,19 +522,27 @@ private:
     typedef std::unordered_multimap<JOINT::HASH_TAG, JOINT, JOINT::JOINT_TAG_HASH> JOINT_MAP;
     typedef JOINT_MAP::value_type TagJointPair;
 
-    JOINT_MAP       m_joints;           ///< hash table with the joints, linking the items. Joints
-                                        ///< are hashed by their position, layer set and net.
+    // A branch shares the joints, overrides and index of the branch it was made from until
+    // either of them changes them; all changes go through unshare().  Sharing gives up the
+    // ownership on both sides, so whichever node writes first takes a copy of its own.
+
+    std::shared_ptr<JOINT_MAP> m_joints;    ///< hash table with the joints, linking the items.
+                                            ///< Joints are hashed by their position, layer set
+                                            ///< and net.
 
     NODE*           m_parent;           ///< node this node was branched from
     NODE*           m_root;             ///< root node of the whole hierarchy
     std::set<NODE*> m_children;         ///< list of nodes branched from this one
 
-    std::unordered_set<ITEM*> m_override;   ///< hash of root's items that have been changed
-                                            ///< in this node
+    std::shared_ptr<std::unordered_set<ITEM*>> m_override;  ///< hash of root's items that
+                                                            ///< have been changed in this node
 
     int             m_maxClearance;     ///< worst case item-item clearance
     RULE_RESOLVER*  m_ruleResolver;     ///< Design rules resolver
-    INDEX*          m_index;            ///< Geometric/Net index of the items
+    std::shared_ptr<INDEX> m_index;     ///< Geometric/Net index of the items
+    bool            m_ownsJoints;       ///< m_joints can be changed in place
+    bool            m_ownsOverride;     ///< m_override can be changed in place
+    bool            m_ownsIndex;        ///< m_index can be changed in place
     int             m_depth;            ///< depth of the node (number of parent nodes in the
                                         ///< inheritance chain)
 
@@ -81,21 +81,45 @@ ROUTER* ROUTER::GetInstance()
 }
 
 
+void ROUTER::SetInstance( ROUTER* aRouter )
+{
+    theRouter = aRouter;
+}
+
+
 ROUTER::~ROUTER()
 {
     ClearWorld();
-    theRouter = nullptr;
+
+    if( theRouter == this )
+        theRouter = nullptr;
+
     delete m_logger;
 }
 
 
 void ROUTER::SyncWorld()
 {
+    // Between routing sessions the world only needs the board's changes applied to it
+    if( m_world && !RoutingInProgress() )
+    {
+        m_world->KillChildren();
+        m_placer.reset();
+
+        if( m_iface->SyncChanges( m_world.get() ) )
+        {
+            m_world->FixupVirtualVias();
+            m_world->PackIndex();
+            return;
+        }
+    }
+
     ClearWorld();
 
     m_world = std::make_unique<NODE>( );
     m_iface->SyncWorld( m_world.get() );
     m_world->FixupVirtualVias();
+    m_world->PackIndex();
 }
 
 
@@ -685,7 +709,6 @@ void ROUTER::updateView( NODE* aNode, ITEM_SET& aCurrent, bool aDragging )
 
     for( ITEM* item : added )
     {
-        GetRuleResolver()->ClearCacheForItem( item );
         int clearance = GetRuleResolver()->Clearance( item, nullptr );
         m_iface->DisplayItem( item, clearance, aDragging );
     }
@@ -90,6 +90,16 @@ enum DRAG_MODE
     virtual ~ROUTER_IFACE() {};
 
     virtual void SyncWorld( NODE* aNode ) = 0;
+
+    /**
+     * Bring \a aNode, previously filled by SyncWorld(), up to date with the changes made to
+     * the board since.
+     *
+     * @return false if that can't be done incrementally, in which case the world has to be
+     *         rebuilt with SyncWorld().
+     */
+    virtual bool SyncChanges( NODE* aNode ) { return false; }
+
     virtual void AddItem( ITEM* aItem ) = 0;
     virtual void UpdateItem( ITEM* aItem ) = 0;
     virtual void RemoveItem( ITEM* aItem ) = 0;
@@ -136,6 +146,7 @@ public:
     DRAG_ALGO* GetDragger() { return m_dragger.get(); }
 
     static ROUTER* GetInstance();
+    static void SetInstance( ROUTER* aRouter );
 
     void ClearWorld();
     void SyncWorld();
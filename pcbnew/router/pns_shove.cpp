@@ -1528,6 +1528,7 @@ SHOVE::SHOVE_STATUS SHOVE::shoveMainLoop()
         st = shoveIteration( m_iter );
 
         m_iter++;
+        PNS_PERF_COUNT( m_shoveIterations );
 
         if( st == SH_INCOMPLETE || timeLimit.Expired() || m_iter >= iterLimit )
         {
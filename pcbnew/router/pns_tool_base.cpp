@@ -60,6 +60,11 @@ TOOL_BASE::TOOL_BASE( const std::string& aToolName ) :
 
 TOOL_BASE::~TOOL_BASE()
 {
+    // Stop listening to the board, unless it has gone already (frames take their boards out
+    // of the tool manager before deleting them)
+    if( m_iface && m_toolMgr && m_iface->GetBoard() == m_toolMgr->GetModel() )
+        m_iface->SetBoard( nullptr );
+
     delete m_gridHelper;
     delete m_iface;
     delete m_router;
@@ -68,20 +73,33 @@ TOOL_BASE::~TOOL_BASE()
 
 void TOOL_BASE::Reset( RESET_REASON aReason )
 {
-    delete m_gridHelper;
-    delete m_iface;
-    delete m_router;
-
-    m_iface = new PNS_KICAD_IFACE;
-    m_iface->SetBoard( board() );
-    m_iface->SetView( getView() );
-    m_iface->SetHostTool( this );
+    // The interface follows the board's changes, so running the tool again on the same board
+    // only has to apply those to the router's world.
+    if( aReason == RUN && m_router && m_iface && m_iface->GetBoard() == board() )
+    {
+        ROUTER::SetInstance( m_router );
+    }
+    else
+    {
+        // A board which has been replaced has also been deleted, so only detach from the
+        // current one
+        if( m_iface && m_iface->GetBoard() == board() )
+            m_iface->SetBoard( nullptr );
+
+        delete m_iface;
+        delete m_router;
+
+        m_iface = new PNS_KICAD_IFACE;
+        m_iface->SetBoard( board() );
+        m_iface->SetView( getView() );
+        m_iface->SetHostTool( this );
+
+        m_router = new ROUTER;
+        m_router->SetInterface( m_iface );
+        m_router->ClearWorld();
+    }
 
-    m_router = new ROUTER;
-    m_router->SetInterface( m_iface );
-    m_router->ClearWorld();
     m_router->SyncWorld();
-
     m_router->UpdateSizes( m_savedSizes );
 
     PCBNEW_SETTINGS* settings = frame()->GetPcbNewSettings();
@@ -91,6 +109,7 @@ void TOOL_BASE::Reset( RESET_REASON aReason )
 
     m_router->LoadSettings( settings->m_PnsSettings.get() );
 
+    delete m_gridHelper;
     m_gridHelper = new PCB_GRID_HELPER( m_toolMgr, frame()->GetMagneticItemsSettings() );
 }
 
@@ -1255,13 +1255,13 @@ static bool mergeZones( EDA_DRAW_FRAME* aFrame, BOARD_COMMIT& aCommit,
 {
     aCommit.Modify( aOriginZones[0] );
 
-    for( unsigned int i = 1; i < aOriginZones.size(); i++ )
-    {
-        aOriginZones[0]->Outline()->BooleanAdd( *aOriginZones[i]->Outline(),
-                                                SHAPE_POLY_SET::PM_FAST );
-    }
+    // Union all the outlines in one pass (which also simplifies the result)
+    SHAPE_POLY_SET::BOOLEAN_BUILDER merge;
+
+    for( ZONE* zone : aOriginZones )
+        merge.AddSubject( *zone->Outline() );
 
-    aOriginZones[0]->Outline()->Simplify( SHAPE_POLY_SET::PM_FAST );
+    merge.Union( *aOriginZones[0]->Outline(), SHAPE_POLY_SET::PM_FAST );
 
     // We should have one polygon, possibly with holes.  If we end up with two polygons (either
     // because the intersection was a single point or because the intersection was within one of
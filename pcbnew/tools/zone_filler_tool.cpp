@@ -185,13 +185,19 @@ void ZONE_FILLER_TOOL::FillAllZones( wxWindow* aCaller, PROGRESS_REPORTER* aRepo
 
 int ZONE_FILLER_TOOL::ZoneFillDirty( const TOOL_EVENT& aEvent )
 {
-    PCB_EDIT_FRAME*    frame = getEditFrame<PCB_EDIT_FRAME>();
-    std::vector<ZONE*> toFill;
+    PCB_EDIT_FRAME*       frame = getEditFrame<PCB_EDIT_FRAME>();
+    std::vector<ZONE*>    toFill;
+    std::map<ZONE*, LSET> dirtyLayers;
 
     for( ZONE* zone : board()->Zones() )
     {
-        if( m_dirtyZoneIDs.count( zone->m_Uuid ) )
+        auto it = m_dirtyZoneLayers.find( zone->m_Uuid );
+
+        if( it != m_dirtyZoneLayers.end() && it->second.any() )
+        {
             toFill.push_back( zone );
+            dirtyLayers[ zone ] = it->second;
+        }
     }
 
     if( toFill.empty() )
@@ -202,7 +208,7 @@ int ZONE_FILLER_TOOL::ZoneFillDirty( const TOOL_EVENT& aEvent )
 
     m_fillInProgress = true;
 
-    m_dirtyZoneIDs.clear();
+    m_dirtyZoneLayers.clear();
 
     board()->IncrementTimeStamp();    // Clear caches
 
@@ -211,6 +217,9 @@ int ZONE_FILLER_TOOL::ZoneFillDirty( const TOOL_EVENT& aEvent )
     ZONE_FILLER                           filler( board(), &commit );
     int                                   pts = 0;
 
+    // Only refill the layers touched by the commit(s) which dirtied the zones.
+    filler.SetDirtyLayers( dirtyLayers );
+
     if( !board()->GetDesignSettings().m_DRCEngine->RulesValid() )
     {
         WX_INFOBAR* infobar = frame->GetInfoBar();
@@ -247,11 +256,27 @@ int ZONE_FILLER_TOOL::ZoneFillDirty( const TOOL_EVENT& aEvent )
     }
 
     if( filler.Fill( toFill ) )
+    {
         commit.Push( _( "Auto-fill Zone(s)" ), APPEND_UNDO | SKIP_CONNECTIVITY | ZONE_FILL_OP );
+
+        // Nothing but the refilled zones (which Fill() adds any dependent zones to) has changed
+        // since the commit that dirtied them, and Fill() has already put their new fills into
+        // the connectivity to look for islands.  Only the zones it pruned afterwards are out of
+        // date there.
+        std::shared_ptr<CONNECTIVITY_DATA> connectivity = board()->GetConnectivity();
+
+        for( ZONE* zone : filler.GetPrunedZones() )
+            connectivity->Update( zone );
+
+        connectivity->RecalculateRatsnest();
+        board()->UpdateRatsnestExclusions();
+        canvas()->RedrawRatsnest();
+    }
     else
+    {
         commit.Revert();
-
-    board()->BuildConnectivity( reporter.get() );
+        board()->BuildConnectivity( reporter.get() );
+    }
 
     if( filler.IsDebug() )
         frame->UpdateUserInterface();
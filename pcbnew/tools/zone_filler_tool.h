@@ -61,7 +61,16 @@ public:
 
     void DirtyZone( ZONE* aZone )
     {
-        m_dirtyZoneIDs.insert( aZone->m_Uuid );
+        m_dirtyZoneLayers[ aZone->m_Uuid ] |= aZone->GetLayerSet();
+    }
+
+    /**
+     * Mark only some layers of a zone as needing a refill.  ZoneFillDirty() will then leave
+     * the fills on the zone's other layers untouched.
+     */
+    void DirtyZone( ZONE* aZone, const LSET& aLayers )
+    {
+        m_dirtyZoneLayers[ aZone->m_Uuid ] |= aLayers & aZone->GetLayerSet();
     }
 
 private:
@@ -74,7 +83,7 @@ private:
 private:
     bool m_fillInProgress;
 
-    std::set<KIID> m_dirtyZoneIDs;
+    std::map<KIID, LSET> m_dirtyZoneLayers;
 };
 
 #endif
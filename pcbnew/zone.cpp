@@ -38,6 +38,7 @@
 #include <settings/settings_manager.h>
 #include <trigo.h>
 #include <i18n_utility.h>
+#include <thread_pool.h>
 
 
 ZONE::ZONE( BOARD_ITEM_CONTAINER* aParent, bool aInFP ) :
@@ -221,6 +222,23 @@ bool ZONE::UnFill()
 }
 
 
+bool ZONE::UnFill( PCB_LAYER_ID aLayer )
+{
+    bool change = false;
+
+    if( m_FilledPolysList.count( aLayer ) )
+    {
+        change = !m_FilledPolysList[aLayer]->IsEmpty();
+        m_FilledPolysList[aLayer]->RemoveAllContours();
+    }
+
+    m_insulatedIslands[aLayer].clear();
+    m_fillFlags.set( aLayer, false );
+
+    return change;
+}
+
+
 VECTOR2I ZONE::GetPosition() const
 {
     return GetCornerPosition( 0 );
@@ -310,18 +328,11 @@ const BOX2I ZONE::GetBoundingBox() const
 {
     if( const BOARD* board = GetBoard() )
     {
-        std::unordered_map<const ZONE*, BOX2I>& cache = board->m_ZoneBBoxCache;
-        auto                                    cacheIter = cache.find( this );
-
-        if( cacheIter != cache.end() )
-            return cacheIter->second;
-
-        BOX2I bbox = m_Poly->BBox();
-
-        std::unique_lock<std::mutex> cacheLock( const_cast<BOARD*>( board )->m_CachesMutex );
-        cache[ this ] = bbox;
-
-        return bbox;
+        return board->m_ZoneBBoxCache.GetOrCompute( this,
+                [&]()
+                {
+                    return m_Poly->BBox();
+                } );
     }
 
     return m_Poly->BBox();
@@ -330,16 +341,13 @@ const BOX2I ZONE::GetBoundingBox() const
 
 void ZONE::CacheBoundingBox()
 {
-    BOARD*                                  board = GetBoard();
-    std::unordered_map<const ZONE*, BOX2I>& cache = board->m_ZoneBBoxCache;
-
-    auto cacheIter = cache.find( this );
+    BOARD* board = GetBoard();
 
-    if( cacheIter == cache.end() )
-    {
-        std::unique_lock<std::mutex> cacheLock( board->m_CachesMutex );
-        cache[ this ] = m_Poly->BBox();
-    }
+    board->m_ZoneBBoxCache.GetOrCompute( this,
+            [&]()
+            {
+                return m_Poly->BBox();
+            } );
 }
 
 
@@ -971,19 +979,26 @@ void ZONE::SwapData( BOARD_ITEM* aImage )
 }
 
 
-void ZONE::CacheTriangulation( PCB_LAYER_ID aLayer )
+void ZONE::CacheTriangulation( PCB_LAYER_ID aLayer, const SHAPE_POLY_SET* aPreviousFill )
 {
+    // Large pours are split into many cells, which are worth spreading over the thread pool
+    SHAPE_POLY_SET::TASK_SUBMITTER submitter =
+            []( const std::function<void()>& aTask )
+            {
+                GetKiCadThreadPool().push_task( aTask );
+            };
+
     if( aLayer == UNDEFINED_LAYER )
     {
         for( std::pair<const PCB_LAYER_ID, std::shared_ptr<SHAPE_POLY_SET>>& pair : m_FilledPolysList )
-            pair.second->CacheTriangulation();
+            pair.second->CacheTriangulation( true, submitter );
 
         m_Poly->CacheTriangulation( false );
     }
     else
     {
         if( m_FilledPolysList.count( aLayer ) )
-            m_FilledPolysList[ aLayer ]->CacheTriangulation();
+            m_FilledPolysList[ aLayer ]->CacheTriangulation( true, submitter, aPreviousFill );
     }
 }
 
@@ -430,6 +430,13 @@ public:
      */
     bool UnFill();
 
+    /**
+     * Removes the zone filling on a single layer.
+     *
+     * @return true if a previous filling is removed, false if no change (when no filling found).
+     */
+    bool UnFill( PCB_LAYER_ID aLayer );
+
     /* Geometric transformations: */
 
     /**
@@ -608,8 +615,12 @@ public:
     /**
      * Create a list of triangles that "fill" the solid areas used for instance to draw
      * these solid areas on OpenGL.
+     *
+     * @param aPreviousFill an earlier fill of \a aLayer, whose triangles are reused for the
+     *                      parts of the fill which haven't changed since.
      */
-    void CacheTriangulation( PCB_LAYER_ID aLayer = UNDEFINED_LAYER );
+    void CacheTriangulation( PCB_LAYER_ID aLayer = UNDEFINED_LAYER,
+                             const SHAPE_POLY_SET* aPreviousFill = nullptr );
 
     /**
      * Set the list of filled polygons.
@@ -46,11 +46,175 @@
 #include <geometry/convex_hull.h>
 #include <geometry/geometry_utils.h>
 #include <confirm.h>
+#include <task_graph.h>
 #include <thread_pool.h>
 #include <math/util.h>      // for KiROUND
+#include <geometry/rtree.h>
 #include "zone_filler.h"
 
 
+/**
+ * Spatial indexes of the board items which can knock out a copper fill.  Built once per fill
+ * run; queries are read-only and so can be made from all the fill threads at once.
+ *
+ * Items are only indexed when Build() is called, so that each tree can be bulk-loaded.
+ *
+ * Entries are stored by their position in the board so that a query can hand them back in
+ * board order.  This keeps the fills identical to those produced by walking the whole board.
+ */
+class KNOCKOUT_INDEX
+{
+public:
+    struct ENTRY
+    {
+        BOARD_ITEM* m_item;
+        FOOTPRINT*  m_footprint;    // parent footprint of a graphic item, if any
+        bool        m_netTieItem;   // graphic item which may implement a net-tie
+    };
+
+    KNOCKOUT_INDEX() :
+            m_pads( std::make_unique<INDEX_RTREE>() ),
+            m_edgeGraphics( std::make_unique<INDEX_RTREE>() )
+    {}
+
+    void AddPad( PAD* aPad )
+    {
+        insert( *m_pads, aPad, nullptr, false );
+    }
+
+    void AddTrack( PCB_TRACK* aTrack )
+    {
+        LSET layers = aTrack->GetLayerSet() & LSET::AllCuMask();
+        int  idx = -1;
+
+        for( PCB_LAYER_ID layer : layers.Seq() )
+            idx = insert( layerTree( m_tracks, layer ), aTrack, nullptr, false, idx );
+    }
+
+    void AddGraphic( BOARD_ITEM* aItem, FOOTPRINT* aFootprint, bool aNetTieItem )
+    {
+        LSET layers = aItem->GetLayerSet();
+        int  idx = -1;
+
+        // An item on the Edge_Cuts or Margin is seen as on every copper layer
+        if( layers.test( Edge_Cuts ) || layers.test( Margin ) )
+        {
+            insert( *m_edgeGraphics, aItem, aFootprint, aNetTieItem );
+            return;
+        }
+
+        layers &= LSET::AllCuMask();
+
+        for( PCB_LAYER_ID layer : layers.Seq() )
+            idx = insert( layerTree( m_graphics, layer ), aItem, aFootprint, aNetTieItem, idx );
+    }
+
+    /**
+     * Index everything added so far.  Must be called before querying.
+     */
+    void Build()
+    {
+        for( auto& [ tree, pending ] : m_pending )
+            tree->BulkLoad( pending );
+
+        m_pending.clear();
+    }
+
+    std::vector<const ENTRY*> QueryPads( const BOX2I& aBox ) const
+    {
+        std::vector<int> hits;
+        query( m_pads.get(), aBox, hits );
+        return collect( hits );
+    }
+
+    std::vector<const ENTRY*> QueryTracks( PCB_LAYER_ID aLayer, const BOX2I& aBox ) const
+    {
+        std::vector<int> hits;
+        query( m_tracks.count( aLayer ) ? m_tracks.at( aLayer ).get() : nullptr, aBox, hits );
+        return collect( hits );
+    }
+
+    std::vector<const ENTRY*> QueryGraphics( PCB_LAYER_ID aLayer, const BOX2I& aBox ) const
+    {
+        std::vector<int> hits;
+        query( m_graphics.count( aLayer ) ? m_graphics.at( aLayer ).get() : nullptr, aBox, hits );
+        query( m_edgeGraphics.get(), aBox, hits );
+        return collect( hits );
+    }
+
+private:
+    typedef RTree<int, int, 2, double> INDEX_RTREE;
+
+    INDEX_RTREE& layerTree( std::map<PCB_LAYER_ID, std::unique_ptr<INDEX_RTREE>>& aTrees,
+                            PCB_LAYER_ID aLayer )
+    {
+        std::unique_ptr<INDEX_RTREE>& tree = aTrees[ aLayer ];
+
+        if( !tree )
+            tree = std::make_unique<INDEX_RTREE>();
+
+        return *tree;
+    }
+
+    int insert( INDEX_RTREE& aTree, BOARD_ITEM* aItem, FOOTPRINT* aFootprint, bool aNetTieItem,
+                int aIdx = -1 )
+    {
+        if( aIdx < 0 )
+        {
+            aIdx = (int) m_entries.size();
+            m_entries.push_back( { aItem, aFootprint, aNetTieItem } );
+        }
+
+        BOX2I             bbox = aItem->GetBoundingBox();
+        INDEX_RTREE::Rect rect = { { bbox.GetX(), bbox.GetY() },
+                                   { bbox.GetRight(), bbox.GetBottom() } };
+
+        m_pending[ &aTree ].emplace_back( rect, aIdx );
+        return aIdx;
+    }
+
+    void query( const INDEX_RTREE* aTree, const BOX2I& aBox, std::vector<int>& aHits ) const
+    {
+        if( !aTree )
+            return;
+
+        const int mmin[2] = { aBox.GetX(), aBox.GetY() };
+        const int mmax[2] = { aBox.GetRight(), aBox.GetBottom() };
+
+        auto visitor =
+                [&]( const int& aIdx ) -> bool
+                {
+                    aHits.push_back( aIdx );
+                    return true;
+                };
+
+        aTree->Search( mmin, mmax, visitor );
+    }
+
+    std::vector<const ENTRY*> collect( std::vector<int>& aHits ) const
+    {
+        std::vector<const ENTRY*> entries;
+
+        std::sort( aHits.begin(), aHits.end() );
+        aHits.erase( std::unique( aHits.begin(), aHits.end() ), aHits.end() );
+        entries.reserve( aHits.size() );
+
+        for( int idx : aHits )
+            entries.push_back( &m_entries[idx] );
+
+        return entries;
+    }
+
+    std::vector<ENTRY>                                      m_entries;
+    std::unique_ptr<INDEX_RTREE>                            m_pads;
+    std::map<PCB_LAYER_ID, std::unique_ptr<INDEX_RTREE>>    m_tracks;
+    std::map<PCB_LAYER_ID, std::unique_ptr<INDEX_RTREE>>    m_graphics;
+    std::unique_ptr<INDEX_RTREE>                            m_edgeGraphics;
+
+    std::map<INDEX_RTREE*, std::vector<std::pair<INDEX_RTREE::Rect, int>>> m_pending;
+};
+
+
 ZONE_FILLER::ZONE_FILLER(  BOARD* aBoard, COMMIT* aCommit ) :
         m_board( aBoard ),
         m_brdOutlinesValid( false ),
@@ -94,12 +258,23 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
     std::vector<std::pair<ZONE*, PCB_LAYER_ID>>        toFill;
     std::map<std::pair<ZONE*, PCB_LAYER_ID>, MD5_HASH> oldFillHashes;
     std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>          islandsList;
+    std::map<ZONE*, LSET>                              fillLayers;
+    bool                                               incremental = !m_dirtyLayers.empty();
+
+    std::map<std::pair<ZONE*, PCB_LAYER_ID>, std::shared_ptr<SHAPE_POLY_SET>> oldFills;
 
     std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
 
+    m_prunedZones.clear();
+
     // Rebuild (from scratch, ignoring dirty flags) just in case. This really needs to be reliable.
-    connectivity->Clear();
-    connectivity->Build( m_board, m_progressReporter );
+    // In incremental mode the commit which dirtied the zones has already updated connectivity
+    // for everything but the zones, and those are re-inserted when looking for islands.
+    if( !incremental )
+    {
+        connectivity->Clear();
+        connectivity->Build( m_board, m_progressReporter );
+    }
 
     BOARD_DESIGN_SETTINGS& bds = m_board->GetDesignSettings();
 
@@ -149,6 +324,63 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
         footprint->BuildCourtyardCaches();
     }
 
+    buildKnockoutIndex();
+
+    // A refilled zone changes the knockouts of any lower-priority zone on another net which it
+    // overlaps, so those layers must be refilled too.  Visiting the zones in priority order lets
+    // a single pass pick up transitive dependents.
+    //
+    if( incremental )
+    {
+        std::vector<ZONE*> candidates( m_board->Zones().begin(), m_board->Zones().end() );
+
+        std::sort( candidates.begin(), candidates.end(),
+                   []( const ZONE* lhs, const ZONE* rhs )
+                   {
+                       return lhs->HigherPriority( rhs );
+                   } );
+
+        for( ZONE* zone : candidates )
+        {
+            if( zone->GetIsRuleArea() || zone->GetNumCorners() <= 2 )
+                continue;
+
+            BOX2I inflatedBBox = zone->GetBoundingBox();
+            inflatedBBox.Inflate( m_worstClearance );
+
+            for( ZONE* otherZone : candidates )
+            {
+                if( otherZone == zone || otherZone->GetIsRuleArea() )
+                    continue;
+
+                if( !otherZone->HigherPriority( zone ) || otherZone->SameNet( zone ) )
+                    continue;
+
+                auto it = m_dirtyLayers.find( otherZone );
+
+                if( it == m_dirtyLayers.end() )
+                    continue;
+
+                LSET sharedLayers = it->second & zone->GetLayerSet();
+
+                if( sharedLayers.none() )
+                    continue;
+
+                if( !inflatedBBox.Intersects( otherZone->GetBoundingBox() ) )
+                    continue;
+
+                if( zone->Outline()->Collide( otherZone->Outline(), m_worstClearance ) )
+                    m_dirtyLayers[ zone ] |= sharedLayers;
+            }
+        }
+
+        for( const std::pair<ZONE* const, LSET>& pair : m_dirtyLayers )
+        {
+            if( !alg::contains( aZones, pair.first ) )
+                aZones.push_back( pair.first );
+        }
+    }
+
     // Sort by priority to reduce deferrals waiting on higher priority zones.
     //
     std::sort( aZones.begin(), aZones.end(),
@@ -167,16 +399,34 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
         if( zone->GetNumCorners() <= 2 )
             continue;
 
+        LSET layers = zone->GetLayerSet();
+
+        if( incremental )
+        {
+            auto it = m_dirtyLayers.find( zone );
+            layers &= ( it != m_dirtyLayers.end() ) ? it->second : LSET();
+
+            if( layers.none() )
+                continue;
+        }
+
+        fillLayers[ zone ] = layers;
+
         if( m_commit )
             m_commit->Modify( zone );
 
         // calculate the hash value for filled areas. it will be used later to know if the
         // current filled areas are up to date
-        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        for( PCB_LAYER_ID layer : layers.Seq() )
         {
             zone->BuildHashValue( layer );
             oldFillHashes[ { zone, layer } ] = zone->GetHashValue( layer );
 
+            // Keep hold of the old fill so that the triangles of what hasn't changed can be
+            // reused
+            if( zone->HasFilledPolysForLayer( layer ) )
+                oldFills[ { zone, layer } ] = zone->GetFilledPolysList( layer );
+
             // Add the zone to the list of zones to test or refill
             toFill.emplace_back( std::make_pair( zone, layer ) );
         }
@@ -184,20 +434,23 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
         islandsList.emplace_back( CN_ZONE_ISOLATED_ISLAND_LIST( zone ) );
 
         // Remove existing fill first to prevent drawing invalid polygons on some platforms
-        zone->UnFill();
+        if( incremental )
+        {
+            for( PCB_LAYER_ID layer : layers.Seq() )
+                zone->UnFill( layer );
+        }
+        else
+        {
+            zone->UnFill();
+        }
     }
 
-
     auto check_fill_dependency =
             [&]( ZONE* aZone, PCB_LAYER_ID aLayer, ZONE* aOtherZone ) -> bool
             {
                 // Check to see if we have to knock-out the filled areas of a higher-priority
                 // zone.  If so we have to wait until said zone is filled before we can fill.
 
-                // If the other zone is already filled then we're good-to-go
-                if( aOtherZone->GetFillFlag( aLayer ) )
-                    return false;
-
                 // Even if keepouts exclude copper pours the exclusion is by outline, not by
                 // filled area, so we're good-to-go here too.
                 if( aOtherZone->GetIsRuleArea() )
@@ -214,8 +467,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
                 if( aOtherZone->SameNet( aZone ) )
                     return false;
 
-                // A higher priority zone is found: if we intersect and it's not filled yet
-                // then we have to wait.
+                // A higher priority zone is found: if we intersect then we have to wait.
                 BOX2I inflatedBBox = aZone->GetBoundingBox();
                 inflatedBBox.Inflate( m_worstClearance );
 
@@ -226,119 +478,110 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
             };
 
     auto fill_lambda =
-            [&]( std::pair<ZONE*, PCB_LAYER_ID> aFillItem ) -> int
+            [&]( std::pair<ZONE*, PCB_LAYER_ID> aFillItem )
             {
                 PCB_LAYER_ID layer = aFillItem.second;
                 ZONE*        zone = aFillItem.first;
-                bool         canFill = true;
-
-                // Check for any fill dependencies.  If our zone needs to be clipped by
-                // another zone then we can't fill until that zone is filled.
-                for( ZONE* otherZone : aZones )
-                {
-                    if( otherZone == zone )
-                        continue;
-
-                    if( check_fill_dependency( zone, layer, otherZone ) )
-                    {
-                        canFill = false;
-                        break;
-                    }
-                }
 
                 if( m_progressReporter && m_progressReporter->IsCancelled() )
-                    return 0;
-
-                if( !canFill )
-                    return 0;
-
-
-                // Now we're ready to fill.
-                std::unique_lock<std::mutex> zoneLock( zone->GetLock(), std::try_to_lock );
-
-                if( !zoneLock.owns_lock() )
-                    return 0;
+                    return;
 
+                std::lock_guard<std::mutex> zoneLock( zone->GetLock() );
 
                 SHAPE_POLY_SET fillPolys;
 
                 if( !fillSingleZone( zone, layer, fillPolys ) )
-                    return 0;
+                    return;
 
                 zone->SetFilledPolysList( layer, fillPolys );
                 zone->SetFillFlag( layer, true );
 
                 if( m_progressReporter )
                     m_progressReporter->AdvanceProgress();
-
-                return 1;
             };
 
-
     auto tesselate_lambda =
-            [&]( std::pair<ZONE*, PCB_LAYER_ID> aFillItem ) -> int
+            [&]( std::pair<ZONE*, PCB_LAYER_ID> aFillItem )
             {
                 PCB_LAYER_ID layer = aFillItem.second;
                 ZONE*        zone = aFillItem.first;
 
-                zone->CacheTriangulation( layer );
-                return 1;
+                if( m_progressReporter && m_progressReporter->IsCancelled() )
+                    return;
+
+                std::shared_ptr<SHAPE_POLY_SET> oldFill;
+                auto                            it = oldFills.find( aFillItem );
 
+                // Only this task touches the entry, so it can let go of it
+                if( it != oldFills.end() )
+                    oldFill = std::move( it->second );
+
+                zone->CacheTriangulation( layer, oldFill.get() );
             };
 
     // Calculate the copper fills (NB: this is multi-threaded)
     //
-    std::vector<std::pair<std::future<int>, int>> returns;
-    returns.reserve( toFill.size() );
-    size_t finished = 0;
-
-
-    thread_pool& tp = GetKiCadThreadPool();
+    // Each (zone, layer) gets a fill task followed by a tesselation task.  A fill has to wait
+    // for the fills of any higher-priority zones it knocks out, and the layers of a single zone
+    // are filled one after another.  Tasks are released as soon as their prerequisites finish.
+    //
+    TASK_GRAPH                                     graph( GetKiCadThreadPool() );
+    std::vector<TASK_GRAPH::TASK_ID>               fillTasks;
+    std::map<ZONE*, TASK_GRAPH::TASK_ID>           lastZoneFill;
+    std::map<PCB_LAYER_ID, std::vector<size_t>>    layerFills;
 
-    for( const std::pair<ZONE*, PCB_LAYER_ID>& fillItem : toFill )
-        returns.emplace_back( std::make_pair( tp.submit( fill_lambda, fillItem ), 0 ) );
+    fillTasks.reserve( toFill.size() );
 
-    while( finished != 2 * toFill.size() )
+    for( size_t ii = 0; ii < toFill.size(); ++ii )
     {
-        for( size_t ii = 0; ii < returns.size(); ++ii )
-        {
-            auto& ret = returns[ii];
-
-            if( ret.second > 1 )
-                continue;
+        const std::pair<ZONE*, PCB_LAYER_ID>& fillItem = toFill[ii];
 
-            std::future_status status = ret.first.wait_for( std::chrono::seconds( 0 ) );
+        TASK_GRAPH::TASK_ID fillTask = graph.AddTask( [&, fillItem]()
+                                                      {
+                                                          fill_lambda( fillItem );
+                                                      } );
+        TASK_GRAPH::TASK_ID tessTask = graph.AddTask( [&, fillItem]()
+                                                      {
+                                                          tesselate_lambda( fillItem );
+                                                      } );
 
-            if( status == std::future_status::ready )
-            {
-                if( ret.first.get() )
-                {
-                    ++finished;
+        graph.AddDependency( tessTask, fillTask );
 
-                    if( ret.second == 0 )
-                        returns[ii].first = tp.submit( tesselate_lambda, toFill[ii] );
+        auto it = lastZoneFill.find( fillItem.first );
 
-                    ret.second++;
-                }
-                else
-                {
-                    returns[ii].first = tp.submit( fill_lambda, toFill[ii] );
-                }
-            }
-        }
-
-        std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+        if( it != lastZoneFill.end() )
+            graph.AddDependency( fillTask, it->second );
 
+        lastZoneFill[ fillItem.first ] = fillTask;
+        fillTasks.push_back( fillTask );
+        layerFills[ fillItem.second ].push_back( ii );
+    }
 
-        if( m_progressReporter )
+    for( const std::pair<const PCB_LAYER_ID, std::vector<size_t>>& layerFill : layerFills )
+    {
+        for( size_t ii : layerFill.second )
         {
-            if( m_progressReporter->IsCancelled() )
-                break;
+            for( size_t jj : layerFill.second )
+            {
+                if( toFill[ii].first == toFill[jj].first )
+                    continue;
 
-            m_progressReporter->KeepRefreshing();
+                if( check_fill_dependency( toFill[ii].first, layerFill.first, toFill[jj].first ) )
+                    graph.AddDependency( fillTasks[ii], fillTasks[jj] );
+            }
         }
     }
 
+    graph.Run(
+            [&]() -> bool
+            {
+                if( !m_progressReporter )
+                    return true;
+
+                m_progressReporter->KeepRefreshing();
+                return !m_progressReporter->IsCancelled();
+            } );
+
     // Now update the connectivity to check for isolated copper islands
     // (NB: FindIsolatedCopperIslands() is multi-threaded)
     //
@@ -373,7 +616,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
     //
     for( CN_ZONE_ISOLATED_ISLAND_LIST& zone : islandsList )
     {
-        for( PCB_LAYER_ID layer : zone.m_zone->GetLayerSet().Seq() )
+        for( PCB_LAYER_ID layer : fillLayers[ zone.m_zone ].Seq() )
         {
             if( m_debugZoneFiller && LSET::InternalCuMask().Contains( layer ) )
                 continue;
@@ -395,12 +638,16 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
             {
                 SHAPE_LINE_CHAIN& outline = poly->Outline( idx );
 
-                if( mode == ISLAND_REMOVAL_MODE::ALWAYS )
-                    poly->DeletePolygonAndTriangulationData( idx, false );
-                else if ( mode == ISLAND_REMOVAL_MODE::AREA && outline.Area() < minArea )
+                if( mode == ISLAND_REMOVAL_MODE::ALWAYS
+                        || ( mode == ISLAND_REMOVAL_MODE::AREA && outline.Area() < minArea ) )
+                {
                     poly->DeletePolygonAndTriangulationData( idx, false );
+                    m_prunedZones.insert( zone.m_zone );
+                }
                 else
+                {
                     zone.m_zone->SetIsIsland( layer, idx );
+                }
             }
 
             poly->UpdateTriangulationDataHash();
@@ -416,7 +663,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
     //
     for( ZONE* zone : aZones )
     {
-        LSET   zoneCopperLayers = zone->GetLayerSet() & LSET::AllCuMask( MAX_CU_LAYERS );
+        LSET   zoneCopperLayers = fillLayers[ zone ] & LSET::AllCuMask( MAX_CU_LAYERS );
 
         // Min-thickness is the web thickness.  On the other hand, a blob min-thickness by
         // min-thickness is not useful.  Since there's no obvious definition of web vs. blob, we
@@ -439,6 +686,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
                         || island.front().Area() < minArea )
                 {
                     poly->DeletePolygonAndTriangulationData( ii, false );
+                    m_prunedZones.insert( zone );
                 }
             }
 
@@ -460,7 +708,7 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
             if( zone->GetIsRuleArea() )
                 continue;
 
-            for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+            for( PCB_LAYER_ID layer : fillLayers[ zone ].Seq() )
             {
                 zone->BuildHashValue( layer );
 
@@ -500,6 +748,35 @@ bool ZONE_FILLER::Fill( std::vector<ZONE*>& aZones, bool aCheck, wxWindow* aPare
 }
 
 
+void ZONE_FILLER::buildKnockoutIndex()
+{
+    m_knockoutIndex = std::make_unique<KNOCKOUT_INDEX>();
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+            m_knockoutIndex->AddPad( pad );
+    }
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        m_knockoutIndex->AddTrack( track );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        m_knockoutIndex->AddGraphic( &footprint->Reference(), footprint, false );
+        m_knockoutIndex->AddGraphic( &footprint->Value(), footprint, false );
+
+        for( BOARD_ITEM* item : footprint->GraphicalItems() )
+            m_knockoutIndex->AddGraphic( item, footprint, footprint->IsNetTie() );
+    }
+
+    for( BOARD_ITEM* item : m_board->Drawings() )
+        m_knockoutIndex->AddGraphic( item, nullptr, false );
+
+    m_knockoutIndex->Build();
+}
+
+
 /**
  * Add a knockout for a pad.  The knockout is 'aGap' larger than the pad (which might be
  * either the thermal clearance or the electrical clearance).
@@ -611,84 +888,85 @@ void ZONE_FILLER::knockoutThermalReliefs( const ZONE* aZone, PCB_LAYER_ID aLayer
     int                    padClearance;
     int                    holeClearance;
     SHAPE_POLY_SET         holes;
+    BOX2I                  zoneBBox = aZone->GetBoundingBox();
 
-    for( FOOTPRINT* footprint : m_board->Footprints() )
+    zoneBBox.Inflate( m_worstClearance );
+
+    for( const KNOCKOUT_INDEX::ENTRY* entry : m_knockoutIndex->QueryPads( zoneBBox ) )
     {
-        for( PAD* pad : footprint->Pads() )
-        {
-            BOX2I padBBox = pad->GetBoundingBox();
-            padBBox.Inflate( m_worstClearance );
+        PAD*  pad = static_cast<PAD*>( entry->m_item );
+        BOX2I padBBox = pad->GetBoundingBox();
+        padBBox.Inflate( m_worstClearance );
 
-            if( !padBBox.Intersects( aZone->GetBoundingBox() ) )
-                continue;
+        if( !padBBox.Intersects( aZone->GetBoundingBox() ) )
+            continue;
 
-            if( pad->GetNetCode() != aZone->GetNetCode() || pad->GetNetCode() <= 0 )
-            {
-                // collect these for knockout in buildCopperItemClearances()
-                aNoConnectionPads.push_back( pad );
-                continue;
-            }
+        if( pad->GetNetCode() != aZone->GetNetCode() || pad->GetNetCode() <= 0 )
+        {
+            // collect these for knockout in buildCopperItemClearances()
+            aNoConnectionPads.push_back( pad );
+            continue;
+        }
 
-            if( aZone->IsTeardropArea() )
-            {
-                connection = ZONE_CONNECTION::FULL;
-            }
-            else
-            {
-                constraint = bds.m_DRCEngine->EvalZoneConnection( pad, aZone, aLayer );
-                connection = constraint.m_ZoneConnection;
-            }
+        if( aZone->IsTeardropArea() )
+        {
+            connection = ZONE_CONNECTION::FULL;
+        }
+        else
+        {
+            constraint = bds.m_DRCEngine->EvalZoneConnection( pad, aZone, aLayer );
+            connection = constraint.m_ZoneConnection;
+        }
 
-            switch( connection )
-            {
-            case ZONE_CONNECTION::THERMAL:
-                constraint = bds.m_DRCEngine->EvalRules( THERMAL_RELIEF_GAP_CONSTRAINT, pad, aZone,
-                                                         aLayer );
-                padClearance = constraint.GetValue().Min();
-                holeClearance = padClearance;
+        switch( connection )
+        {
+        case ZONE_CONNECTION::THERMAL:
+            constraint = bds.m_DRCEngine->EvalRules( THERMAL_RELIEF_GAP_CONSTRAINT, pad, aZone,
+                                                     aLayer );
+            padClearance = constraint.GetValue().Min();
+            holeClearance = padClearance;
 
-                if( pad->FlashLayer( aLayer ) )
-                    aThermalConnectionPads.push_back( pad );
+            if( pad->FlashLayer( aLayer ) )
+                aThermalConnectionPads.push_back( pad );
 
-                break;
+            break;
 
-            case ZONE_CONNECTION::NONE:
-                constraint = bds.m_DRCEngine->EvalRules( PHYSICAL_CLEARANCE_CONSTRAINT, pad,
-                                                         aZone, aLayer );
+        case ZONE_CONNECTION::NONE:
+            constraint = bds.m_DRCEngine->EvalRules( PHYSICAL_CLEARANCE_CONSTRAINT, pad,
+                                                     aZone, aLayer );
 
-                if( constraint.GetValue().Min() > aZone->GetLocalClearance() )
-                    padClearance = constraint.GetValue().Min();
-                else
-                    padClearance = aZone->GetLocalClearance();
+            if( constraint.GetValue().Min() > aZone->GetLocalClearance() )
+                padClearance = constraint.GetValue().Min();
+            else
+                padClearance = aZone->GetLocalClearance();
 
-                constraint = bds.m_DRCEngine->EvalRules( PHYSICAL_HOLE_CLEARANCE_CONSTRAINT, pad,
-                                                         aZone, aLayer );
+            constraint = bds.m_DRCEngine->EvalRules( PHYSICAL_HOLE_CLEARANCE_CONSTRAINT, pad,
+                                                     aZone, aLayer );
 
-                if( constraint.GetValue().Min() > padClearance )
-                    holeClearance = constraint.GetValue().Min();
-                else
-                    holeClearance = padClearance;
+            if( constraint.GetValue().Min() > padClearance )
+                holeClearance = constraint.GetValue().Min();
+            else
+                holeClearance = padClearance;
 
-                break;
+            break;
 
-            default:
-                // No knockout
-                continue;
-            }
+        default:
+            // No knockout
+            continue;
+        }
 
-            if( pad->FlashLayer( aLayer ) )
-            {
-                addKnockout( pad, aLayer, padClearance, holes );
-            }
-            else if( pad->GetDrillSize().x > 0 )
-            {
-                // Note: drill size represents finish size, which means the actual holes size
-                // is the plating thickness larger.
-                holeClearance += pad->GetBoard()->GetDesignSettings().GetHolePlatingThickness();
+        if( pad->FlashLayer( aLayer ) )
+        {
+            addKnockout( pad, aLayer, padClearance, holes );
+        }
+        else if( pad->GetDrillSize().x > 0 )
+        {
+            // Note: drill size represents finish size, which means the actual holes size
+            // is the plating thickness larger.
+            holeClearance += pad->GetBoard()->GetDesignSettings().GetHolePlatingThickness();
 
-                pad->TransformHoleWithClearanceToPolygon( holes, holeClearance, m_maxError,
-                                                          ERROR_OUTSIDE );
-            }
+            pad->TransformHoleWithClearanceToPolygon( holes, holeClearance, m_maxError,
+                                                      ERROR_OUTSIDE );
         }
     }
 
@@ -832,8 +1110,11 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
                 }
             };
 
-    for( PCB_TRACK* track : m_board->Tracks() )
+    for( const KNOCKOUT_INDEX::ENTRY* entry : m_knockoutIndex->QueryTracks( aLayer,
+                                                                            zone_boundingbox ) )
     {
+        PCB_TRACK* track = static_cast<PCB_TRACK*>( entry->m_item );
+
         if( !track->IsOnLayer( aLayer ) )
             continue;
 
@@ -882,71 +1163,65 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
                 }
             };
 
-    for( FOOTPRINT* footprint : m_board->Footprints() )
-    {
-        knockoutGraphicClearance( &footprint->Reference() );
-        knockoutGraphicClearance( &footprint->Value() );
-
-        std::set<PAD*> allowedNetTiePads;
+    std::map<FOOTPRINT*, std::set<PAD*>> allowedNetTiePads;
 
-        // Don't knock out holes for graphic items which implement a net-tie to the zone's net
-        // on the layer being filled.
-        if( footprint->IsNetTie() )
-        {
-            for( PAD* pad : footprint->Pads() )
+    // Don't knock out holes for graphic items which implement a net-tie to the zone's net
+    // on the layer being filled.
+    auto getAllowedNetTiePads =
+            [&]( FOOTPRINT* aFootprint ) -> const std::set<PAD*>&
             {
-                if( pad->GetNetCode() == aZone->GetNetCode() )
-                {
-                    if( pad->IsOnLayer( aLayer ) )
-                        allowedNetTiePads.insert( pad );
+                auto it = allowedNetTiePads.find( aFootprint );
+
+                if( it != allowedNetTiePads.end() )
+                    return it->second;
+
+                std::set<PAD*>& pads = allowedNetTiePads[ aFootprint ];
 
-                    for( PAD* other : footprint->GetNetTiePads( pad ) )
+                for( PAD* pad : aFootprint->Pads() )
+                {
+                    if( pad->GetNetCode() == aZone->GetNetCode() )
                     {
-                        if( other->IsOnLayer( aLayer ) )
-                            allowedNetTiePads.insert( other );
+                        if( pad->IsOnLayer( aLayer ) )
+                            pads.insert( pad );
+
+                        for( PAD* other : aFootprint->GetNetTiePads( pad ) )
+                        {
+                            if( other->IsOnLayer( aLayer ) )
+                                pads.insert( other );
+                        }
                     }
                 }
-            }
-        }
 
-        for( BOARD_ITEM* item : footprint->GraphicalItems() )
-        {
-            if( checkForCancel( m_progressReporter ) )
-                return;
+                return pads;
+            };
 
-            BOX2I itemBBox = item->GetBoundingBox();
+    for( const KNOCKOUT_INDEX::ENTRY* entry : m_knockoutIndex->QueryGraphics( aLayer,
+                                                                              zone_boundingbox ) )
+    {
+        if( checkForCancel( m_progressReporter ) )
+            return;
 
-            if( !zone_boundingbox.Intersects( itemBBox ) )
-                continue;
+        BOARD_ITEM* item = entry->m_item;
+        bool        skipItem = false;
 
-            bool skipItem = false;
+        if( entry->m_netTieItem && item->IsOnLayer( aLayer ) )
+        {
+            BOX2I                  itemBBox = item->GetBoundingBox();
+            std::shared_ptr<SHAPE> itemShape = item->GetEffectiveShape();
 
-            if( item->IsOnLayer( aLayer ) )
+            for( PAD* pad : getAllowedNetTiePads( entry->m_footprint ) )
             {
-                std::shared_ptr<SHAPE> itemShape = item->GetEffectiveShape();
-
-                for( PAD* pad : allowedNetTiePads )
+                if( pad->GetBoundingBox().Intersects( itemBBox )
+                        && pad->GetEffectiveShape()->Collide( itemShape.get() ) )
                 {
-                    if( pad->GetBoundingBox().Intersects( itemBBox )
-                            && pad->GetEffectiveShape()->Collide( itemShape.get() ) )
-                    {
-                        skipItem = true;
-                        break;
-                    }
+                    skipItem = true;
+                    break;
                 }
             }
-
-            if( !skipItem )
-                knockoutGraphicClearance( item );
         }
-    }
 
-    for( BOARD_ITEM* item : m_board->Drawings() )
-    {
-        if( checkForCancel( m_progressReporter ) )
-            return;
-
-        knockoutGraphicClearance( item );
+        if( !skipItem )
+            knockoutGraphicClearance( item );
     }
 
     // Add non-connected zone clearances
@@ -1032,7 +1307,8 @@ void ZONE_FILLER::buildCopperItemClearances( const ZONE* aZone, PCB_LAYER_ID aLa
 void ZONE_FILLER::subtractHigherPriorityZones( const ZONE* aZone, PCB_LAYER_ID aLayer,
                                                SHAPE_POLY_SET& aRawFill )
 {
-    BOX2I zoneBBox = aZone->GetBoundingBox();
+    BOX2I                           zoneBBox = aZone->GetBoundingBox();
+    SHAPE_POLY_SET::BOOLEAN_BUILDER knockouts;
 
     auto knockoutZoneOutline =
             [&]( ZONE* aKnockout )
@@ -1049,7 +1325,7 @@ void ZONE_FILLER::subtractHigherPriorityZones( const ZONE* aZone, PCB_LAYER_ID a
                     SHAPE_POLY_SET outline = aKnockout->Outline()->CloneDropTriangulation();
                     outline.ClearArcs();
 
-                    aRawFill.BooleanSubtract( outline, SHAPE_POLY_SET::PM_FAST );
+                    knockouts.AddClip( outline );
                 }
             };
 
@@ -1075,6 +1351,12 @@ void ZONE_FILLER::subtractHigherPriorityZones( const ZONE* aZone, PCB_LAYER_ID a
             }
         }
     }
+
+    if( knockouts.HasClips() )
+    {
+        knockouts.AddSubject( aRawFill );
+        knockouts.Subtract( aRawFill, SHAPE_POLY_SET::PM_FAST );
+    }
 }
 
 
@@ -26,9 +26,13 @@
 #ifndef ZONE_FILLER_H
 #define ZONE_FILLER_H
 
+#include <map>
+#include <memory>
+#include <set>
 #include <vector>
 #include <zone.h>
 
+class KNOCKOUT_INDEX;
 class PROGRESS_REPORTER;
 class BOARD;
 class COMMIT;
@@ -57,6 +61,27 @@ public:
      */
     bool Fill( std::vector<ZONE*>& aZones, bool aCheck = false, wxWindow* aParent = nullptr );
 
+    /**
+     * Restrict the next Fill() to the given layers of each zone.  Layers not listed keep their
+     * existing fills.  Lower-priority zones which knock out the fill of a refilled layer are
+     * added automatically.
+     *
+     * In this mode connectivity is not rebuilt from scratch: the caller must ensure it is
+     * up-to-date for all non-zone items (as it is after a BOARD_COMMIT has been pushed), and
+     * only the refilled zones are re-inserted into it.
+     */
+    void SetDirtyLayers( const std::map<ZONE*, LSET>& aDirtyLayers )
+    {
+        m_dirtyLayers = aDirtyLayers;
+    }
+
+    /**
+     * @return the zones which lost filled polygons (isolated islands, or polygons outside the
+     *         board) after the last Fill() handed their new fills to the connectivity data
+     *         to look for islands.  Only these are out of date in the connectivity.
+     */
+    const std::set<ZONE*>& GetPrunedZones() const { return m_prunedZones; }
+
     bool IsDebug() const { return m_debugZoneFiller; }
 
 private:
@@ -128,6 +153,12 @@ private:
     bool addHatchFillTypeOnZone( const ZONE* aZone, PCB_LAYER_ID aLayer, PCB_LAYER_ID aDebugLayer,
                                  SHAPE_POLY_SET& aFillPolys );
 
+    /**
+     * Build spatial indexes of the pads, tracks and graphic items which can knock out copper
+     * fills, so that each zone/layer only visits the items near it.
+     */
+    void buildKnockoutIndex();
+
     BOARD*                m_board;
     SHAPE_POLY_SET        m_boardOutline;       // the board outlines, if exists
     bool                  m_brdOutlinesValid;   // true if m_boardOutline is well-formed
@@ -137,6 +168,11 @@ private:
     int                   m_maxError;
     int                   m_worstClearance;
 
+    std::map<ZONE*, LSET> m_dirtyLayers;        // empty to refill all layers of all zones
+    std::set<ZONE*>       m_prunedZones;
+
+    std::unique_ptr<KNOCKOUT_INDEX> m_knockoutIndex;    // read-only while filling
+
     bool                  m_debugZoneFiller;
 };
 
@@ -0,0 +1,174 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <geometry/shape_line_chain.h>
+#include <math/util.h>
+#include <profile.h>
+
+#include <qa_utils/utility_registry.h>
+
+#include <common.h>
+
+#include <wx/cmdline.h>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "p",
+            "points",
+            _( "number of points in the chain" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "s",
+            "segments",
+            _( "number of segments to collide with it" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+static int segment_batch_bench_func( int argc, char** argv )
+{
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "Time SHAPE_LINE_CHAIN::CollideSegments() against Collide() on "
+                               "each segment, for a chain the size of a zone outline" ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long pointCount = 20000;
+    long segCount = 2000;
+    cl_parser.Found( "points", &pointCount );
+    cl_parser.Found( "segments", &segCount );
+
+    const int        radius = 10000000;
+    const int        clearance = 2000000;
+    std::mt19937     rng( 42 );
+    SHAPE_LINE_CHAIN chain;
+    std::vector<SEG> segs;
+
+    auto coord =
+            [&]( int aRange )
+            {
+                return (int) ( rng() % ( 2 * aRange + 1 ) ) - aRange;
+            };
+
+    // A jagged ring ending in an arc, left open so that the timings aren't swamped by
+    // PointInside()
+    for( long ii = 0; ii < pointCount; ++ii )
+    {
+        double angle = 1.5 * M_PI * ii / pointCount;
+        int    r = radius + coord( radius / 20 );
+
+        chain.Append( VECTOR2I( KiROUND( r * cos( angle ) ), KiROUND( r * sin( angle ) ) ) );
+    }
+
+    chain.Append( SHAPE_ARC( VECTOR2I( 0, -radius ), VECTOR2I( radius / 2, -radius * 7 / 8 ),
+                             VECTOR2I( radius, 0 ), 0 ) );
+
+    // Inside the ring, so that none of them cross it and there are no early outs
+    for( long ii = 0; ii < segCount; ++ii )
+    {
+        VECTOR2I a( coord( 6000000 ), coord( 6000000 ) );
+
+        segs.emplace_back( a, a + VECTOR2I( coord( 100000 ), coord( 100000 ) ) );
+    }
+
+    std::vector<int> actual( segs.size(), INT_MAX );
+    std::vector<int> batchActual( segs.size(), INT_MAX );
+    int              nearest = INT_MAX;
+    int              batchNearest = INT_MAX;
+
+    PROF_TIMER single( "Collide() on each segment" );
+
+    for( size_t ii = 0; ii < segs.size(); ++ii )
+    {
+        if( chain.Collide( segs[ii], clearance, &actual[ii] ) )
+            nearest = std::min( nearest, actual[ii] );
+    }
+
+    single.Stop();
+
+    // A fresh batch for each segment is the worst case
+    PROF_TIMER eachBatched( "CollideSegments() on each segment" );
+
+    for( size_t ii = 0; ii < segs.size(); ++ii )
+        chain.CollideSegments( { segs[ii] }, clearance, &batchActual[ii] );
+
+    eachBatched.Stop();
+
+    PROF_TIMER allBatched( "CollideSegments() on all of them" );
+
+    chain.CollideSegments( segs, clearance, &batchNearest );
+
+    allBatched.Stop();
+
+    std::cout << segs.size() << " segments against a chain of " << chain.PointCount()
+              << " points" << std::endl;
+
+    single.Show( std::cout );
+    eachBatched.Show( std::cout );
+    allBatched.Show( std::cout );
+
+    if( actual != batchActual || nearest != batchNearest )
+    {
+        std::cout << "Results differ" << std::endl;
+        return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+/*
+ * Define the tool interface
+ */
+static bool registered = UTILITY_REGISTRY::Register( {
+        "segment_batch",
+        "Benchmark batched segment collisions against SHAPE_LINE_CHAIN::Collide()",
+        segment_batch_bench_func,
+} );
@@ -0,0 +1,591 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcbnew_bench.cpp
+ * Headless benchmark of the expensive board-wide operations: zone filling, DRC and
+ * connectivity building.
+ *
+ * Each board of a fixed corpus (or the boards given on the command line) is loaded and each
+ * phase is run a number of times.  Wall time, CPU time per thread and peak resident memory
+ * are reported as JSON so that runs can be compared by a script.  The connectivity phase also
+ * reports how many items, anchors and anchor blocks the board needs.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <dirent.h>
+#endif
+
+#include <nlohmann/json.hpp>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+#include <wx/init.h>
+
+#include <kiplatform/app.h>
+#include <profile.h>
+#include <thread_pool.h>
+#include <tool/tool_manager.h>
+
+#include <board.h>
+#include <board_commit.h>
+#include <board_design_settings.h>
+#include <connectivity/connectivity_algo.h>
+#include <connectivity/connectivity_data.h>
+#include <drc/drc_engine.h>
+#include <plugins/kicad/pcb_plugin.h>
+#include <settings/settings_manager.h>
+#include <zone.h>
+#include <zone_filler.h>
+
+#include <pcbnew_utils/board_file_utils.h>
+#include <qa_utils/utility_program.h>
+
+
+/**
+ * The default corpus: boards from qa/data/pcbnew which are large enough for the timings to
+ * mean something.  Don't change these lightly; results are only comparable on the same boards.
+ */
+static const std::vector<std::string> g_defaultCorpus =
+{
+    "issue3812",
+    "issue5102",
+    "issue6284",
+    "issue7325",
+    "issue11814",
+};
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "n", "iterations",
+            _( "number of runs of each phase (default 3)" ).mb_str(), wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "p", "phases",
+            _( "comma-separated phases to run: fill, drc, connectivity (default all)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_OPTION, "o", "output", _( "write the JSON results to this file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+            _( "board files, or names of boards in the QA data directory" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum BENCH_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    WRITE_FAILED
+};
+
+
+/**
+ * A snapshot of the process' resource usage, used to measure a phase.
+ */
+struct USAGE_SNAPSHOT
+{
+    /// CPU time (user + system) of each live thread, in ms, keyed by thread id
+    std::map<long, double> m_threadCpuMs;
+
+    static USAGE_SNAPSHOT Take()
+    {
+        USAGE_SNAPSHOT snapshot;
+
+#ifdef __linux__
+        static const double msPerTick = 1000.0 / sysconf( _SC_CLK_TCK );
+
+        if( DIR* dir = opendir( "/proc/self/task" ) )
+        {
+            while( dirent* entry = readdir( dir ) )
+            {
+                if( entry->d_name[0] == '.' )
+                    continue;
+
+                std::ifstream stat( std::string( "/proc/self/task/" ) + entry->d_name + "/stat" );
+                std::string   line;
+
+                if( !std::getline( stat, line ) )
+                    continue;
+
+                // The command name is in parentheses and may contain spaces; utime and stime
+                // are the 12th and 13th fields after it.
+                std::istringstream fields( line.substr( line.rfind( ')' ) + 2 ) );
+                std::string        field;
+                double             ticks = 0.0;
+
+                for( int ii = 0; ii < 13 && fields >> field; ++ii )
+                {
+                    if( ii >= 11 )
+                        ticks += std::stod( field );
+                }
+
+                snapshot.m_threadCpuMs[ std::stol( entry->d_name ) ] = ticks * msPerTick;
+            }
+
+            closedir( dir );
+        }
+#endif
+
+        return snapshot;
+    }
+};
+
+
+/**
+ * Reset the peak resident set size so that the next reading covers only what follows.
+ * Only possible on Linux; elsewhere the peak is that of the whole process so far.
+ */
+static void resetPeakRSS()
+{
+#ifdef __linux__
+    std::ofstream clearRefs( "/proc/self/clear_refs" );
+    clearRefs << "5";
+#endif
+}
+
+
+/**
+ * @return the peak resident set size in kB, or -1 if not known on this platform.
+ */
+static long getPeakRSS()
+{
+#if defined( __linux__ )
+    std::ifstream status( "/proc/self/status" );
+    std::string   line;
+
+    while( std::getline( status, line ) )
+    {
+        if( line.rfind( "VmHWM:", 0 ) == 0 )
+            return std::stol( line.substr( 6 ) );
+    }
+
+    return -1;
+#elif !defined( _WIN32 )
+    rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+
+  #ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+  #else
+    return usage.ru_maxrss;
+  #endif
+#else
+    return -1;
+#endif
+}
+
+
+/**
+ * The results of all the runs of one phase on one board.
+ */
+struct PHASE_RESULT
+{
+    std::vector<double>                        m_wallMs;
+    std::vector<double>                        m_cpuMs;
+    std::vector<std::vector<double>>           m_threadUtilization;
+    long                                       m_peakRSSKb = -1;
+    std::map<std::string, std::vector<double>> m_subPhaseMs;
+    std::map<std::string, size_t>              m_counts;
+
+    void AddSample( double aWallMs, const USAGE_SNAPSHOT& aBefore, const USAGE_SNAPSHOT& aAfter )
+    {
+        std::vector<double> utilization;
+        double              cpuMs = 0.0;
+
+        for( const auto& [ tid, after ] : aAfter.m_threadCpuMs )
+        {
+            auto   it = aBefore.m_threadCpuMs.find( tid );
+            double used = after - ( it == aBefore.m_threadCpuMs.end() ? 0.0 : it->second );
+
+            cpuMs += used;
+
+            if( used > 0.0 && aWallMs > 0.0 )
+                utilization.push_back( std::min( 1.0, used / aWallMs ) );
+        }
+
+        std::sort( utilization.begin(), utilization.end(), std::greater<double>() );
+
+        m_wallMs.push_back( aWallMs );
+        m_cpuMs.push_back( cpuMs );
+        m_threadUtilization.push_back( utilization );
+        m_peakRSSKb = std::max( m_peakRSSKb, getPeakRSS() );
+    }
+};
+
+
+static double median( std::vector<double> aValues )
+{
+    if( aValues.empty() )
+        return 0.0;
+
+    std::sort( aValues.begin(), aValues.end() );
+
+    size_t mid = aValues.size() / 2;
+
+    if( aValues.size() % 2 )
+        return aValues[mid];
+    else
+        return ( aValues[mid - 1] + aValues[mid] ) / 2.0;
+}
+
+
+static nlohmann::json toJson( const std::vector<double>& aSamples )
+{
+    nlohmann::json js;
+
+    js["samples"] = aSamples;
+    js["median"] = median( aSamples );
+    js["min"] = aSamples.empty() ? 0.0 : *std::min_element( aSamples.begin(), aSamples.end() );
+    js["max"] = aSamples.empty() ? 0.0 : *std::max_element( aSamples.begin(), aSamples.end() );
+
+    return js;
+}
+
+
+static nlohmann::json toJson( const PHASE_RESULT& aResult )
+{
+    nlohmann::json js;
+
+    js["wall_ms"] = toJson( aResult.m_wallMs );
+    js["cpu_ms"] = toJson( aResult.m_cpuMs );
+    js["thread_utilization"] = aResult.m_threadUtilization;
+    js["peak_rss_kb"] = aResult.m_peakRSSKb;
+
+    if( !aResult.m_subPhaseMs.empty() )
+    {
+        nlohmann::json& subPhases = js["providers_ms"];
+
+        for( const auto& [ name, samples ] : aResult.m_subPhaseMs )
+            subPhases[name] = toJson( samples );
+    }
+
+    if( !aResult.m_counts.empty() )
+        js["counts"] = aResult.m_counts;
+
+    return js;
+}
+
+
+/**
+ * Load a board (and its project and custom rules, if any) and set up its DRC engine.
+ */
+static std::unique_ptr<BOARD> loadBoard( SETTINGS_MANAGER& aSettingsManager,
+                                         const wxString& aPath )
+{
+    wxFileName boardFile( aPath );
+    wxFileName projectFile( boardFile );
+    wxFileName rulesFile( boardFile );
+
+    projectFile.SetExt( wxT( "kicad_pro" ) );
+    rulesFile.SetExt( wxT( "kicad_dru" ) );
+
+    if( projectFile.Exists() )
+        aSettingsManager.LoadProject( projectFile.GetFullPath() );
+
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        PCB_PLUGIN io;
+        board.reset( io.Load( boardFile.GetFullPath(), nullptr ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << ioe.What().ToStdString() << std::endl;
+        return nullptr;
+    }
+
+    if( !board )
+        return nullptr;
+
+    if( projectFile.Exists() )
+        board->SetProject( &aSettingsManager.Prj() );
+
+    BOARD_DESIGN_SETTINGS& bds = board->GetDesignSettings();
+
+    bds.m_DRCEngine = std::make_shared<DRC_ENGINE>( board.get(), &bds );
+    bds.m_DRCEngine->InitEngine( rulesFile.Exists() ? rulesFile : wxFileName() );
+
+    board->BuildListOfNets();
+    board->BuildConnectivity();
+
+    return board;
+}
+
+
+static PHASE_RESULT benchFill( BOARD* aBoard, long aIterations )
+{
+    PHASE_RESULT result;
+
+    for( long ii = 0; ii < aIterations; ++ii )
+    {
+        TOOL_MANAGER toolMgr;
+        toolMgr.SetEnvironment( aBoard, nullptr, nullptr, nullptr, nullptr );
+
+        BOARD_COMMIT       commit( &toolMgr );
+        ZONE_FILLER        filler( aBoard, &commit );
+        std::vector<ZONE*> toFill;
+
+        for( ZONE* zone : aBoard->Zones() )
+            toFill.push_back( zone );
+
+        resetPeakRSS();
+
+        USAGE_SNAPSHOT before = USAGE_SNAPSHOT::Take();
+        PROF_TIMER     timer;
+
+        bool filled = filler.Fill( toFill, false, nullptr );
+
+        timer.Stop();
+        result.AddSample( timer.msecs(), before, USAGE_SNAPSHOT::Take() );
+
+        if( filled )
+        {
+            commit.Push( _( "Fill Zone(s)" ), SKIP_UNDO | SKIP_SET_DIRTY | ZONE_FILL_OP
+                                                      | SKIP_CONNECTIVITY );
+        }
+    }
+
+    // Leave the board as the other phases would expect to find it
+    aBoard->BuildConnectivity();
+
+    return result;
+}
+
+
+static PHASE_RESULT benchDRC( BOARD* aBoard, long aIterations )
+{
+    PHASE_RESULT                 result;
+    std::shared_ptr<DRC_ENGINE>& engine = aBoard->GetDesignSettings().m_DRCEngine;
+
+    engine->SetViolationHandler(
+            []( const std::shared_ptr<DRC_ITEM>& aItem, VECTOR2I aPos, int aLayer )
+            {
+            } );
+
+    for( long ii = 0; ii < aIterations; ++ii )
+    {
+        resetPeakRSS();
+
+        USAGE_SNAPSHOT before = USAGE_SNAPSHOT::Take();
+        PROF_TIMER     timer;
+
+        engine->RunTests( EDA_UNITS::MILLIMETRES, true, false );
+
+        timer.Stop();
+        result.AddSample( timer.msecs(), before, USAGE_SNAPSHOT::Take() );
+
+        for( const DRC_PROVIDER_STATS& stats : engine->GetProviderStats() )
+            result.m_subPhaseMs[stats.m_Name.ToStdString()].push_back( stats.m_WallTime );
+    }
+
+    return result;
+}
+
+
+static PHASE_RESULT benchConnectivity( BOARD* aBoard, long aIterations )
+{
+    PHASE_RESULT result;
+
+    for( long ii = 0; ii < aIterations; ++ii )
+    {
+        resetPeakRSS();
+
+        USAGE_SNAPSHOT before = USAGE_SNAPSHOT::Take();
+        PROF_TIMER     timer;
+
+        aBoard->GetConnectivity()->Build( aBoard );
+
+        timer.Stop();
+        result.AddSample( timer.msecs(), before, USAGE_SNAPSHOT::Take() );
+    }
+
+    // Every build gives the same counts, so only the last one is looked at
+    const CN_LIST& items = aBoard->GetConnectivity()->GetConnectivityAlgo()->ItemList();
+    size_t         anchors = 0;
+
+    for( const CN_ITEM* item : items )
+        anchors += item->GetAnchorItemCount();
+
+    result.m_counts["items"] = items.Size();
+    result.m_counts["anchors"] = anchors;
+    result.m_counts["anchor_blocks"] = items.AnchorBlockCount();
+
+    return result;
+}
+
+
+static int benchMain( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "Time zone filling, DRC and connectivity building on a set of "
+                               "boards and report the results as JSON." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     iterations = 3;
+    wxString phasesArg = wxT( "fill,drc,connectivity" );
+    wxString outputPath;
+
+    cl_parser.Found( "iterations", &iterations );
+    cl_parser.Found( "phases", &phasesArg );
+    cl_parser.Found( "output", &outputPath );
+
+    if( iterations < 1 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    std::vector<std::string> phases;
+
+    for( const wxString& phase : wxSplit( phasesArg, ',' ) )
+    {
+        if( phase != wxT( "fill" ) && phase != wxT( "drc" ) && phase != wxT( "connectivity" ) )
+        {
+            std::cerr << "Unknown phase: " << phase.ToStdString() << std::endl;
+            return KI_TEST::RET_CODES::BAD_CMDLINE;
+        }
+
+        phases.push_back( phase.ToStdString() );
+    }
+
+    std::vector<wxString> boards;
+
+    for( size_t ii = 0; ii < cl_parser.GetParamCount(); ++ii )
+        boards.push_back( cl_parser.GetParam( ii ) );
+
+    if( boards.empty() )
+    {
+        for( const std::string& name : g_defaultCorpus )
+            boards.push_back( name );
+    }
+
+    SETTINGS_MANAGER settingsManager( true /* headless */ );
+    nlohmann::json   results;
+
+    results["threads"] = GetKiCadThreadPool().get_thread_count();
+    results["hardware_concurrency"] = std::thread::hardware_concurrency();
+    results["iterations"] = iterations;
+
+    for( const wxString& boardArg : boards )
+    {
+        // Bare names refer to boards in the QA data directory
+        wxString path = boardArg;
+
+        if( !path.EndsWith( wxT( ".kicad_pcb" ) ) )
+            path = KI_TEST::GetPcbnewTestDataDir() + boardArg + wxT( ".kicad_pcb" );
+
+        std::cerr << "Loading " << path.ToStdString() << std::endl;
+
+        PROF_TIMER             loadTimer;
+        std::unique_ptr<BOARD> board = loadBoard( settingsManager, path );
+
+        if( !board )
+        {
+            std::cerr << "Failed to load " << path.ToStdString() << std::endl;
+            return BENCH_RET_CODES::LOAD_FAILED;
+        }
+
+        nlohmann::json boardResult;
+
+        boardResult["board"] = wxFileName( path ).GetName().ToStdString();
+        boardResult["load_ms"] = loadTimer.msecs();
+        boardResult["footprints"] = board->Footprints().size();
+        boardResult["tracks"] = board->Tracks().size();
+        boardResult["zones"] = board->Zones().size();
+        boardResult["nets"] = board->GetNetCount();
+
+        for( const std::string& phase : phases )
+        {
+            std::cerr << "  " << phase << std::endl;
+
+            PHASE_RESULT result;
+
+            if( phase == "fill" )
+                result = benchFill( board.get(), iterations );
+            else if( phase == "drc" )
+                result = benchDRC( board.get(), iterations );
+            else if( phase == "connectivity" )
+                result = benchConnectivity( board.get(), iterations );
+
+            boardResult["phases"][phase] = toJson( result );
+        }
+
+        results["boards"].push_back( boardResult );
+
+        board->SetProject( nullptr );
+    }
+
+    if( outputPath.IsEmpty() )
+    {
+        std::cout << results.dump( 2 ) << std::endl;
+    }
+    else
+    {
+        std::ofstream out( outputPath.ToStdString() );
+
+        if( !( out << results.dump( 2 ) << std::endl ) )
+        {
+            std::cerr << "Failed to write " << outputPath.ToStdString() << std::endl;
+            return BENCH_RET_CODES::WRITE_FAILED;
+        }
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+int main( int argc, char** argv )
+{
+    KIPLATFORM::APP::Init();
+
+    if( !wxInitialize( argc, argv ) )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    int ret = benchMain( argc, argv );
+
+    wxUninitialize();
+
+    return ret;
+}
@@ -33,8 +33,10 @@
 
 #include <board.h>
 #include <ignore.h>
+#include <macros.h>
 #include <zone.h>
 #include <profile.h>
+#include <thread_pool.h>
 
 #include <atomic>
 #include <thread>
@@ -202,9 +204,36 @@ aResult->clear();
 enum POLY_TRI_RET_CODES
 {
     LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    MISMATCH,
 };
 
 
+/**
+ * @return the number of triangles in, and the total area of, the triangulation of \a aPoly.
+ */
+static std::pair<size_t, double> triangulationSummary( const SHAPE_POLY_SET& aPoly )
+{
+    size_t count = 0;
+    double area = 0.0;
+
+    for( unsigned ii = 0; ii < aPoly.TriangulatedPolyCount(); ii++ )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = aPoly.TriangulatedPolygon( ii );
+
+        for( size_t jj = 0; jj < tri->GetTriangleCount(); jj++ )
+        {
+            VECTOR2I a, b, c;
+
+            tri->GetTriangle( jj, a, b, c );
+            area += std::abs( (double) ( b - a ).Cross( c - a ) ) / 2.0;
+            count++;
+        }
+    }
+
+    return { count, area };
+}
+
+
 int polygon_triangulation_main( int argc, char *argv[] )
 {
     std::string filename;
@@ -271,6 +300,56 @@ int polygon_triangulation_main( int argc, char *argv[] )
 
     cnt.Show();
 
+    // Now one zone at a time, spreading the cells of each over the thread pool, and check that
+    // this gives the same triangles as doing them one after the other
+    thread_pool& tp = GetKiCadThreadPool();
+    PROF_TIMER   timer;
+    double       serialTime = 0.0;
+    double       pooledTime = 0.0;
+    int          mismatches = 0;
+
+    SHAPE_POLY_SET::TASK_SUBMITTER submitter =
+            [&tp]( const std::function<void()>& aTask )
+            {
+                tp.push_task( aTask );
+            };
+
+    for( ZONE* zone : brd->Zones() )
+    {
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            SHAPE_POLY_SET serial = *zone->GetFilledPolysList( layer );
+            SHAPE_POLY_SET pooled = serial;
+
+            timer.Start();
+            serial.CacheTriangulation();
+            serialTime += timer.msecs();
+
+            timer.Start();
+            pooled.CacheTriangulation( true, submitter );
+            pooledTime += timer.msecs();
+
+            std::pair<size_t, double> expected = triangulationSummary( serial );
+            std::pair<size_t, double> actual = triangulationSummary( pooled );
+
+            if( expected.first != actual.first
+                    || std::abs( expected.second - actual.second ) > 1e-9 * expected.second )
+            {
+                printf( "zone %s, layer %d: %zu triangles (area %g) serially, "
+                        "%zu (area %g) on the thread pool\n",
+                        TO_UTF8( zone->GetZoneName() ), (int) layer, expected.first,
+                        expected.second, actual.first, actual.second );
+                mismatches++;
+            }
+        }
+    }
+
+    printf( "per zone: serial %.1f ms, thread pool (%u threads) %.1f ms\n", serialTime,
+            (unsigned) tp.get_thread_count(), pooledTime );
+
+    if( mismatches )
+        return POLY_TRI_RET_CODES::MISMATCH;
+
     return KI_TEST::RET_CODES::OK;
 }
 
@@ -0,0 +1,414 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pns_log_bench.cpp
+ * Headless benchmark of the router on recorded sessions.
+ *
+ * Replays P&S event logs (as written by the ROUTER_TOOL, together with their board dumps)
+ * without any view or debug decorator, timing each routing event and (when the router is built
+ * with KICAD_PNS_PERF_COUNTERS) counting the work it did for it.  The results are reported as
+ * JSON so that runs can be compared by a script.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <wx/cmdline.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/init.h>
+
+#include <kiplatform/app.h>
+#include <profile.h>
+#include <thread_pool.h>
+
+#include <router/pns_kicad_iface.h>
+#include <router/pns_node.h>
+#include <router/pns_router.h>
+
+#include <qa_utils/utility_program.h>
+
+#include "pns_log_file.h"
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "n", "iterations",
+            _( "number of replays of each log (default 3)" ).mb_str(), wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "o", "output", _( "write the JSON results to this file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr,
+            _( "log files, or directories of log files" ).mb_str(),
+            wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum BENCH_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    WRITE_FAILED
+};
+
+
+/**
+ * The router's work counters, as a snapshot or as the difference between two snapshots.
+ */
+struct WORK_COUNTS
+{
+    unsigned long long m_shoveIterations = 0;
+    unsigned long long m_collisionQueries = 0;
+    unsigned long long m_nodes = 0;
+
+    static WORK_COUNTS Take()
+    {
+        PNS::PERF_COUNTERS& counters = PNS::GetPerfCounters();
+        WORK_COUNTS         counts;
+
+        counts.m_shoveIterations = counters.m_shoveIterations.Count();
+        counts.m_collisionQueries = counters.m_collisionQueries.Count();
+        counts.m_nodes = counters.m_nodes.Count();
+
+        return counts;
+    }
+
+    void Accumulate( const WORK_COUNTS& aBefore, const WORK_COUNTS& aAfter )
+    {
+        m_shoveIterations += aAfter.m_shoveIterations - aBefore.m_shoveIterations;
+        m_collisionQueries += aAfter.m_collisionQueries - aBefore.m_collisionQueries;
+        m_nodes += aAfter.m_nodes - aBefore.m_nodes;
+    }
+};
+
+
+/**
+ * The results of all the replays of one kind of event (or of all events) of a log.
+ */
+struct EVENT_RESULT
+{
+    std::vector<double> m_latencyUs;
+    WORK_COUNTS         m_counts;       ///< summed over all the replays
+
+    void Add( const EVENT_RESULT& aOther )
+    {
+        m_latencyUs.insert( m_latencyUs.end(), aOther.m_latencyUs.begin(),
+                            aOther.m_latencyUs.end() );
+
+        m_counts.m_shoveIterations += aOther.m_counts.m_shoveIterations;
+        m_counts.m_collisionQueries += aOther.m_counts.m_collisionQueries;
+        m_counts.m_nodes += aOther.m_counts.m_nodes;
+    }
+};
+
+
+struct LOG_RESULT
+{
+    std::vector<double>                 m_syncMs;
+    std::map<std::string, EVENT_RESULT> m_events;   ///< by event name
+};
+
+
+static const char* eventName( PNS::LOGGER::EVENT_TYPE aType )
+{
+    switch( aType )
+    {
+    case PNS::LOGGER::EVT_START_ROUTE: return "route-start";
+    case PNS::LOGGER::EVT_START_DRAG:  return "drag-start";
+    case PNS::LOGGER::EVT_FIX:         return "fix";
+    case PNS::LOGGER::EVT_MOVE:        return "move";
+    case PNS::LOGGER::EVT_ABORT:       return "abort";
+    case PNS::LOGGER::EVT_TOGGLE_VIA:  return "toggle-via";
+    default:                           return "unknown";
+    }
+}
+
+
+/**
+ * Nearest-rank percentile of a sorted set of samples.
+ */
+static double percentile( const std::vector<double>& aSorted, double aPercent )
+{
+    if( aSorted.empty() )
+        return 0.0;
+
+    size_t rank = (size_t) std::ceil( aPercent / 100.0 * aSorted.size() );
+
+    return aSorted[ std::clamp<size_t>( rank, 1, aSorted.size() ) - 1 ];
+}
+
+
+static nlohmann::json toJson( const EVENT_RESULT& aResult, long aIterations )
+{
+    std::vector<double> sorted = aResult.m_latencyUs;
+    nlohmann::json      js;
+    double              total = 0.0;
+
+    std::sort( sorted.begin(), sorted.end() );
+
+    for( double sample : sorted )
+        total += sample;
+
+    js["count"] = sorted.size() / aIterations;
+    js["latency_us"]["p50"] = percentile( sorted, 50.0 );
+    js["latency_us"]["p99"] = percentile( sorted, 99.0 );
+    js["latency_us"]["max"] = sorted.empty() ? 0.0 : sorted.back();
+    js["latency_us"]["mean"] = sorted.empty() ? 0.0 : total / sorted.size();
+
+#ifdef PNS_PERF_COUNTERS
+    // Per replay.  Replays are normally identical, but the router's time limits may cut some
+    // of them short.
+    js["shove_iterations"] = (double) aResult.m_counts.m_shoveIterations / aIterations;
+    js["collision_queries"] = (double) aResult.m_counts.m_collisionQueries / aIterations;
+    js["nodes_allocated"] = (double) aResult.m_counts.m_nodes / aIterations;
+#endif
+
+    return js;
+}
+
+
+/**
+ * Replay a log once, on a fresh router, the way PNS_LOG_PLAYER does.
+ */
+static void replayLog( PNS_LOG_FILE& aLog,
+                       const std::map<KIID, BOARD_CONNECTED_ITEM*>& aItemsById,
+                       LOG_RESULT& aResult )
+{
+    PNS_KICAD_IFACE_BASE iface;
+    PNS::ROUTER          router;
+
+    PROF_TIMER syncTimer;
+
+    iface.SetBoard( aLog.GetBoard().get() );
+    router.SetInterface( &iface );
+    router.ClearWorld();
+    router.SetMode( PNS::PNS_MODE_ROUTE_SINGLE );
+    router.SyncWorld();
+
+    syncTimer.Stop();
+    aResult.m_syncMs.push_back( syncTimer.msecs() );
+
+    router.LoadSettings( aLog.GetRoutingSettings() );
+    router.Sizes().SetTrackWidth( 250000 );
+
+    for( const PNS_LOG_FILE::EVENT_ENTRY& evt : aLog.Events() )
+    {
+        auto       it = aItemsById.find( evt.uuid );
+        PNS::ITEM* ritem = nullptr;
+
+        if( it != aItemsById.end() )
+            ritem = router.GetWorld()->FindItemByParent( it->second );
+
+        EVENT_RESULT& result = aResult.m_events[ eventName( evt.type ) ];
+        WORK_COUNTS   before = WORK_COUNTS::Take();
+        PROF_TIMER    timer;
+
+        switch( evt.type )
+        {
+        case PNS::LOGGER::EVT_START_ROUTE:
+            router.StartRouting( evt.p, ritem, ritem ? ritem->Layers().Start() : F_Cu );
+            break;
+
+        case PNS::LOGGER::EVT_START_DRAG:
+            router.StartDragging( evt.p, ritem, 0 );
+            break;
+
+        case PNS::LOGGER::EVT_FIX:
+            router.FixRoute( evt.p, ritem );
+            break;
+
+        case PNS::LOGGER::EVT_MOVE:
+            router.Move( evt.p, ritem );
+            break;
+
+        case PNS::LOGGER::EVT_TOGGLE_VIA:
+            router.ToggleViaPlacement();
+            break;
+
+        default:
+            break;
+        }
+
+        timer.Stop();
+
+        using DUR_US = std::chrono::duration<double, std::micro>;
+
+        result.m_latencyUs.push_back( timer.SinceStart<DUR_US>().count() );
+        result.m_counts.Accumulate( before, WORK_COUNTS::Take() );
+    }
+
+    router.StopRouting();
+    iface.SetBoard( nullptr );
+}
+
+
+/**
+ * Collect the logs named on the command line, expanding directories to the logs in them.
+ */
+static std::vector<wxFileName> findLogs( const wxCmdLineParser& aParser )
+{
+    std::vector<wxFileName> logs;
+
+    for( size_t ii = 0; ii < aParser.GetParamCount(); ++ii )
+    {
+        wxString param = aParser.GetParam( ii );
+
+        if( wxDir::Exists( param ) )
+        {
+            wxArrayString files;
+            wxDir::GetAllFiles( param, &files, wxT( "*.log" ), wxDIR_FILES );
+            files.Sort();
+
+            for( const wxString& file : files )
+                logs.emplace_back( file );
+        }
+        else
+        {
+            logs.emplace_back( param );
+        }
+    }
+
+    return logs;
+}
+
+
+static int benchMain( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "Replay P&S event logs without a view and report the router's "
+                               "per-event latency and work counts as JSON." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long     iterations = 3;
+    wxString outputPath;
+
+    cl_parser.Found( "iterations", &iterations );
+    cl_parser.Found( "output", &outputPath );
+
+    if( iterations < 1 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    nlohmann::json results;
+    EVENT_RESULT   overall;
+    int            ret = KI_TEST::RET_CODES::OK;
+
+    results["threads"] = GetKiCadThreadPool().get_thread_count();
+    results["hardware_concurrency"] = std::thread::hardware_concurrency();
+    results["iterations"] = iterations;
+    results["logs"] = nlohmann::json::array();
+
+    for( const wxFileName& logName : findLogs( cl_parser ) )
+    {
+        std::cerr << "Replaying " << logName.GetFullPath().ToStdString() << std::endl;
+
+        PNS_LOG_FILE logFile;
+
+        if( !logFile.Load( logName ) || !logFile.GetBoard() )
+        {
+            std::cerr << "Failed to load " << logName.GetFullPath().ToStdString() << std::endl;
+            ret = BENCH_RET_CODES::LOAD_FAILED;
+            continue;
+        }
+
+        // PNS_LOG_FILE::ItemById() is a linear search; keep that out of the timings
+        std::map<KIID, BOARD_CONNECTED_ITEM*> itemsById;
+
+        for( BOARD_CONNECTED_ITEM* item : logFile.GetBoard()->AllConnectedItems() )
+            itemsById[item->m_Uuid] = item;
+
+        LOG_RESULT result;
+
+        for( long ii = 0; ii < iterations; ++ii )
+            replayLog( logFile, itemsById, result );
+
+        nlohmann::json logResult;
+        EVENT_RESULT   all;
+
+        logResult["log"] = logName.GetName().ToStdString();
+        logResult["events"] = logFile.Events().size();
+        logResult["sync_ms"] = result.m_syncMs;
+
+        for( const auto& [ name, eventResult ] : result.m_events )
+        {
+            logResult["by_event"][name] = toJson( eventResult, iterations );
+            all.Add( eventResult );
+        }
+
+        logResult["all"] = toJson( all, iterations );
+        overall.Add( all );
+
+        results["logs"].push_back( logResult );
+    }
+
+    results["all"] = toJson( overall, iterations );
+
+    if( outputPath.IsEmpty() )
+    {
+        std::cout << results.dump( 2 ) << std::endl;
+    }
+    else
+    {
+        std::ofstream out( outputPath.ToStdString() );
+
+        if( !( out << results.dump( 2 ) << std::endl ) )
+        {
+            std::cerr << "Failed to write " << outputPath.ToStdString() << std::endl;
+            return BENCH_RET_CODES::WRITE_FAILED;
+        }
+    }
+
+    return ret;
+}
+
+
+int main( int argc, char** argv )
+{
+    KIPLATFORM::APP::Init();
+
+    if( !wxInitialize( argc, argv ) )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    int ret = benchMain( argc, argv );
+
+    wxUninitialize();
+
+    return ret;
+}
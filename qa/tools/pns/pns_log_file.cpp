@@ -78,7 +78,7 @@ bool PNS_LOG_FILE::Load( const wxFileName& logFileName )
 
     FILE* f = fopen( fname_log.GetFullPath().c_str(), "rb" );
 
-    printf("Loading dump from '%s'\n", (const char*) fname_log.GetFullPath().c_str() );
+    fprintf( stderr, "Loading dump from '%s'\n", (const char*) fname_log.GetFullPath().c_str() );
 
     if( !f )
         return false;
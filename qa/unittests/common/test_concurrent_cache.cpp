@@ -0,0 +1,124 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <concurrent_cache.h>
+#include <thread_pool.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE( ConcurrentCache )
+
+
+BOOST_AUTO_TEST_CASE( FindAndSet )
+{
+    CONCURRENT_CACHE<int, int> cache;
+    int                        value = 0;
+
+    BOOST_CHECK( !cache.Find( 1, value ) );
+
+    cache.Set( 1, 10 );
+    cache.Set( 2, 20 );
+
+    BOOST_CHECK( cache.Find( 1, value ) );
+    BOOST_CHECK_EQUAL( value, 10 );
+
+    cache.Set( 1, 11 );
+
+    BOOST_CHECK( cache.Find( 1, value ) );
+    BOOST_CHECK_EQUAL( value, 11 );
+    BOOST_CHECK_EQUAL( cache.Size(), 2 );
+
+    BOOST_CHECK_EQUAL( cache.GetHits(), 2 );
+    BOOST_CHECK_EQUAL( cache.GetMisses(), 1 );
+
+    cache.Clear();
+
+    BOOST_CHECK_EQUAL( cache.Size(), 0 );
+    BOOST_CHECK( !cache.Find( 1, value ) );
+
+    cache.ResetStats();
+
+    BOOST_CHECK_EQUAL( cache.GetHits(), 0 );
+    BOOST_CHECK_EQUAL( cache.GetMisses(), 0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( GetOrCompute )
+{
+    CONCURRENT_CACHE<int, int> cache;
+    int                        calls = 0;
+
+    auto square =
+            [&]( int aKey )
+            {
+                return cache.GetOrCompute( aKey,
+                        [&]()
+                        {
+                            calls++;
+                            return aKey * aKey;
+                        } );
+            };
+
+    BOOST_CHECK_EQUAL( square( 3 ), 9 );
+    BOOST_CHECK_EQUAL( square( 3 ), 9 );
+    BOOST_CHECK_EQUAL( square( 4 ), 16 );
+    BOOST_CHECK_EQUAL( calls, 2 );
+}
+
+
+BOOST_AUTO_TEST_CASE( Threaded )
+{
+    CONCURRENT_CACHE<int, int>    cache;
+    std::atomic<int>              mismatches( 0 );
+    thread_pool&                  tp = GetKiCadThreadPool();
+    std::vector<std::future<int>> returns;
+
+    // Every task looks up the same small set of keys so that threads race on both
+    // computing and reading entries.
+    for( int task = 0; task < 16; ++task )
+    {
+        returns.emplace_back( tp.submit(
+                [&]() -> int
+                {
+                    for( int ii = 0; ii < 10000; ++ii )
+                    {
+                        int key = ii % 257;
+
+                        if( cache.GetOrCompute( key, [key]() { return key * 3; } ) != key * 3 )
+                            mismatches++;
+                    }
+
+                    return 0;
+                } ) );
+    }
+
+    for( std::future<int>& ret : returns )
+        ret.wait();
+
+    BOOST_CHECK_EQUAL( mismatches.load(), 0 );
+    BOOST_CHECK_EQUAL( cache.Size(), 257 );
+    BOOST_CHECK_EQUAL( cache.GetHits() + cache.GetMisses(), 16 * 10000 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <task_graph.h>
+
+#include <mutex>
+#include <stdexcept>
+
+
+BOOST_AUTO_TEST_SUITE( TaskGraph )
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    TASK_GRAPH graph( GetKiCadThreadPool() );
+
+    BOOST_CHECK( graph.Run() );
+}
+
+
+BOOST_AUTO_TEST_CASE( ChainOrder )
+{
+    TASK_GRAPH                       graph( GetKiCadThreadPool() );
+    std::vector<TASK_GRAPH::TASK_ID> ids;
+    std::vector<int>                 order;
+    std::mutex                       orderLock;
+
+    for( int ii = 0; ii < 20; ++ii )
+    {
+        ids.push_back( graph.AddTask( [&, ii]()
+                                      {
+                                          std::lock_guard<std::mutex> lock( orderLock );
+                                          order.push_back( ii );
+                                      } ) );
+    }
+
+    // Add the dependencies in reverse to make sure insertion order doesn't matter
+    for( int ii = 19; ii > 0; --ii )
+        graph.AddDependency( ids[ii], ids[ii - 1] );
+
+    BOOST_CHECK( graph.Run() );
+    BOOST_REQUIRE_EQUAL( order.size(), 20 );
+
+    for( int ii = 0; ii < 20; ++ii )
+        BOOST_CHECK_EQUAL( order[ii], ii );
+}
+
+
+BOOST_AUTO_TEST_CASE( Diamond )
+{
+    TASK_GRAPH       graph( GetKiCadThreadPool() );
+    std::atomic<int> leftDone( 0 );
+    std::atomic<int> rightDone( 0 );
+    std::atomic<int> joinSaw( 0 );
+
+    TASK_GRAPH::TASK_ID root = graph.AddTask( []() {} );
+    TASK_GRAPH::TASK_ID left = graph.AddTask( [&]() { leftDone = 1; } );
+    TASK_GRAPH::TASK_ID right = graph.AddTask( [&]() { rightDone = 1; } );
+    TASK_GRAPH::TASK_ID join = graph.AddTask( [&]() { joinSaw = leftDone + rightDone; } );
+
+    graph.AddDependency( left, root );
+    graph.AddDependency( right, root );
+    graph.AddDependency( join, left );
+    graph.AddDependency( join, right );
+
+    BOOST_CHECK( graph.Run() );
+    BOOST_CHECK_EQUAL( joinSaw.load(), 2 );
+}
+
+
+BOOST_AUTO_TEST_CASE( Cancel )
+{
+    TASK_GRAPH       graph( GetKiCadThreadPool() );
+    std::atomic<int> ran( 0 );
+
+    TASK_GRAPH::TASK_ID first = graph.AddTask( [&]() { graph.Cancel(); } );
+    TASK_GRAPH::TASK_ID second = graph.AddTask( [&]() { ran++; } );
+
+    graph.AddDependency( second, first );
+
+    BOOST_CHECK( !graph.Run() );
+    BOOST_CHECK_EQUAL( ran.load(), 0 );
+}
+
+
+BOOST_AUTO_TEST_CASE( Exception )
+{
+    TASK_GRAPH graph( GetKiCadThreadPool() );
+
+    graph.AddTask( []() { throw std::runtime_error( "task failed" ); } );
+
+    BOOST_CHECK_THROW( graph.Run(), std::runtime_error );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
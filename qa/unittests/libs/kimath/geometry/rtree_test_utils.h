@@ -0,0 +1,107 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RTREE_TEST_UTILS_H
+#define RTREE_TEST_UTILS_H
+
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+/**
+ * @brief Utility functions shared by the R-tree tests.
+ */
+namespace RTREE_TEST
+{
+
+struct BOX
+{
+    int      m_min[2];
+    int      m_max[2];
+    intptr_t m_id;
+};
+
+
+/**
+ * Make \a aCount small boxes scattered over a 100000 square, numbered from 0.  The same count
+ * always gives the same boxes.
+ */
+inline std::vector<BOX> RandomBoxes( size_t aCount )
+{
+    std::mt19937     rng( 42 );
+    std::vector<BOX> boxes;
+
+    for( size_t ii = 0; ii < aCount; ++ii )
+    {
+        int x = rng() % 100000;
+        int y = rng() % 100000;
+        int w = rng() % 1000;
+        int h = rng() % 1000;
+
+        boxes.push_back( { { x, y }, { x + w, y + h }, (intptr_t) ii } );
+    }
+
+    return boxes;
+}
+
+
+/**
+ * The ids of all of \a aBoxes which touch the box from \a aMin to \a aMax.
+ */
+inline std::set<intptr_t> BruteForceSearch( const std::vector<BOX>& aBoxes, const int aMin[2],
+                                            const int aMax[2] )
+{
+    std::set<intptr_t> found;
+
+    for( const BOX& box : aBoxes )
+    {
+        if( box.m_min[0] <= aMax[0] && box.m_max[0] >= aMin[0]
+                && box.m_min[1] <= aMax[1] && box.m_max[1] >= aMin[1] )
+        {
+            found.insert( box.m_id );
+        }
+    }
+
+    return found;
+}
+
+
+/**
+ * The ids \a aTree finds in the box from \a aMin to \a aMax, to compare with BruteForceSearch().
+ */
+template <typename TREE>
+std::set<intptr_t> TreeSearch( const TREE& aTree, const int aMin[2], const int aMax[2] )
+{
+    std::set<intptr_t> found;
+
+    auto visitor =
+            [&]( intptr_t aId ) -> bool
+            {
+                found.insert( aId );
+                return true;
+            };
+
+    aTree.Search( aMin, aMax, visitor );
+    return found;
+}
+
+} // namespace RTREE_TEST
+
+#endif // RTREE_TEST_UTILS_H
@@ -0,0 +1,168 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <climits>
+#include <random>
+#include <set>
+
+#include <geometry/packed_rtree.h>
+
+#include "rtree_test_utils.h"
+
+
+typedef PACKED_RTREE<intptr_t> TEST_PACKED_RTREE;
+
+
+struct PACKED_RTREE_FIXTURE
+{
+    PACKED_RTREE_FIXTURE( size_t aCount ) :
+            m_boxes( RTREE_TEST::RandomBoxes( aCount ) )
+    {}
+
+    std::vector<TEST_PACKED_RTREE::ENTRY> Entries() const
+    {
+        std::vector<TEST_PACKED_RTREE::ENTRY> entries;
+
+        for( const RTREE_TEST::BOX& box : m_boxes )
+        {
+            entries.push_back( { { box.m_min[0], box.m_min[1] }, { box.m_max[0], box.m_max[1] },
+                                 box.m_id } );
+        }
+
+        return entries;
+    }
+
+    std::set<intptr_t> BruteForce( const int aMin[2], const int aMax[2] ) const
+    {
+        return RTREE_TEST::BruteForceSearch( m_boxes, aMin, aMax );
+    }
+
+    std::vector<RTREE_TEST::BOX> m_boxes;
+};
+
+
+BOOST_AUTO_TEST_SUITE( PackedRTree )
+
+
+BOOST_AUTO_TEST_CASE( BuildSearch )
+{
+    // Sizes around the fanout exercise partial nodes and extra levels
+    for( size_t count : { 0, 1, 7, 8, 9, 64, 65, 513, 5000 } )
+    {
+        BOOST_TEST_CONTEXT( count << " entries" )
+        {
+            PACKED_RTREE_FIXTURE fixture( count );
+            TEST_PACKED_RTREE    tree;
+
+            std::vector<TEST_PACKED_RTREE::ENTRY> entries = fixture.Entries();
+            tree.Build( entries );
+
+            BOOST_CHECK_EQUAL( tree.Size(), count );
+
+            std::mt19937 rng( 7 );
+
+            for( int ii = 0; ii < 100; ++ii )
+            {
+                int x = rng() % 100000;
+                int y = rng() % 100000;
+                int min[2] = { x, y };
+                int max[2] = { x + 5000, y + 5000 };
+
+                BOOST_CHECK( RTREE_TEST::TreeSearch( tree, min, max )
+                             == fixture.BruteForce( min, max ) );
+            }
+
+            std::set<intptr_t> all;
+            tree.ForEach( [&]( intptr_t aId ) { all.insert( aId ); } );
+            BOOST_CHECK_EQUAL( all.size(), count );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( Remove )
+{
+    PACKED_RTREE_FIXTURE fixture( 1000 );
+    TEST_PACKED_RTREE    tree;
+
+    std::vector<TEST_PACKED_RTREE::ENTRY> entries = fixture.Entries();
+    tree.Build( entries );
+
+    for( size_t ii = 0; ii < 500; ++ii )
+    {
+        const RTREE_TEST::BOX& box = fixture.m_boxes[ii];
+        BOOST_CHECK( tree.Remove( box.m_min, box.m_max, box.m_id ) );
+    }
+
+    // Gone already, and never there
+    const RTREE_TEST::BOX& first = fixture.m_boxes[0];
+    BOOST_CHECK( !tree.Remove( first.m_min, first.m_max, first.m_id ) );
+    BOOST_CHECK( !tree.Remove( first.m_min, first.m_max, 12345 ) );
+
+    // With the wrong box it's only found by looking for it everywhere
+    const RTREE_TEST::BOX& moved = fixture.m_boxes[500];
+    int movedMin[2] = { moved.m_min[0] + 1, moved.m_min[1] };
+    BOOST_CHECK( !tree.Remove( movedMin, moved.m_max, moved.m_id ) );
+    BOOST_CHECK( tree.Remove( moved.m_id ) );
+    BOOST_CHECK( !tree.Remove( moved.m_id ) );
+    BOOST_CHECK( !tree.Remove( first.m_id ) );
+
+    fixture.m_boxes.erase( fixture.m_boxes.begin(), fixture.m_boxes.begin() + 501 );
+
+    BOOST_CHECK_EQUAL( tree.Size(), 499 );
+    BOOST_CHECK_EQUAL( tree.RemovedCount(), 501 );
+
+    // Removed entries mustn't turn up even in a query covering everything
+    int min[2] = { INT_MIN, INT_MIN };
+    int max[2] = { INT_MAX, INT_MAX };
+    BOOST_CHECK( RTREE_TEST::TreeSearch( tree, min, max )
+                 == fixture.BruteForce( min, max ) );
+
+    tree.Clear();
+    BOOST_CHECK_EQUAL( tree.Size(), 0 );
+    BOOST_CHECK( RTREE_TEST::TreeSearch( tree, min, max ).empty() );
+}
+
+
+BOOST_AUTO_TEST_CASE( StopSearch )
+{
+    PACKED_RTREE_FIXTURE fixture( 1000 );
+    TEST_PACKED_RTREE    tree;
+
+    std::vector<TEST_PACKED_RTREE::ENTRY> entries = fixture.Entries();
+    tree.Build( entries );
+
+    int calls = 0;
+    int min[2] = { INT_MIN, INT_MIN };
+    int max[2] = { INT_MAX, INT_MAX };
+
+    auto visitor =
+            [&]( intptr_t aId ) -> bool
+            {
+                return ++calls < 10;
+            };
+
+    BOOST_CHECK_EQUAL( tree.Search( min, max, visitor ), 9 );
+    BOOST_CHECK_EQUAL( calls, 10 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <climits>
+#include <random>
+#include <set>
+
+#include <geometry/rtree.h>
+
+#include "rtree_test_utils.h"
+
+
+typedef RTree<intptr_t, int, 2, double> TEST_RTREE;
+
+
+struct RTREE_FIXTURE
+{
+    RTREE_FIXTURE( size_t aCount ) :
+            m_boxes( RTREE_TEST::RandomBoxes( aCount ) )
+    {}
+
+    std::vector<std::pair<TEST_RTREE::Rect, intptr_t>> Entries() const
+    {
+        std::vector<std::pair<TEST_RTREE::Rect, intptr_t>> entries;
+
+        for( const RTREE_TEST::BOX& box : m_boxes )
+        {
+            entries.push_back( { { { box.m_min[0], box.m_min[1] },
+                                   { box.m_max[0], box.m_max[1] } },
+                                 box.m_id } );
+        }
+
+        return entries;
+    }
+
+    std::set<intptr_t> BruteForce( const TEST_RTREE::Rect& aRect ) const
+    {
+        return RTREE_TEST::BruteForceSearch( m_boxes, aRect.m_min, aRect.m_max );
+    }
+
+    static std::set<intptr_t> Search( const TEST_RTREE& aTree, const TEST_RTREE::Rect& aRect )
+    {
+        return RTREE_TEST::TreeSearch( aTree, aRect.m_min, aRect.m_max );
+    }
+
+    std::vector<RTREE_TEST::BOX> m_boxes;
+};
+
+
+BOOST_AUTO_TEST_SUITE( RTreeBulkLoad )
+
+
+BOOST_AUTO_TEST_CASE( BulkLoadSearch )
+{
+    // Sizes around the node capacity exercise partial nodes and extra levels
+    for( size_t count : { 0, 1, 7, 8, 9, 64, 65, 5000 } )
+    {
+        BOOST_TEST_CONTEXT( count << " entries" )
+        {
+            RTREE_FIXTURE fixture( count );
+            TEST_RTREE    tree;
+
+            std::vector<std::pair<TEST_RTREE::Rect, intptr_t>> entries = fixture.Entries();
+            tree.BulkLoad( entries );
+
+            BOOST_CHECK_EQUAL( tree.Count(), (int) count );
+
+            std::mt19937 rng( 7 );
+
+            for( int ii = 0; ii < 100; ++ii )
+            {
+                int              x = rng() % 100000;
+                int              y = rng() % 100000;
+                TEST_RTREE::Rect query = { { x, y }, { x + 5000, y + 5000 } };
+
+                BOOST_CHECK( RTREE_FIXTURE::Search( tree, query ) == fixture.BruteForce( query ) );
+            }
+
+            std::set<intptr_t> all( tree.begin(), tree.end() );
+            BOOST_CHECK_EQUAL( all.size(), count );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( BulkLoadThenModify )
+{
+    RTREE_FIXTURE fixture( 1000 );
+    TEST_RTREE    tree;
+
+    std::vector<std::pair<TEST_RTREE::Rect, intptr_t>> entries = fixture.Entries();
+    tree.BulkLoad( entries );
+
+    // Packed nodes must be able to be split, condensed and freed like any others
+    for( size_t ii = 0; ii < 500; ++ii )
+    {
+        const RTREE_TEST::BOX& box = fixture.m_boxes[ii];
+        BOOST_CHECK( !tree.Remove( box.m_min, box.m_max, box.m_id ) );
+    }
+
+    fixture.m_boxes.erase( fixture.m_boxes.begin(), fixture.m_boxes.begin() + 500 );
+
+    for( intptr_t ii = 0; ii < 200; ++ii )
+    {
+        RTREE_TEST::BOX box = { { 0, 0 }, { 100, 100 }, 10000 + ii };
+        tree.Insert( box.m_min, box.m_max, box.m_id );
+        fixture.m_boxes.push_back( box );
+    }
+
+    BOOST_CHECK_EQUAL( tree.Count(), 700 );
+
+    TEST_RTREE::Rect everything = { { INT_MIN, INT_MIN }, { INT_MAX, INT_MAX } };
+    BOOST_CHECK( RTREE_FIXTURE::Search( tree, everything ) == fixture.BruteForce( everything ) );
+
+    tree.RemoveAll();
+    BOOST_CHECK_EQUAL( tree.Count(), 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
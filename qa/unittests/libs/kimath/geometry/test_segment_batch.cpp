@@ -0,0 +1,364 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+
+#include <cmath>
+#include <random>
+
+#include <geometry/segment_batch.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+#include <math/util.h>
+
+
+struct SEGMENT_BATCH_FIXTURE
+{
+    SEGMENT_BATCH_FIXTURE() :
+            m_rng( 42 )
+    {}
+
+    int Coord( int aRange )
+    {
+        return (int) ( m_rng() % ( 2 * aRange + 1 ) ) - aRange;
+    }
+
+    SEG RandomSeg( int aRange, int aLength )
+    {
+        VECTOR2I a( Coord( aRange ), Coord( aRange ) );
+
+        return SEG( a, a + VECTOR2I( Coord( aLength ), Coord( aLength ) ) );
+    }
+
+    VECTOR2I RingPoint( int aRadius, double aDegrees )
+    {
+        double angle = aDegrees * M_PI / 180.0;
+
+        return VECTOR2I( KiROUND( aRadius * cos( angle ) ), KiROUND( aRadius * sin( angle ) ) );
+    }
+
+    /**
+     * A closed, jagged ring of about \a aCount points, optionally ending in an arc.
+     */
+    SHAPE_LINE_CHAIN RandomRing( int aCount, int aRadius, bool aArc )
+    {
+        SHAPE_LINE_CHAIN chain;
+        double           sweep = aArc ? 270.0 : 360.0;
+
+        for( int ii = 0; ii < aCount; ++ii )
+            chain.Append( RingPoint( aRadius + Coord( aRadius / 20 ), sweep * ii / aCount ) );
+
+        if( aArc )
+        {
+            chain.Append( SHAPE_ARC( RingPoint( aRadius, 275.0 ), RingPoint( aRadius, 315.0 ),
+                                     RingPoint( aRadius, 355.0 ), 0 ) );
+        }
+
+        chain.SetClosed( true );
+        return chain;
+    }
+
+    std::mt19937 m_rng;
+};
+
+
+/**
+ * Chain to chain collisions as shape_collisions.cpp did them before it packed the chains.
+ */
+static bool referenceCollide( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB,
+                              int aClearance, int* aActual, VECTOR2I* aLocation )
+{
+    int      closest_dist = INT_MAX;
+    VECTOR2I nearest;
+
+    if( aB.IsClosed() && aA.PointCount() > 0 && aB.PointInside( aA.CPoint( 0 ) ) )
+    {
+        closest_dist = 0;
+        nearest = aA.CPoint( 0 );
+    }
+    else
+    {
+        for( int i = 0; i < aB.SegmentCount(); i++ )
+        {
+            int      collision_dist = 0;
+            VECTOR2I pn;
+
+            if( aB.IsArcSegment( i ) )
+                continue;
+
+            if( aA.Collide( aB.CSegment( i ), aClearance,
+                            aActual || aLocation ? &collision_dist : nullptr,
+                            aLocation ? &pn : nullptr ) )
+            {
+                if( collision_dist < closest_dist )
+                {
+                    nearest = pn;
+                    closest_dist = collision_dist;
+                }
+
+                if( closest_dist == 0 || !aActual )
+                    break;
+            }
+        }
+
+        for( size_t i = 0; i < aB.ArcCount(); i++ )
+        {
+            if( aB.Arc( i ).Collide( &aA, aClearance, aActual, aLocation ) )
+                return true;
+        }
+    }
+
+    if( closest_dist == 0 || closest_dist < aClearance )
+    {
+        if( aLocation )
+            *aLocation = nearest;
+
+        if( aActual )
+            *aActual = closest_dist;
+
+        return true;
+    }
+
+    return false;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( SegmentBatch, SEGMENT_BATCH_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( NearestSegment )
+{
+    // Sizes around the lane count exercise the padding
+    for( int count : { 0, 1, 7, 8, 9, 100 } )
+    {
+        BOOST_TEST_CONTEXT( count << " segments" )
+        {
+            SEGMENT_BATCH    batch;
+            std::vector<SEG> segs;
+
+            for( int ii = 0; ii < count; ++ii )
+            {
+                segs.push_back( RandomSeg( 100000, 20000 ) );
+                batch.Add( segs.back() );
+            }
+
+            for( int ii = 0; ii < 200; ++ii )
+            {
+                SEG         query = RandomSeg( 100000, 20000 );
+                SEG::ecoord limit = SEG::Square( Coord( 30000 ) );
+                SEG::ecoord best = VECTOR2I::ECOORD_MAX;
+                int         expected = -1;
+                int         first = -1;
+
+                for( int jj = 0; jj < count; ++jj )
+                {
+                    SEG::ecoord dist = segs[jj].SquaredDistance( query );
+
+                    if( dist == 0 || dist < limit )
+                    {
+                        if( first < 0 )
+                            first = jj;
+
+                        if( dist < best )
+                        {
+                            best = dist;
+                            expected = jj;
+                        }
+                    }
+                }
+
+                SEG::ecoord dist = -1;
+
+                BOOST_CHECK_EQUAL( batch.NearestSegment( query, limit, false, &dist ), expected );
+
+                if( expected >= 0 )
+                    BOOST_CHECK_EQUAL( dist, best );
+
+                BOOST_CHECK_EQUAL( batch.NearestSegment( query, limit, true ), first );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( ChainCollideSegments )
+{
+    for( bool arc : { false, true } )
+    {
+        BOOST_TEST_CONTEXT( ( arc ? "with" : "without" ) << " an arc" )
+        {
+            SHAPE_LINE_CHAIN chain = RandomRing( 200, 100000, arc );
+            SHAPE_LINE_CHAIN open = chain;
+
+            open.SetClosed( false );
+
+            for( int ii = 0; ii < 500; ++ii )
+            {
+                SEG query = RandomSeg( 130000, 20000 );
+                int clearance = ii % 10 == 0 ? 0 : Coord( 5000 ) + 5000;
+
+                for( const SHAPE_LINE_CHAIN* shape : { &chain, &open } )
+                {
+                    int      actual = -1, batchActual = -1;
+                    VECTOR2I location, batchLocation;
+
+                    BOOST_CHECK_EQUAL( shape->Collide( query, clearance ),
+                                       shape->CollideSegments( { query }, clearance ) );
+
+                    bool hit = shape->Collide( query, clearance, &actual, &location );
+
+                    BOOST_CHECK_EQUAL( hit, shape->CollideSegments( { query }, clearance,
+                                                                    &batchActual,
+                                                                    &batchLocation ) );
+
+                    if( hit )
+                    {
+                        BOOST_CHECK_EQUAL( actual, batchActual );
+                        BOOST_CHECK_EQUAL( location, batchLocation );
+                    }
+                }
+            }
+
+            // Several segments at once give the nearest collision of any of them
+            for( int ii = 0; ii < 50; ++ii )
+            {
+                std::vector<SEG> segs;
+                int              expected = INT_MAX;
+
+                for( int jj = 0; jj < 10; ++jj )
+                {
+                    int actual;
+
+                    segs.push_back( RandomSeg( 130000, 20000 ) );
+
+                    if( open.Collide( segs.back(), 3000, &actual ) )
+                        expected = std::min( expected, actual );
+                }
+
+                int actual = -1;
+
+                BOOST_CHECK_EQUAL( open.CollideSegments( segs, 3000, &actual ),
+                                   expected != INT_MAX );
+
+                if( expected != INT_MAX )
+                    BOOST_CHECK_EQUAL( actual, expected );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( ChainToChain )
+{
+    SHAPE_LINE_CHAIN chain = RandomRing( 200, 100000, true );
+
+    for( int ii = 0; ii < 300; ++ii )
+    {
+        SHAPE_LINE_CHAIN other;
+
+        for( int jj = 0; jj < 4; ++jj )
+            other.Append( RandomSeg( 130000, 20000 ).A );
+
+        other.SetClosed( ii % 2 == 0 );
+
+        int clearance = ii % 10 == 0 ? 0 : Coord( 5000 ) + 5000;
+
+        // Both ways round, as only a long first chain is packed
+        for( bool swap : { false, true } )
+        {
+            const SHAPE_LINE_CHAIN& a = swap ? other : chain;
+            const SHAPE_LINE_CHAIN& b = swap ? chain : other;
+            const SHAPE&            shape = a;
+            int                     actual = -1, expectedActual = -1;
+            VECTOR2I                location, expectedLocation;
+
+            BOOST_CHECK_EQUAL( shape.Collide( &b, clearance ),
+                               referenceCollide( a, b, clearance, nullptr, nullptr ) );
+
+            // Just the location gives the first collision found, not the nearest
+            bool hit = referenceCollide( a, b, clearance, nullptr, &expectedLocation );
+
+            BOOST_CHECK_EQUAL( shape.Collide( &b, clearance, nullptr, &location ), hit );
+
+            if( hit )
+                BOOST_CHECK_EQUAL( location, expectedLocation );
+
+            hit = referenceCollide( a, b, clearance, &expectedActual, &expectedLocation );
+
+            BOOST_CHECK_EQUAL( shape.Collide( &b, clearance, &actual, &location ), hit );
+
+            if( hit )
+            {
+                BOOST_CHECK_EQUAL( actual, expectedActual );
+                BOOST_CHECK_EQUAL( location, expectedLocation );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( PolySetToChain )
+{
+    SHAPE_POLY_SET polySet( RandomRing( 200, 100000, false ) );
+
+    polySet.AddHole( RandomRing( 50, 40000, false ) );
+
+    for( int ii = 0; ii < 300; ++ii )
+    {
+        SHAPE_LINE_CHAIN chain;
+
+        for( int jj = 0; jj < 4; ++jj )
+            chain.Append( RandomSeg( 130000, 20000 ).A );
+
+        int clearance = ii % 10 == 0 ? 0 : Coord( 5000 ) + 5000;
+        int expected = INT_MAX;
+
+        for( int jj = 0; jj < chain.SegmentCount(); ++jj )
+        {
+            int actual;
+
+            if( polySet.Collide( chain.CSegment( jj ), clearance, &actual ) )
+                expected = std::min( expected, actual );
+        }
+
+        const SHAPE& shape = polySet;
+        int          actual = -1;
+
+        BOOST_CHECK_EQUAL( shape.Collide( &chain, clearance ), expected != INT_MAX );
+        BOOST_CHECK_EQUAL( shape.Collide( &chain, clearance, &actual ), expected != INT_MAX );
+
+        if( expected != INT_MAX )
+            BOOST_CHECK_EQUAL( actual, expected );
+    }
+
+    // A closed chain around all of the polygons collides without crossing any of their edges
+    SHAPE_LINE_CHAIN around( { VECTOR2I( -200000, -200000 ), VECTOR2I( 200000, -200000 ),
+                               VECTOR2I( 200000, 200000 ), VECTOR2I( -200000, 200000 ) },
+                             true );
+    int actual = -1;
+
+    BOOST_CHECK( static_cast<const SHAPE&>( polySet ).Collide( &around, 0, &actual ) );
+    BOOST_CHECK_EQUAL( actual, 0 );
+
+    around.SetClosed( false );
+    BOOST_CHECK( !static_cast<const SHAPE&>( polySet ).Collide( &around, 0 ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,8 @@
 #include <geometry/shape_poly_set.h>
 #include <trigo.h>
 
+#include <random>
+
 #include <qa_utils/geometry/geometry.h>
 #include <qa_utils/numeric.h>
 #include <qa_utils/wx_utils/unit_test_utils.h>
@@ -64,4 +66,312 @@ BOOST_AUTO_TEST_CASE( RemoveNullSegments )
 
 }
 
+
+static SHAPE_POLY_SET makeRect( int aX, int aY, int aSize )
+{
+    SHAPE_POLY_SET rect;
+
+    rect.NewOutline();
+    rect.Append( aX, aY );
+    rect.Append( aX + aSize, aY );
+    rect.Append( aX + aSize, aY + aSize );
+    rect.Append( aX, aY + aSize );
+
+    return rect;
+}
+
+
+BOOST_AUTO_TEST_CASE( BooleanBuilder )
+{
+    SHAPE_POLY_SET base = makeRect( 0, 0, 1000 );
+
+    // Overlapping knockouts, some of them sticking out of the base
+    std::vector<SHAPE_POLY_SET> knockouts;
+
+    for( int ii = 0; ii < 10; ++ii )
+        knockouts.push_back( makeRect( ii * 110 - 50, ( ii % 3 ) * 300, 150 ) );
+
+    SHAPE_POLY_SET chained = base;
+
+    for( const SHAPE_POLY_SET& knockout : knockouts )
+        chained.BooleanSubtract( knockout, SHAPE_POLY_SET::PM_FAST );
+
+    SHAPE_POLY_SET::BOOLEAN_BUILDER subtract;
+    SHAPE_POLY_SET                  batched;
+
+    subtract.AddSubject( base );
+
+    for( const SHAPE_POLY_SET& knockout : knockouts )
+        subtract.AddClip( knockout );
+
+    subtract.Subtract( batched, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( batched.Area(), chained.Area() );
+
+    // Inflating operands on the way in is the same as inflating them first
+    SHAPE_POLY_SET unioned;
+
+    for( SHAPE_POLY_SET knockout : knockouts )
+    {
+        knockout.Inflate( 20, 16 );
+        unioned.BooleanAdd( knockout, SHAPE_POLY_SET::PM_FAST );
+    }
+
+    SHAPE_POLY_SET::BOOLEAN_BUILDER add;
+
+    for( const SHAPE_POLY_SET& knockout : knockouts )
+        add.AddSubject( knockout, 20, 16 );
+
+    add.Union( batched, SHAPE_POLY_SET::PM_FAST );
+
+    BOOST_CHECK_EQUAL( batched.OutlineCount(), unioned.OutlineCount() );
+    BOOST_CHECK_EQUAL( batched.Area(), unioned.Area() );
+}
+
+
+BOOST_AUTO_TEST_CASE( BooleanBuilderInflatedArcs )
+{
+    // A square with a round notch in its top edge, whose concave corners the offset copies the
+    // arc's Z values to
+    SHAPE_LINE_CHAIN notched;
+
+    notched.Append( 0, 0 );
+    notched.Append( 100000, 0 );
+    notched.Append( 100000, 100000 );
+    notched.Append( 70000, 100000 );
+    notched.Append( SHAPE_ARC( VECTOR2I( 70000, 100000 ), VECTOR2I( 50000, 80000 ),
+                               VECTOR2I( 30000, 100000 ), 0 ) );
+    notched.Append( 0, 100000 );
+    notched.SetClosed( true );
+
+    SHAPE_POLY_SET arcs;
+    arcs.AddOutline( notched );
+
+    BOOST_REQUIRE( arcs.ArcCount() > 0 );
+
+    for( int amount : { -5000, 0, 5000 } )
+    {
+        BOOST_TEST_CONTEXT( "inflated by " << amount )
+        {
+            SHAPE_POLY_SET expected = arcs;
+
+            expected.ClearArcs();
+            expected.Inflate( amount, 32 );
+            expected.BooleanAdd( makeRect( 200000, 0, 1000 ), SHAPE_POLY_SET::PM_FAST );
+
+            SHAPE_POLY_SET::BOOLEAN_BUILDER add;
+            SHAPE_POLY_SET                  batched;
+
+            add.AddSubject( arcs, amount, 32 );
+            add.AddSubject( makeRect( 200000, 0, 1000 ) );
+            add.Union( batched, SHAPE_POLY_SET::PM_FAST );
+
+            BOOST_CHECK_EQUAL( batched.ArcCount(), 0 );
+            BOOST_CHECK_EQUAL( batched.OutlineCount(), expected.OutlineCount() );
+            BOOST_CHECK_CLOSE( batched.Area(), expected.Area(), 1e-6 );
+        }
+    }
+}
+
+
+static SHAPE_POLY_SET onePolygon( const SHAPE_POLY_SET& aPolys, int aIndex )
+{
+    SHAPE_POLY_SET result;
+
+    result.AddOutline( aPolys.COutline( aIndex ) );
+
+    for( int ii = 0; ii < aPolys.HoleCount( aIndex ); ++ii )
+        result.AddHole( aPolys.CHole( aIndex, ii ) );
+
+    return result;
+}
+
+
+BOOST_AUTO_TEST_CASE( InflateGroups )
+{
+    // Outlines spread out, in clusters which only merge once inflated, some of them with holes
+    // and some with the sharp corners that mitred offsets reach out furthest from
+    std::mt19937   rng( 42 );
+    SHAPE_POLY_SET polys;
+
+    for( int ii = 0; ii < 60; ++ii )
+    {
+        int x = ( ii % 10 ) * 100000 + rng() % 5000;
+        int y = ( ii / 10 ) * 100000 + rng() % 5000;
+
+        if( ii % 3 == 0 )
+        {
+            polys.NewOutline();
+            polys.Append( x, y );
+            polys.Append( x + 40000, y + 2000 );
+            polys.Append( x, y + 4000 );
+        }
+        else
+        {
+            SHAPE_POLY_SET rect = makeRect( x, y, 30000 + rng() % 20000 );
+
+            if( ii % 4 == 0 )
+                rect.BooleanSubtract( makeRect( x + 10000, y + 10000, 5000 ),
+                                      SHAPE_POLY_SET::PM_FAST );
+
+            polys.Append( rect );
+        }
+    }
+
+    // The outlines' bounding boxes and areas, which don't depend on the order they come in
+    auto outlines =
+            []( const SHAPE_POLY_SET& aPolys )
+            {
+                std::vector<std::tuple<int, int, int, int, double>> result;
+
+                for( int ii = 0; ii < aPolys.OutlineCount(); ++ii )
+                {
+                    BOX2I bbox = aPolys.COutline( ii ).BBox();
+                    result.emplace_back( bbox.GetLeft(), bbox.GetTop(), bbox.GetRight(),
+                                         bbox.GetBottom(), onePolygon( aPolys, ii ).Area() );
+                }
+
+                std::sort( result.begin(), result.end() );
+                return result;
+            };
+
+    for( SHAPE_POLY_SET::CORNER_STRATEGY strategy : { SHAPE_POLY_SET::ROUND_ALL_CORNERS,
+                                                      SHAPE_POLY_SET::ALLOW_ACUTE_CORNERS,
+                                                      SHAPE_POLY_SET::CHAMFER_ALL_CORNERS } )
+    {
+        for( int amount : { -1000, 20000, 40000 } )
+        {
+            BOOST_TEST_CONTEXT( "strategy " << strategy << ", amount " << amount )
+            {
+                SHAPE_POLY_SET grouped = polys;
+
+                grouped.Inflate( amount, 16, strategy );
+
+                // Each outline inflated on its own, and then the overlapping ones merged
+                SHAPE_POLY_SET expected;
+
+                for( int ii = 0; ii < polys.OutlineCount(); ++ii )
+                {
+                    SHAPE_POLY_SET single = onePolygon( polys, ii );
+
+                    single.Inflate( amount, 16, strategy );
+                    expected.BooleanAdd( single, SHAPE_POLY_SET::PM_FAST );
+                }
+
+                auto got = outlines( grouped );
+                auto want = outlines( expected );
+
+                BOOST_REQUIRE_EQUAL( got.size(), want.size() );
+
+                for( size_t ii = 0; ii < got.size(); ++ii )
+                {
+                    BOOST_CHECK_EQUAL( std::get<0>( got[ii] ), std::get<0>( want[ii] ) );
+                    BOOST_CHECK_EQUAL( std::get<1>( got[ii] ), std::get<1>( want[ii] ) );
+                    BOOST_CHECK_EQUAL( std::get<2>( got[ii] ), std::get<2>( want[ii] ) );
+                    BOOST_CHECK_EQUAL( std::get<3>( got[ii] ), std::get<3>( want[ii] ) );
+                    BOOST_CHECK_CLOSE( std::get<4>( got[ii] ), std::get<4>( want[ii] ), 1e-6 );
+                }
+
+                BOOST_CHECK_CLOSE( grouped.Area(), expected.Area(), 1e-6 );
+            }
+        }
+    }
+}
+
+
+static double triangulatedArea( const SHAPE_POLY_SET& aPoly )
+{
+    double area = 0.0;
+
+    for( unsigned ii = 0; ii < aPoly.TriangulatedPolyCount(); ++ii )
+    {
+        const SHAPE_POLY_SET::TRIANGULATED_POLYGON* tri = aPoly.TriangulatedPolygon( ii );
+
+        for( size_t jj = 0; jj < tri->GetTriangleCount(); ++jj )
+        {
+            VECTOR2I a, b, c;
+
+            tri->GetTriangle( jj, a, b, c );
+            area += std::abs( (double) ( b - a ).Cross( c - a ) ) / 2.0;
+        }
+    }
+
+    return area;
+}
+
+
+BOOST_AUTO_TEST_CASE( IncrementalTriangulation )
+{
+    // A 5cm pour with a grid of holes, so that it spans several (1cm) triangulation cells
+    auto fill =
+            []( bool aExtraHole )
+            {
+                SHAPE_POLY_SET pour = makeRect( -25000000, -25000000, 50000000 );
+
+                for( int ii = 0; ii < 10; ++ii )
+                {
+                    for( int jj = 0; jj < 10; ++jj )
+                    {
+                        pour.BooleanSubtract( makeRect( ii * 5000000 - 24000000,
+                                                        jj * 5000000 - 24000000, 1000000 ),
+                                              SHAPE_POLY_SET::PM_FAST );
+                    }
+                }
+
+                // Between the others, so that it changes the copper
+                if( aExtraHole )
+                    pour.BooleanSubtract( makeRect( 3000000, 3000000, 500000 ),
+                                          SHAPE_POLY_SET::PM_FAST );
+
+                pour.Fracture( SHAPE_POLY_SET::PM_FAST );
+                return pour;
+            };
+
+    SHAPE_POLY_SET before = fill( false );
+    SHAPE_POLY_SET after = fill( true );
+    SHAPE_POLY_SET fresh = after;
+    SHAPE_POLY_SET same = fill( false );
+    int            reused = -1;
+
+    before.CacheTriangulation();
+
+    // All 36 cells of an unchanged pour are copied (the grid is aligned to the origin, so it
+    // covers the pour with 6 x 6 of them)
+    same.CacheTriangulation( true, nullptr, &before, &reused );
+    BOOST_CHECK_EQUAL( reused, 36 );
+    BOOST_CHECK_CLOSE( triangulatedArea( same ), same.Area(), 1e-6 );
+
+    // The extra hole, and the slit that fractures it into the outline, change some of them
+    after.CacheTriangulation( true, nullptr, &before, &reused );
+    BOOST_CHECK_GT( reused, 0 );
+    BOOST_CHECK_LT( reused, 36 );
+
+    fresh.CacheTriangulation();
+
+    BOOST_CHECK( after.IsTriangulationUpToDate() );
+    BOOST_CHECK_EQUAL( after.TriangulatedPolyCount(), fresh.TriangulatedPolyCount() );
+    BOOST_CHECK_CLOSE( triangulatedArea( after ), after.Area(), 1e-6 );
+    BOOST_CHECK_CLOSE( triangulatedArea( after ), triangulatedArea( fresh ), 1e-6 );
+
+    // Moved triangles no longer cover the cells they came from, so mustn't be reused for them
+    SHAPE_POLY_SET moved = before;
+    SHAPE_POLY_SET unmoved = fill( false );
+
+    moved.Move( VECTOR2I( 2000000, 0 ) );
+    unmoved.CacheTriangulation( true, nullptr, &moved, &reused );
+
+    BOOST_CHECK_EQUAL( reused, 0 );
+
+    BOX2I bbox = unmoved.BBox();
+
+    for( unsigned ii = 0; ii < unmoved.TriangulatedPolyCount(); ++ii )
+    {
+        for( const SHAPE_POLY_SET::TRIANGULATED_POLYGON::TRI& tri :
+             unmoved.TriangulatedPolygon( ii )->Triangles() )
+        {
+            BOOST_CHECK( bbox.Contains( tri.BBox() ) );
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
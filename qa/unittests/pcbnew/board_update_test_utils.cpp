@@ -0,0 +1,88 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "board_update_test_utils.h"
+
+#include <footprint.h>
+#include <pcb_track.h>
+#include <router/pns_node.h>
+#include <pcbnew_utils/board_test_utils.h>
+
+
+namespace KI_TEST
+{
+
+BOARD_UPDATE_FIXTURE::BOARD_UPDATE_FIXTURE() :
+        m_settingsManager( true /* headless */ )
+{
+}
+
+
+void BOARD_UPDATE_FIXTURE::LoadBoard( const wxString& aRelPath, bool aFillZones )
+{
+    KI_TEST::LoadBoard( m_settingsManager, aRelPath, m_board );
+
+    if( aFillZones )
+        KI_TEST::FillZones( m_board.get() );
+}
+
+
+std::vector<PCB_TRACK*> BOARD_UPDATE_FIXTURE::SomeTracks( size_t aStep, size_t aFirst ) const
+{
+    std::vector<PCB_TRACK*> tracks;
+
+    for( size_t ii = aFirst; ii < m_board->Tracks().size(); ii += aStep )
+        tracks.push_back( m_board->Tracks()[ii] );
+
+    return tracks;
+}
+
+
+std::vector<FOOTPRINT*> BOARD_UPDATE_FIXTURE::SomeFootprints( size_t aStep ) const
+{
+    std::vector<FOOTPRINT*> footprints;
+
+    for( size_t ii = 0; ii < m_board->Footprints().size(); ii += aStep )
+        footprints.push_back( m_board->Footprints()[ii] );
+
+    return footprints;
+}
+
+
+TEST_ROUTER::TEST_ROUTER( BOARD* aBoard )
+{
+    m_iface.SetBoard( aBoard );
+    m_router.SetInterface( &m_iface );
+    m_router.SyncWorld();
+}
+
+
+TEST_ROUTER::~TEST_ROUTER()
+{
+    if( World() )
+        World()->KillChildren();
+
+    m_iface.SetBoard( nullptr );
+}
+
+} // namespace KI_TEST
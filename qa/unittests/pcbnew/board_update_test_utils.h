@@ -0,0 +1,93 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file board_update_test_utils.h
+ * Utilities for tests of what is kept up to date with a board as it changes
+ */
+
+#ifndef QA_PCBNEW_BOARD_UPDATE_TEST_UTILS__H
+#define QA_PCBNEW_BOARD_UPDATE_TEST_UTILS__H
+
+#include <memory>
+#include <vector>
+
+#include <board.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_router.h>
+#include <settings/settings_manager.h>
+
+class FOOTPRINT;
+class PCB_TRACK;
+
+
+namespace KI_TEST
+{
+/**
+ * Fixture for tests which edit a board and check something maintained incrementally alongside
+ * it (the connectivity clusters, the ratsnest, the router's world) against the same thing
+ * built from scratch.
+ */
+struct BOARD_UPDATE_FIXTURE
+{
+    BOARD_UPDATE_FIXTURE();
+
+    /**
+     * Load a board from the QA data, optionally filling its zones.
+     */
+    void LoadBoard( const wxString& aRelPath, bool aFillZones = false );
+
+    /**
+     * @return every \a aStep'th track of the board, starting with \a aFirst.
+     */
+    std::vector<PCB_TRACK*> SomeTracks( size_t aStep, size_t aFirst = 0 ) const;
+
+    /**
+     * @return every \a aStep'th footprint of the board, starting with the first.
+     */
+    std::vector<FOOTPRINT*> SomeFootprints( size_t aStep ) const;
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+/**
+ * A router whose world has been synced with a board, and which detaches from the board when
+ * it goes.
+ */
+class TEST_ROUTER
+{
+public:
+    TEST_ROUTER( BOARD* aBoard );
+    ~TEST_ROUTER();
+
+    PNS::NODE* World() const { return m_router.GetWorld(); }
+
+    PNS_KICAD_IFACE_BASE m_iface;
+    PNS::ROUTER          m_router;
+};
+
+} // namespace KI_TEST
+
+#endif // QA_PCBNEW_BOARD_UPDATE_TEST_UTILS__H
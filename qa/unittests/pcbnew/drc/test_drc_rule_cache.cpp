@@ -0,0 +1,314 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <pcbnew_utils/board_test_utils.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <footprint.h>
+#include <netclass.h>
+#include <netinfo.h>
+#include <pad.h>
+#include <pcb_track.h>
+#include <reporter.h>
+#include <drc/drc_engine.h>
+#include <project/net_settings.h>
+#include <settings/settings_manager.h>
+
+#include <fstream>
+
+// For the temp directory logic: can be std::filesystem in C++17
+#include <boost/filesystem.hpp>
+
+
+struct DRC_RULE_CACHE_TEST_FIXTURE
+{
+    DRC_RULE_CACHE_TEST_FIXTURE() :
+            m_settingsManager( true /* headless */ )
+    { }
+
+    /**
+     * @return the first track on the net called \a aNetname.
+     */
+    PCB_TRACK* FindTrack( const wxString& aNetname )
+    {
+        for( PCB_TRACK* track : m_board->Tracks() )
+        {
+            if( track->GetNetname() == aNetname )
+                return track;
+        }
+
+        BOOST_REQUIRE_MESSAGE( false, "no track on " << aNetname );
+        return nullptr;
+    }
+
+    int Clearance( const BOARD_ITEM* aA, const BOARD_ITEM* aB,
+                   PCB_LAYER_ID aLayer = UNDEFINED_LAYER )
+    {
+        std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+
+        return drcEngine->EvalRules( CLEARANCE_CONSTRAINT, aA, aB, aLayer ).GetValue().Min();
+    }
+
+    SETTINGS_MANAGER       m_settingsManager;
+    std::unique_ptr<BOARD> m_board;
+};
+
+
+BOOST_AUTO_TEST_SUITE( DRCRuleCache )
+
+
+BOOST_AUTO_TEST_CASE( CacheableConditions )
+{
+    const std::vector<std::string> cacheable =
+    {
+        "",
+        "A.NetClass == 'Power'",
+        "A.NetClass == 'Power' || B.NetClass == 'Power'",
+        "A.netclass == 'Power' && B.NETCLASS != 'HV'",
+        "A.Type == 'Via' && A.Via_Type == 'Micro'",
+        "A.NetClass == B.NetClass",
+        "( A.Type == 'Pad' ) && !( B.Type == 'Track' )",
+
+        // Whitespace around the dot
+        "A . NetClass == 'Power'",
+
+        // Things that only look like properties or calls inside string literals
+        "A.NetClass == 'B.Layer'",
+        "A.NetClass == 'insideArea(x)'",
+        "A.NetClass == \"it's.Layer\"",
+        "A.NetClass == 'it\\'s.Layer'",
+
+        // Numbers with decimal points and units
+        "A.NetClass == 'Power' && 0.5mm < 1mm",
+        "A.Type == 'Via' || .25 > 0"
+    };
+
+    const std::vector<std::string> notCacheable =
+    {
+        "A.Layer == 'F.Cu'",
+        "A.NetName == '/GND'",
+        "A.Net == B.Net",
+        "A.Pad_Type == 'SMD'",
+        "A.Type == 'Pad' && A.Pad_Type == 'Through-hole'",
+        "A.NetClass == 'Power' && A.insideArea('Conformal*')",
+        "A.insideCourtyard('U4')",
+        "B.memberOf('board_edge')",
+        "!A.isPlated()",
+
+        // A function call, even with an allowed name
+        "A.Type( 'Via' )",
+
+        // Anything other than A and B
+        "L.NetClass == 'Power'",
+        "A1.NetClass == 'Power'",
+
+        // A free-standing identifier
+        "isPlated()",
+        "A.NetClass == 'Power' || Layer",
+
+        // No property after the dot
+        "A.",
+        "A. == 'Power'"
+    };
+
+    for( const std::string& expr : cacheable )
+    {
+        BOOST_TEST_CONTEXT( "\"" << expr << "\"" )
+        {
+            BOOST_CHECK( DRC_ENGINE::IsCacheableCondition( wxString( expr ) ) );
+        }
+    }
+
+    for( const std::string& expr : notCacheable )
+    {
+        BOOST_TEST_CONTEXT( "\"" << expr << "\"" )
+        {
+            BOOST_CHECK( !DRC_ENGINE::IsCacheableCondition( wxString( expr ) ) );
+        }
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( CachedResolutionMatches, DRC_RULE_CACHE_TEST_FIXTURE )
+{
+    // The clearance rules come from the net classes (and so are cacheable); the connection
+    // width rules test an area as well (and so are not).
+    KI_TEST::LoadBoard( m_settingsManager, "connection_width_rules", m_board );
+
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+    std::vector<BOARD_ITEM*>    items;
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        items.push_back( track );
+
+    for( FOOTPRINT* footprint : m_board->Footprints() )
+    {
+        for( PAD* pad : footprint->Pads() )
+            items.push_back( pad );
+    }
+
+    BOOST_REQUIRE( !items.empty() );
+
+    // Keep it quadratic in something small
+    if( items.size() > 60 )
+        items.resize( 60 );
+
+    for( DRC_CONSTRAINT_T type : { CLEARANCE_CONSTRAINT, TRACK_WIDTH_CONSTRAINT,
+                                   CONNECTION_WIDTH_CONSTRAINT } )
+    {
+        for( BOARD_ITEM* a : items )
+        {
+            for( BOARD_ITEM* b : items )
+            {
+                // A reporter bypasses the cache.  Ask twice without one, so that the second
+                // answer comes from the cache if the type is cacheable.
+                DRC_CONSTRAINT expected = drcEngine->EvalRules( type, a, b, F_Cu,
+                                                                &NULL_REPORTER::GetInstance() );
+
+                for( int pass = 0; pass < 2; ++pass )
+                {
+                    DRC_CONSTRAINT constraint = drcEngine->EvalRules( type, a, b, F_Cu );
+
+                    BOOST_TEST_CONTEXT( "constraint " << type << ", pass " << pass )
+                    {
+                        BOOST_CHECK( constraint.GetParentRule() == expected.GetParentRule() );
+                        BOOST_CHECK_EQUAL( constraint.GetValue().HasMin(),
+                                           expected.GetValue().HasMin() );
+                        BOOST_CHECK_EQUAL( constraint.GetValue().Min(),
+                                           expected.GetValue().Min() );
+                        BOOST_CHECK_EQUAL( constraint.GetValue().Max(),
+                                           expected.GetValue().Max() );
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( NetclassReassignment, DRC_RULE_CACHE_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "connection_width_rules", m_board );
+
+    BOARD_DESIGN_SETTINGS&    bds = m_board->GetDesignSettings();
+    std::shared_ptr<NETCLASS> highCurrent = bds.m_NetSettings->m_NetClasses[ "High_current" ];
+
+    BOOST_REQUIRE( highCurrent );
+
+    highCurrent->SetClearance( pcbIUScale.mmToIU( 0.3 ) );
+    bds.m_DRCEngine->InitEngine( wxFileName() );
+
+    PCB_TRACK* a = FindTrack( "net_1" );
+    PCB_TRACK* b = FindTrack( "net_2" );
+
+    BOOST_CHECK_EQUAL( Clearance( a, b, F_Cu ), pcbIUScale.mmToIU( 0.1 ) );
+
+    // Reassign a net behind the engine's back; the lookup must not find the old answer
+    a->GetNet()->SetNetClass( highCurrent );
+
+    BOOST_CHECK_EQUAL( Clearance( a, b, F_Cu ), pcbIUScale.mmToIU( 0.3 ) );
+
+    // A net class replaced by another of the same name and address can't be told apart, so
+    // anything that reassigns them has to drop the cache
+    unsigned generation = bds.m_DRCEngine->GetConstraintCacheGeneration();
+
+    m_board->SynchronizeNetsAndNetClasses();
+
+    BOOST_CHECK_NE( bds.m_DRCEngine->GetConstraintCacheGeneration(), generation );
+    BOOST_CHECK_EQUAL( Clearance( a, b, F_Cu ), pcbIUScale.mmToIU( 0.1 ) );
+}
+
+
+BOOST_FIXTURE_TEST_CASE( BoardChanges, DRC_RULE_CACHE_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "connection_width_rules", m_board );
+
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+    unsigned                    generation = drcEngine->GetConstraintCacheGeneration();
+
+    PCB_TRACK* a = FindTrack( "net_1" );
+    PCB_TRACK* b = FindTrack( "net_2" );
+
+    BOOST_CHECK_EQUAL( Clearance( a, b, F_Cu ), pcbIUScale.mmToIU( 0.1 ) );
+
+    // Editing the board keeps what has been resolved so far
+    m_board->IncrementTimeStamp();
+
+    BOOST_CHECK_EQUAL( drcEngine->GetConstraintCacheGeneration(), generation );
+    BOOST_CHECK_EQUAL( Clearance( a, b, F_Cu ), pcbIUScale.mmToIU( 0.1 ) );
+
+    // Recompiling the rules doesn't
+    drcEngine->InitEngine( wxFileName() );
+
+    BOOST_CHECK_NE( drcEngine->GetConstraintCacheGeneration(), generation );
+
+    // Another engine never hands out the same generation
+    DRC_ENGINE other( m_board.get(), &m_board->GetDesignSettings() );
+
+    other.InitEngine( wxFileName() );
+
+    BOOST_CHECK_NE( other.GetConstraintCacheGeneration(),
+                    drcEngine->GetConstraintCacheGeneration() );
+}
+
+
+BOOST_FIXTURE_TEST_CASE( EnabledLayers, DRC_RULE_CACHE_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "connection_width_rules", m_board );
+
+    boost::filesystem::path rulesPath = boost::filesystem::temp_directory_path()
+                                        / "drc_rule_cache_layers.kicad_dru";
+
+    {
+        std::ofstream rules( rulesPath.string() );
+
+        rules << "(version 1)\n"
+                 "(rule inner\n"
+                 "  (layer In1.Cu)\n"
+                 "  (constraint clearance (min 0.5mm))\n"
+                 "  (condition \"A.Type == 'Track'\"))\n";
+    }
+
+    std::shared_ptr<DRC_ENGINE> drcEngine = m_board->GetDesignSettings().m_DRCEngine;
+
+    drcEngine->InitEngine( wxFileName( rulesPath.string() ) );
+    boost::filesystem::remove( rulesPath );
+
+    BOOST_REQUIRE( drcEngine->RulesValid() );
+    BOOST_REQUIRE( !m_board->IsLayerEnabled( In1_Cu ) );
+
+    PCB_TRACK* a = FindTrack( "net_1" );
+    PCB_TRACK* b = FindTrack( "net_2" );
+
+    // Rules on layers the board doesn't have are ignored...
+    BOOST_CHECK_EQUAL( Clearance( a, b ), pcbIUScale.mmToIU( 0.1 ) );
+
+    // ... until the layer is enabled, which the cache has to notice by itself
+    m_board->SetEnabledLayers( m_board->GetEnabledLayers().set( In1_Cu ) );
+
+    BOOST_CHECK_EQUAL( Clearance( a, b ), pcbIUScale.mmToIU( 0.5 ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
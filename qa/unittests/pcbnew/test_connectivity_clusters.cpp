@@ -0,0 +1,171 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <pcb_track.h>
+#include <connectivity/connectivity_algo.h>
+#include <connectivity/connectivity_data.h>
+
+#include "board_update_test_utils.h"
+
+
+/**
+ * A comparable form of a set of clusters: the (sorted) parents of each cluster's items.
+ */
+typedef std::vector<std::vector<const BOARD_CONNECTED_ITEM*>> PARTITION;
+
+static PARTITION getPartition( const CN_CONNECTIVITY_ALGO::CLUSTERS& aClusters )
+{
+    PARTITION partition;
+
+    for( const std::shared_ptr<CN_CLUSTER>& cluster : aClusters )
+    {
+        std::vector<const BOARD_CONNECTED_ITEM*> parents;
+
+        for( CN_ITEM* item : *cluster )
+            parents.push_back( item->Parent() );
+
+        std::sort( parents.begin(), parents.end() );
+        partition.push_back( parents );
+    }
+
+    std::sort( partition.begin(), partition.end() );
+    return partition;
+}
+
+
+static const std::vector<CN_CONNECTIVITY_ALGO::CLUSTER_SEARCH_MODE> searchModes =
+{
+    CN_CONNECTIVITY_ALGO::CSM_PROPAGATE,
+    CN_CONNECTIVITY_ALGO::CSM_RATSNEST
+};
+
+
+static void checkAgainstRebuild( BOARD* aBoard, CN_CONNECTIVITY_ALGO& aAlgo )
+{
+    CONNECTIVITY_DATA rebuilt;
+    rebuilt.Build( aBoard );
+
+    for( CN_CONNECTIVITY_ALGO::CLUSTER_SEARCH_MODE mode : searchModes )
+    {
+        BOOST_TEST_CONTEXT( "mode " << mode )
+        {
+            BOOST_CHECK( getPartition( aAlgo.SearchClusters( mode ) )
+                         == getPartition( rebuilt.GetConnectivityAlgo()->SearchClusters( mode ) ) );
+        }
+    }
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( ConnectivityClusters, KI_TEST::BOARD_UPDATE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( IncrementalClustersMatchRebuild )
+{
+    for( const wxString& relPath : { wxString( wxT( "issue5102" ) ),
+                                     wxString( wxT( "issue7325" ) ) } )
+    {
+        LoadBoard( relPath, true );
+
+        CN_CONNECTIVITY_ALGO&   algo = *m_board->GetConnectivity()->GetConnectivityAlgo();
+        std::vector<PCB_TRACK*> removed = SomeTracks( 5 );
+
+        // Prime the clusters so that what follows is incremental
+        checkAgainstRebuild( m_board.get(), algo );
+
+        for( PCB_TRACK* track : removed )
+            m_board->Remove( track );
+
+        BOOST_TEST_CONTEXT( relPath << ": after removing " << removed.size() << " tracks" )
+        {
+            checkAgainstRebuild( m_board.get(), algo );
+        }
+
+        for( PCB_TRACK* track : removed )
+            m_board->Add( track );
+
+        BOOST_TEST_CONTEXT( relPath << ": after restoring them" )
+        {
+            checkAgainstRebuild( m_board.get(), algo );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( UntouchedClustersAreKept )
+{
+    LoadBoard( "issue5102", true );
+
+    CN_CONNECTIVITY_ALGO& algo = *m_board->GetConnectivity()->GetConnectivityAlgo();
+    PCB_TRACK*            track = m_board->Tracks()[ m_board->Tracks().size() / 2 ];
+
+    BOOST_REQUIRE( track->GetNetCode() > 0 );
+
+    for( CN_CONNECTIVITY_ALGO::CLUSTER_SEARCH_MODE mode : searchModes )
+    {
+        BOOST_TEST_CONTEXT( "mode " << mode )
+        {
+            CN_CONNECTIVITY_ALGO::CLUSTERS        before = algo.SearchClusters( mode );
+            std::set<const BOARD_CONNECTED_ITEM*> touched;
+
+            for( const std::shared_ptr<CN_CLUSTER>& cluster : before )
+            {
+                if( cluster->Contains( track ) )
+                {
+                    for( CN_ITEM* item : *cluster )
+                        touched.insert( item->Parent() );
+                }
+            }
+
+            BOOST_REQUIRE( touched.count( track ) );
+
+            m_board->Remove( track );
+
+            CN_CONNECTIVITY_ALGO::CLUSTERS        after = algo.SearchClusters( mode );
+            std::set<std::shared_ptr<CN_CLUSTER>> kept( before.begin(), before.end() );
+            size_t                                reused = 0;
+
+            // Only what was in the removed track's cluster is regrouped; every other cluster
+            // is the very same object as before
+            for( const std::shared_ptr<CN_CLUSTER>& cluster : after )
+            {
+                if( kept.count( cluster ) )
+                {
+                    reused++;
+                    continue;
+                }
+
+                for( CN_ITEM* item : *cluster )
+                    BOOST_CHECK( touched.count( item->Parent() ) );
+            }
+
+            BOOST_CHECK_EQUAL( reused, before.size() - 1 );
+
+            m_board->Add( track );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
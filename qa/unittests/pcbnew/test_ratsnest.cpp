@@ -0,0 +1,304 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <board_commit.h>
+#include <footprint.h>
+#include <pad.h>
+#include <pcb_track.h>
+#include <zone.h>
+#include <zone_filler.h>
+#include <connectivity/connectivity_data.h>
+#include <connectivity/connectivity_algo.h>
+#include <ratsnest/ratsnest_data.h>
+#include <tool/tool_manager.h>
+#include <core/kicad_algo.h>
+
+#include <limits>
+#include <set>
+#include <utility>
+
+#include "board_update_test_utils.h"
+
+
+/**
+ * The ratsnest of a net is a minimum spanning tree, which need not be unique, but its total
+ * weight is.
+ */
+static void checkAgainstRebuild( BOARD* aBoard )
+{
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = aBoard->GetConnectivity();
+    CONNECTIVITY_DATA                  rebuilt;
+
+    rebuilt.Build( aBoard );
+
+    BOOST_REQUIRE_EQUAL( connectivity->GetNetCount(), rebuilt.GetNetCount() );
+
+    for( int net = 1; net < rebuilt.GetNetCount(); ++net )
+    {
+        uint64_t incrementalWeight = 0;
+        uint64_t rebuiltWeight = 0;
+
+        for( const CN_EDGE& edge : connectivity->GetRatsnestForNet( net )->GetEdges() )
+            incrementalWeight += edge.GetWeight();
+
+        for( const CN_EDGE& edge : rebuilt.GetRatsnestForNet( net )->GetEdges() )
+            rebuiltWeight += edge.GetWeight();
+
+        BOOST_TEST_CONTEXT( "net " << net )
+        {
+            BOOST_CHECK_EQUAL( connectivity->GetRatsnestForNet( net )->GetEdges().size(),
+                               rebuilt.GetRatsnestForNet( net )->GetEdges().size() );
+            BOOST_CHECK_EQUAL( incrementalWeight, rebuiltWeight );
+        }
+    }
+}
+
+
+/**
+ * A ratsnest line, by the items and points it joins.
+ */
+/**
+ * The ends of a ratsnest line: the items and the anchor positions, as coordinates because
+ * VECTOR2I orders points by their length.
+ */
+typedef std::pair<const BOARD_ITEM*, std::pair<int, int>> EDGE_END;
+typedef std::pair<EDGE_END, EDGE_END>                      EDGE_ENDS;
+
+static std::set<EDGE_ENDS> edgeEnds( const RN_NET* aNet )
+{
+    std::set<EDGE_ENDS> ends;
+
+    for( const CN_EDGE& edge : aNet->GetEdges() )
+    {
+        const VECTOR2I& sourcePos = edge.GetSourcePos();
+        const VECTOR2I& targetPos = edge.GetTargetPos();
+        EDGE_END        source( edge.GetSourceNode()->Parent(), { sourcePos.x, sourcePos.y } );
+        EDGE_END        target( edge.GetTargetNode()->Parent(), { targetPos.x, targetPos.y } );
+
+        ends.emplace( std::min( source, target ), std::max( source, target ) );
+    }
+
+    return ends;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( Ratsnest, KI_TEST::BOARD_UPDATE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( IncrementalRatsnestMatchesRebuild )
+{
+    for( const wxString& relPath : { wxString( wxT( "issue5102" ) ),
+                                     wxString( wxT( "issue7325" ) ) } )
+    {
+        LoadBoard( relPath, true );
+
+        std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+        std::vector<FOOTPRINT*>            moved = SomeFootprints( 7 );
+
+        // Move the footprints one at a time, then back again
+        for( const VECTOR2I& delta : { VECTOR2I( 1000000, 500000 ),
+                                       VECTOR2I( -1000000, -500000 ) } )
+        {
+            for( FOOTPRINT* footprint : moved )
+            {
+                footprint->Move( delta );
+                connectivity->Update( footprint );
+                connectivity->RecalculateRatsnest();
+            }
+
+            BOOST_TEST_CONTEXT( relPath << ": after moving " << moved.size() << " footprints" )
+            {
+                checkAgainstRebuild( m_board.get() );
+            }
+        }
+    }
+}
+
+
+/**
+ * Check that every end of every ratsnest line is on an item still on the board.
+ */
+static void checkEdgesOnBoard( BOARD* aBoard )
+{
+    std::set<const BOARD_ITEM*> items( aBoard->Tracks().begin(), aBoard->Tracks().end() );
+
+    items.insert( aBoard->Zones().begin(), aBoard->Zones().end() );
+
+    for( FOOTPRINT* footprint : aBoard->Footprints() )
+        items.insert( footprint->Pads().begin(), footprint->Pads().end() );
+
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = aBoard->GetConnectivity();
+
+    for( int net = 1; net < connectivity->GetNetCount(); ++net )
+    {
+        for( const CN_EDGE& edge : connectivity->GetRatsnestForNet( net )->GetEdges() )
+        {
+            BOOST_TEST_CONTEXT( "net " << net )
+            {
+                BOOST_CHECK( items.count( edge.GetSourceNode()->Parent() ) );
+                BOOST_CHECK( items.count( edge.GetTargetNode()->Parent() ) );
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( MovingAFootprintKeepsOtherEdges )
+{
+    LoadBoard( "issue5102", true );
+
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+    CN_CONNECTIVITY_ALGO&              algo = *connectivity->GetConnectivityAlgo();
+    FOOTPRINT*                         moved = nullptr;
+    int                                net = 0;
+
+    // Use the net with the most lines, so that there are plenty to keep
+    for( int candidate = 1; candidate < connectivity->GetNetCount(); ++candidate )
+    {
+        if( !net || connectivity->GetRatsnestForNet( candidate )->GetEdges().size()
+                        > connectivity->GetRatsnestForNet( net )->GetEdges().size() )
+        {
+            net = candidate;
+        }
+    }
+
+    const CN_CONNECTIVITY_ALGO::CLUSTER_SEARCH_MODE mode = CN_CONNECTIVITY_ALGO::CSM_RATSNEST;
+
+    CN_CONNECTIVITY_ALGO::CLUSTERS before = algo.SearchClusters( mode );
+    std::set<EDGE_ENDS>            edgesBefore = edgeEnds( connectivity->GetRatsnestForNet( net ) );
+    int                            smallest = std::numeric_limits<int>::max();
+
+    // Move a footprint whose pad on the net is on its own (or nearly), so that the net's
+    // ratsnest is repaired around it rather than rebuilt
+    for( const std::shared_ptr<CN_CLUSTER>& cluster : before )
+    {
+        if( cluster->OriginNet() != net || cluster->Size() >= smallest )
+            continue;
+
+        for( CN_ITEM* item : *cluster )
+        {
+            if( item->Parent()->Type() == PCB_PAD_T )
+            {
+                moved = static_cast<PAD*>( item->Parent() )->GetParent();
+                smallest = cluster->Size();
+                break;
+            }
+        }
+    }
+
+    BOOST_REQUIRE( moved );
+    BOOST_REQUIRE( edgesBefore.size() > 4 );
+
+    moved->Move( VECTOR2I( 100000, 0 ) );
+    connectivity->Update( moved );
+    connectivity->RecalculateRatsnest();
+
+    CN_CONNECTIVITY_ALGO::CLUSTERS after = algo.SearchClusters( mode );
+    std::set<EDGE_ENDS>            edgesAfter = edgeEnds( connectivity->GetRatsnestForNet( net ) );
+    std::set<const BOARD_ITEM*>    changed;
+
+    // The items of the clusters which changed (the forest replaces exactly those)
+    auto addChanged =
+            [&]( const CN_CONNECTIVITY_ALGO::CLUSTERS& aClusters,
+                 const CN_CONNECTIVITY_ALGO::CLUSTERS& aOthers )
+            {
+                for( const std::shared_ptr<CN_CLUSTER>& cluster : aClusters )
+                {
+                    if( alg::contains( aOthers, cluster ) )
+                        continue;
+
+                    for( CN_ITEM* item : *cluster )
+                        changed.insert( item->Parent() );
+                }
+            };
+
+    addChanged( before, after );
+    addChanged( after, before );
+
+    BOOST_REQUIRE( !changed.empty() );
+
+    // Lines between clusters which didn't change are kept as they were
+    for( const EDGE_ENDS& ends : edgesBefore )
+    {
+        if( changed.count( ends.first.first ) || changed.count( ends.second.first ) )
+            continue;
+
+        BOOST_CHECK( edgesAfter.count( ends ) );
+    }
+
+    checkAgainstRebuild( m_board.get() );
+    checkEdgesOnBoard( m_board.get() );
+}
+
+
+BOOST_AUTO_TEST_CASE( RatsnestAfterZoneChanges )
+{
+    LoadBoard( "issue5102", true );
+
+    BOOST_REQUIRE( !m_board->Zones().empty() );
+
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+
+    // Refill the way auto-fill does, replacing the zone items without rebuilding
+    {
+        TOOL_MANAGER toolMgr;
+        toolMgr.SetEnvironment( m_board.get(), nullptr, nullptr, nullptr, nullptr );
+
+        BOARD_COMMIT       commit( &toolMgr );
+        ZONE_FILLER        filler( m_board.get(), &commit );
+        std::vector<ZONE*> toFill( m_board->Zones().begin(), m_board->Zones().end() );
+
+        BOOST_REQUIRE( filler.Fill( toFill, false, nullptr ) );
+        commit.Push( _( "Fill Zone(s)" ),
+                     SKIP_UNDO | SKIP_SET_DIRTY | ZONE_FILL_OP | SKIP_CONNECTIVITY );
+
+        for( ZONE* zone : toFill )
+            connectivity->Update( zone );
+
+        connectivity->RecalculateRatsnest();
+    }
+
+    BOOST_TEST_CONTEXT( "after a refill" )
+    {
+        checkAgainstRebuild( m_board.get() );
+        checkEdgesOnBoard( m_board.get() );
+    }
+
+    // Kept until the ratsnest no longer needs its items
+    std::unique_ptr<ZONE> removed( m_board->Zones().front() );
+
+    connectivity->Remove( removed.get() );
+    m_board->Remove( removed.get() );
+    connectivity->RecalculateRatsnest();
+
+    BOOST_TEST_CONTEXT( "after removing a zone" )
+    {
+        checkAgainstRebuild( m_board.get() );
+        checkEdgesOnBoard( m_board.get() );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
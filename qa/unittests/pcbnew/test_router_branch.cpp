@@ -0,0 +1,155 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <pcb_track.h>
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+
+#include "board_update_test_utils.h"
+
+
+static std::set<PNS::ITEM*> trackItems( BOARD* aBoard, PNS::NODE* aNode )
+{
+    std::set<PNS::ITEM*> items;
+
+    for( const NETINFO_ITEM* net : aBoard->GetNetInfo() )
+    {
+        aNode->AllItemsInNet( net->GetNetCode(), items,
+                              PNS::ITEM::SEGMENT_T | PNS::ITEM::ARC_T | PNS::ITEM::VIA_T );
+    }
+
+    return items;
+}
+
+
+static size_t countColliding( BOARD* aBoard, PNS::NODE* aNode )
+{
+    size_t count = 0;
+
+    for( PCB_TRACK* track : aBoard->Tracks() )
+    {
+        PNS::SEGMENT probe( SEG( track->GetStart(), track->GetEnd() ), -1 );
+
+        probe.SetWidth( track->GetWidth() );
+        probe.SetLayer( 0 );
+
+        PNS::NODE::OBSTACLES obstacles;
+        count += aNode->QueryColliding( &probe, obstacles );
+    }
+
+    return count;
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( RouterBranch, KI_TEST::BOARD_UPDATE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( BranchesAreSnapshots )
+{
+    LoadBoard( "issue5102" );
+
+    KI_TEST::TEST_ROUTER router( m_board.get() );
+
+    PNS::NODE* world = router.World();
+    PNS::NODE* first = world->Branch();
+
+    std::set<PNS::ITEM*>    worldItems = trackItems( m_board.get(), world );
+    int                     worldJoints = world->JointCount();
+    std::vector<PNS::ITEM*> all( worldItems.begin(), worldItems.end() );
+
+    BOOST_REQUIRE( all.size() > 30 );
+
+    for( size_t ii = 0; ii < all.size(); ii += 3 )
+        first->Remove( all[ii] );
+
+    // Nothing changes between these two, so they share the first branch's contents
+    PNS::NODE* second = first->Branch();
+    PNS::NODE* third = second->Branch();
+
+    std::set<PNS::ITEM*> firstItems = trackItems( m_board.get(), first );
+    size_t               firstCollisions = countColliding( m_board.get(), first );
+
+    BOOST_CHECK( trackItems( m_board.get(), third ) == firstItems );
+    BOOST_CHECK_EQUAL( countColliding( m_board.get(), third ), firstCollisions );
+
+    for( size_t ii = 1; ii < all.size(); ii += 3 )
+        third->Remove( all[ii] );
+
+    // Changing a branch mustn't show through in the branches it was made from...
+    BOOST_CHECK( trackItems( m_board.get(), first ) == firstItems );
+    BOOST_CHECK( trackItems( m_board.get(), second ) == firstItems );
+    BOOST_CHECK_EQUAL( countColliding( m_board.get(), second ), firstCollisions );
+    BOOST_CHECK( trackItems( m_board.get(), third ).size() < firstItems.size() );
+
+    // ...nor changing those in the branches made from them
+    PNS::NODE* fourth = second->Branch();
+
+    for( size_t ii = 2; ii < all.size(); ii += 3 )
+        second->Remove( all[ii] );
+
+    std::set<PNS::ITEM*> remaining;
+
+    for( size_t ii = 1; ii < all.size(); ii += 3 )
+        remaining.insert( all[ii] );
+
+    BOOST_CHECK( trackItems( m_board.get(), fourth ) == firstItems );
+    BOOST_CHECK( trackItems( m_board.get(), second ) == remaining );
+
+    // The joints are copied on write just the same
+    for( size_t ii = 2; ii < all.size(); ii += 3 )
+    {
+        PNS::SEGMENT* seg = dynamic_cast<PNS::SEGMENT*>( all[ii] );
+
+        if( !seg )
+            continue;
+
+        PNS::JOINT* inFourth = fourth->FindJoint( seg->Seg().A, seg );
+        PNS::JOINT* inSecond = second->FindJoint( seg->Seg().A, seg );
+
+        BOOST_CHECK( inFourth && inFourth->CLinks().Contains( seg ) );
+        BOOST_CHECK( !inSecond || !inSecond->CLinks().Contains( seg ) );
+    }
+
+    // A branch gives up what it owns when it is branched from, so changing it after that has
+    // to copy again
+    fourth->Remove( all[1] );
+
+    PNS::NODE*           fifth = fourth->Branch();
+    std::set<PNS::ITEM*> fifthItems = trackItems( m_board.get(), fifth );
+
+    for( size_t ii = 4; ii < all.size(); ii += 3 )
+        fourth->Remove( all[ii] );
+
+    BOOST_CHECK( trackItems( m_board.get(), fifth ) == fifthItems );
+    BOOST_CHECK( trackItems( m_board.get(), fourth ).size() < fifthItems.size() );
+    BOOST_CHECK( trackItems( m_board.get(), second ) == remaining );
+
+    // None of it shows through in the world
+    BOOST_CHECK( trackItems( m_board.get(), world ) == worldItems );
+    BOOST_CHECK_EQUAL( world->JointCount(), worldJoints );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
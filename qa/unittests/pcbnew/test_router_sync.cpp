@@ -0,0 +1,245 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2022 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <qa_utils/wx_utils/unit_test_utils.h>
+#include <board.h>
+#include <board_design_settings.h>
+#include <connectivity/connectivity_data.h>
+#include <footprint.h>
+#include <netclass.h>
+#include <pad.h>
+#include <pcb_track.h>
+#include <drc/drc_engine.h>
+#include <router/pns_node.h>
+#include <router/pns_solid.h>
+
+#include "board_update_test_utils.h"
+
+#include <map>
+
+
+static size_t countRealItems( PNS::NODE* aWorld, int aNet )
+{
+    std::set<PNS::ITEM*> items;
+    aWorld->AllItemsInNet( aNet, items );
+
+    return std::count_if( items.begin(), items.end(),
+                          []( const PNS::ITEM* aItem )
+                          {
+                              return !aItem->IsVirtual();
+                          } );
+}
+
+
+static void checkAgainstRebuild( BOARD* aBoard, PNS::NODE* aWorld )
+{
+    KI_TEST::TEST_ROUTER rebuilt( aBoard );
+
+    BOOST_CHECK_EQUAL( aWorld->JointCount(), rebuilt.World()->JointCount() );
+
+    for( const NETINFO_ITEM* net : aBoard->GetNetInfo() )
+    {
+        BOOST_TEST_CONTEXT( "net " << net->GetNetname() )
+        {
+            BOOST_CHECK_EQUAL( countRealItems( aWorld, net->GetNetCode() ),
+                               countRealItems( rebuilt.World(), net->GetNetCode() ) );
+        }
+    }
+
+    for( PCB_TRACK* track : aBoard->Tracks() )
+        BOOST_CHECK( aWorld->FindItemByParent( track ) );
+}
+
+
+BOOST_FIXTURE_TEST_SUITE( RouterSync, KI_TEST::BOARD_UPDATE_FIXTURE )
+
+
+BOOST_AUTO_TEST_CASE( IncrementalWorldMatchesRebuild )
+{
+    LoadBoard( "issue5102" );
+
+    KI_TEST::TEST_ROUTER    router( m_board.get() );
+    std::vector<PCB_TRACK*> removed = SomeTracks( 5 );
+    std::vector<FOOTPRINT*> moved = SomeFootprints( 7 );
+
+    for( PCB_TRACK* track : removed )
+        m_board->Remove( track );
+
+    for( FOOTPRINT* footprint : moved )
+    {
+        footprint->Move( VECTOR2I( 1000000, 500000 ) );
+        m_board->OnItemChanged( footprint );
+    }
+
+    std::map<PCB_TRACK*, PNS::ITEM*> kept;
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+        kept[ track ] = router.World()->FindItemByParent( track );
+
+    BOOST_REQUIRE( router.m_iface.SyncChanges( router.World() ) );
+    router.World()->FixupVirtualVias();
+
+    for( PCB_TRACK* track : removed )
+        BOOST_CHECK( !router.World()->FindItemByParent( track ) );
+
+    // Only what changed is replaced: the tracks left alone keep their world items, and the
+    // pads of the footprints which moved are where the footprints put them
+    for( const std::pair<PCB_TRACK* const, PNS::ITEM*>& entry : kept )
+        BOOST_CHECK( router.World()->FindItemByParent( entry.first ) == entry.second );
+
+    for( FOOTPRINT* footprint : moved )
+    {
+        for( PAD* pad : footprint->Pads() )
+        {
+            PNS::ITEM* item = router.World()->FindItemByParent( pad );
+
+            if( item && item->OfKind( PNS::ITEM::SOLID_T ) )
+                BOOST_CHECK_EQUAL( static_cast<PNS::SOLID*>( item )->Pos(), pad->GetPosition() );
+        }
+    }
+
+    BOOST_TEST_CONTEXT( "after removing tracks and moving footprints" )
+    {
+        checkAgainstRebuild( m_board.get(), router.World() );
+    }
+
+    for( PCB_TRACK* track : removed )
+        m_board->Add( track );
+
+    // Let the router apply the changes this time; after that there's nothing left to do
+    router.m_router.SyncWorld();
+    BOOST_REQUIRE( router.m_iface.SyncChanges( router.World() ) );
+
+    BOOST_TEST_CONTEXT( "after restoring the tracks" )
+    {
+        checkAgainstRebuild( m_board.get(), router.World() );
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( NetChangesOutsideCommits )
+{
+    LoadBoard( "issue5102" );
+
+    std::shared_ptr<CONNECTIVITY_DATA> connectivity = m_board->GetConnectivity();
+    PCB_TRACK*                         track = nullptr;
+
+    for( PCB_TRACK* candidate : m_board->Tracks() )
+    {
+        if( candidate->GetNetCode() > 0 && !connectivity->GetConnectedPads( candidate ).empty() )
+        {
+            track = candidate;
+            break;
+        }
+    }
+
+    BOOST_REQUIRE( track );
+
+    int                  netCode = track->GetNetCode();
+    KI_TEST::TEST_ROUTER router( m_board.get() );
+
+    // An edit leaves the track unconnected...
+    track->SetNetCode( NETINFO_LIST::UNCONNECTED );
+    connectivity->Update( track );
+    m_board->OnItemChanged( track );
+
+    BOOST_REQUIRE( router.m_iface.SyncChanges( router.World() ) );
+    BOOST_CHECK_EQUAL( router.World()->FindItemByParent( track )->Net(),
+                       NETINFO_LIST::UNCONNECTED );
+
+    // ... and propagation outside a commit (as after an undo) gives it its net back
+    connectivity->RecalculateRatsnest();
+
+    BOOST_REQUIRE_EQUAL( track->GetNetCode(), netCode );
+    BOOST_REQUIRE( router.m_iface.SyncChanges( router.World() ) );
+    BOOST_CHECK_EQUAL( router.World()->FindItemByParent( track )->Net(), netCode );
+
+    // Nets which no longer exist (as after undoing their creation) are sanitized away
+    NETINFO_ITEM* net = new NETINFO_ITEM( m_board.get(), wxT( "/temporary" ) );
+
+    m_board->Add( net );
+    track->SetNet( net );
+    m_board->OnItemChanged( track );
+
+    BOOST_REQUIRE( router.m_iface.SyncChanges( router.World() ) );
+    BOOST_REQUIRE_EQUAL( router.World()->FindItemByParent( track )->Net(), net->GetNetCode() );
+
+    m_board->GetNetInfo().RemoveNet( net );
+    m_board->SanitizeNetcodes();
+
+    BOOST_REQUIRE_EQUAL( track->GetNetCode(), NETINFO_LIST::UNCONNECTED );
+    BOOST_REQUIRE( router.m_iface.SyncChanges( router.World() ) );
+    BOOST_CHECK_EQUAL( router.World()->FindItemByParent( track )->Net(),
+                       NETINFO_LIST::UNCONNECTED );
+
+    delete net;
+}
+
+
+BOOST_AUTO_TEST_CASE( ClearancesFollowRuleChanges )
+{
+    LoadBoard( "issue5102" );
+
+    KI_TEST::TEST_ROUTER router( m_board.get() );
+
+    PCB_TRACK* trackA = m_board->Tracks().front();
+    PCB_TRACK* trackB = nullptr;
+
+    for( PCB_TRACK* track : m_board->Tracks() )
+    {
+        if( track->GetNetCode() != trackA->GetNetCode() )
+        {
+            trackB = track;
+            break;
+        }
+    }
+
+    BOOST_REQUIRE( trackB );
+
+    PNS::ITEM*          a = router.World()->FindItemByParent( trackA );
+    PNS::ITEM*          b = router.World()->FindItemByParent( trackB );
+    PNS::RULE_RESOLVER* resolver = router.m_router.GetRuleResolver();
+
+    BOOST_REQUIRE( a && b );
+
+    int before = resolver->Clearance( a, b, false );
+
+    // Nothing has changed, so the clearances (and the resolver holding them) carry over
+    BOOST_REQUIRE( router.m_iface.SyncChanges( router.World() ) );
+    BOOST_CHECK( router.m_router.GetRuleResolver() == resolver );
+    BOOST_CHECK_EQUAL( resolver->Clearance( a, b, false ), before );
+
+    // Change the rules without touching any board item
+    int after = before + pcbIUScale.mmToIU( 0.5 );
+
+    trackA->GetEffectiveNetClass()->SetClearance( after );
+    trackB->GetEffectiveNetClass()->SetClearance( after );
+    m_board->GetDesignSettings().m_DRCEngine->InitEngine( wxFileName() );
+
+    BOOST_REQUIRE( router.m_iface.SyncChanges( router.World() ) );
+    BOOST_CHECK( router.m_router.GetRuleResolver() == resolver );
+    BOOST_CHECK_EQUAL( resolver->Clearance( a, b, false ), after );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
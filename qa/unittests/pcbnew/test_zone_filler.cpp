@@ -24,13 +24,17 @@
 #include <qa_utils/wx_utils/unit_test_utils.h>
 #include <pcbnew_utils/board_test_utils.h>
 #include <board.h>
+#include <board_commit.h>
 #include <board_design_settings.h>
 #include <pad.h>
 #include <pcb_track.h>
 #include <footprint.h>
 #include <zone.h>
+#include <zone_filler.h>
 #include <drc/drc_item.h>
 #include <settings/settings_manager.h>
+#include <tool/tool_manager.h>
+#include <core/kicad_algo.h>
 
 
 struct ZONE_FILL_TEST_FIXTURE
@@ -176,6 +180,103 @@ BOOST_FIXTURE_TEST_CASE( NotchedZones, ZONE_FILL_TEST_FIXTURE )
 }
 
 
+BOOST_FIXTURE_TEST_CASE( DirtyLayerZoneFills, ZONE_FILL_TEST_FIXTURE )
+{
+    KI_TEST::LoadBoard( m_settingsManager, "issue5102", m_board );
+    KI_TEST::FillZones( m_board.get() );
+
+    // Find a zone on the front which knocks out the front fill of a lower-priority zone on
+    // other layers too
+    ZONE* dirtyZone = nullptr;
+    ZONE* dependent = nullptr;
+
+    for( ZONE* zone : m_board->Zones() )
+    {
+        if( zone->GetIsRuleArea() || !zone->IsOnLayer( F_Cu ) )
+            continue;
+
+        for( ZONE* other : m_board->Zones() )
+        {
+            if( other->GetIsRuleArea() || !other->IsOnLayer( F_Cu )
+                    || other->GetLayerSet().count() < 2 || other->SameNet( zone )
+                    || !zone->HigherPriority( other ) )
+            {
+                continue;
+            }
+
+            if( zone->Outline()->Collide( other->Outline() ) )
+            {
+                dirtyZone = zone;
+                dependent = other;
+                break;
+            }
+        }
+
+        if( dirtyZone )
+            break;
+    }
+
+    BOOST_REQUIRE( dirtyZone && dependent );
+
+    std::map<std::pair<ZONE*, PCB_LAYER_ID>, std::shared_ptr<SHAPE_POLY_SET>> fills;
+
+    for( ZONE* zone : m_board->Zones() )
+    {
+        for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+        {
+            if( zone->HasFilledPolysForLayer( layer ) )
+                fills[ { zone, layer } ] = zone->GetFilledPolysList( layer );
+        }
+    }
+
+    auto refilled =
+            [&]( ZONE* aZone, PCB_LAYER_ID aLayer ) -> bool
+            {
+                return aZone->GetFilledPolysList( aLayer ) != fills[ { aZone, aLayer } ];
+            };
+
+    TOOL_MANAGER toolMgr;
+    toolMgr.SetEnvironment( m_board.get(), nullptr, nullptr, nullptr, nullptr );
+
+    BOARD_COMMIT       commit( &toolMgr );
+    ZONE_FILLER        filler( m_board.get(), &commit );
+    std::vector<ZONE*> toFill = { dirtyZone };
+
+    filler.SetDirtyLayers( { { dirtyZone, LSET( F_Cu ) } } );
+
+    BOOST_REQUIRE( filler.Fill( toFill ) );
+    commit.Push( _( "Fill Zone(s)" ),
+                 SKIP_UNDO | SKIP_SET_DIRTY | ZONE_FILL_OP | SKIP_CONNECTIVITY );
+
+    // The dirty layer is refilled, along with the front of the zone it knocks out...
+    BOOST_CHECK( refilled( dirtyZone, F_Cu ) );
+    BOOST_CHECK( refilled( dependent, F_Cu ) );
+    BOOST_CHECK( alg::contains( toFill, dependent ) );
+
+    for( ZONE* zone : m_board->Zones() )
+    {
+        BOOST_TEST_CONTEXT( "Zone on net " << zone->GetNetCode() << " with priority "
+                            << zone->GetAssignedPriority() )
+        {
+            // ... but nothing else on the other layers is touched
+            for( PCB_LAYER_ID layer : zone->GetLayerSet().Seq() )
+            {
+                if( layer != F_Cu && fills.count( { zone, layer } ) )
+                    BOOST_CHECK( !refilled( zone, layer ) );
+            }
+
+            // ... and nor are the zones which take precedence over it
+            if( zone != dirtyZone && zone->IsOnLayer( F_Cu ) && fills.count( { zone, F_Cu } )
+                    && zone->HigherPriority( dirtyZone ) )
+            {
+                BOOST_CHECK( !refilled( zone, F_Cu ) );
+                BOOST_CHECK( !alg::contains( toFill, zone ) );
+            }
+        }
+    }
+}
+
+
 BOOST_FIXTURE_TEST_CASE( RegressionZoneFillTests, ZONE_FILL_TEST_FIXTURE )
 {
     std::vector<wxString> tests = { "issue18",
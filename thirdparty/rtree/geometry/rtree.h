@@ -17,6 +17,7 @@
 //    * 2020 KiCad Developers - Add std::iterator support for searching
 //    * 2020 KiCad Developers - Add container nearest neighbor based on Hjaltason & Samet
 //    * 2022 KiCad Developers - Slight optimizations in RectSphericalVolume
+//    * 2022 KiCad Developers - Add Sort-Tile-Recursive bulk loading
 //
 
 /*
@@ -212,6 +213,13 @@ public:
     /// Remove all entries from tree
     void    RemoveAll();
 
+    /// Replace the contents of the tree with the given entries.
+    /// The tree is packed using Sort-Tile-Recursive (Leutenegger et al.), which is much faster
+    /// than inserting the entries one at a time and produces full, well-separated nodes.  All
+    /// nodes are allocated in a single block.  The tree may still be modified afterwards.
+    /// \param a_entries The bounding rect and data of each entry.  Will be reordered.
+    void    BulkLoad( std::vector<std::pair<Rect, DATATYPE>>& a_entries );
+
     /// Count the data elements in this container.  This is slow as no internal counter is maintained.
     int     Count() const;
 
@@ -605,6 +613,7 @@ protected:
 
     void    RemoveAllRec( Node* a_node ) const;
     void    Reset() const;
+    void    SortTileRecursive( Branch* a_branches, size_t a_count, int a_axis ) const;
     void    CountRec( const Node* a_node, int& a_count ) const;
 
     bool    SaveRec( const Node* a_node, RTFileStream& a_stream ) const;
@@ -612,6 +621,7 @@ protected:
 
     Node*           m_root;                         ///< Root of tree
     ELEMTYPEREAL    m_unitSphereVolume;             ///< Unit sphere constant for required number of dimensions
+    std::vector<Node> m_packedNodes;                ///< Node storage used by BulkLoad()
 };
 
 
@@ -1120,12 +1130,114 @@ void RTREE_QUAL::RemoveAll()
 {
     // Delete all existing nodes
     Reset();
+    m_packedNodes.clear();
 
     m_root = AllocNode();
     m_root->m_level = 0;
 }
 
 
+RTREE_TEMPLATE
+void RTREE_QUAL::BulkLoad( std::vector<std::pair<Rect, DATATYPE>>& a_entries )
+{
+    Reset();
+    m_packedNodes.clear();
+
+    if( a_entries.empty() )
+    {
+        m_root = AllocNode();
+        m_root->m_level = 0;
+        return;
+    }
+
+    // Work out the size of each level up to the root so that all the nodes can be allocated
+    // in one go.  The block must not be reallocated once we start handing out pointers to it.
+    size_t nodeCount = 0;
+
+    for( size_t levelCount = a_entries.size(); levelCount > 1; )
+    {
+        levelCount = ( levelCount + MAXNODES - 1 ) / MAXNODES;
+        nodeCount += levelCount;
+    }
+
+    m_packedNodes.resize( std::max<size_t>( nodeCount, 1 ) );
+
+    std::vector<Branch> branches( a_entries.size() );
+
+    for( size_t ii = 0; ii < a_entries.size(); ++ii )
+    {
+        branches[ii].m_rect = a_entries[ii].first;
+        branches[ii].m_data = a_entries[ii].second;
+    }
+
+    Node* nextNode = m_packedNodes.data();
+    int   level = 0;
+
+    while( true )
+    {
+        SortTileRecursive( branches.data(), branches.size(), 0 );
+
+        std::vector<Branch> parents( ( branches.size() + MAXNODES - 1 ) / MAXNODES );
+
+        for( size_t ii = 0; ii < parents.size(); ++ii )
+        {
+            Node* node = nextNode++;
+            InitNode( node );
+            node->m_level = level;
+
+            size_t first = ii * MAXNODES;
+            size_t last = std::min( first + MAXNODES, branches.size() );
+
+            for( size_t jj = first; jj < last; ++jj )
+                node->m_branch[node->m_count++] = branches[jj];
+
+            parents[ii].m_rect = NodeCover( node );
+            parents[ii].m_child = node;
+        }
+
+        if( parents.size() == 1 )
+        {
+            m_root = parents[0].m_child;
+            break;
+        }
+
+        branches.swap( parents );
+        ++level;
+    }
+}
+
+
+// Order the branches so that each consecutive run of MAXNODES forms a tile: sort along the
+// first axis, cut into slabs of whole nodes, then recursively sort each slab along the next.
+RTREE_TEMPLATE
+void RTREE_QUAL::SortTileRecursive( Branch* a_branches, size_t a_count, int a_axis ) const
+{
+    if( a_count <= (size_t) MAXNODES )
+        return;
+
+    std::sort( a_branches, a_branches + a_count,
+               [a_axis]( const Branch& a, const Branch& b )
+               {
+                   // Compare doubled centres; the halving doesn't change the order
+                   return (ELEMTYPEREAL) a.m_rect.m_min[a_axis] + a.m_rect.m_max[a_axis]
+                            < (ELEMTYPEREAL) b.m_rect.m_min[a_axis] + b.m_rect.m_max[a_axis];
+               } );
+
+    if( a_axis == NUMDIMS - 1 )
+        return;
+
+    double nodes = std::ceil( (double) a_count / MAXNODES );
+    double slabs = std::ceil( std::pow( nodes, 1.0 / ( NUMDIMS - a_axis ) ) );
+    size_t slabSize = MAXNODES * (size_t) std::ceil( nodes / slabs );
+
+    for( size_t first = 0; first < a_count; first += slabSize )
+    {
+        SortTileRecursive( a_branches + first, std::min( slabSize, a_count - first ),
+                           a_axis + 1 );
+    }
+}
+
+
 RTREE_TEMPLATE
 void RTREE_QUAL::Reset() const
 {
@@ -1177,6 +1289,14 @@ void RTREE_QUAL::FreeNode( Node* a_node ) const
 {
     ASSERT( a_node );
 
+    // Nodes made by BulkLoad() are owned by m_packedNodes
+    if( !m_packedNodes.empty()
+            && std::greater_equal<const Node*>()( a_node, m_packedNodes.data() )
+            && std::less<const Node*>()( a_node, m_packedNodes.data() + m_packedNodes.size() ) )
+    {
+        return;
+    }
+
 #ifdef RTREE_DONT_USE_MEMPOOLS
     delete a_node;
 #else       // RTREE_DONT_USE_MEMPOOLS